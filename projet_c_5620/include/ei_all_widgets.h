@@ -12,6 +12,9 @@
 
 #include "ei_widget.h"
 #include "ei_event.h"
+#include "ei_scale.h"
+#include "ei_layer.h"
+#include "ei_widget_listbox.h"
 
 /*
  *\brief Definition of a callback widget (Used for widget destroy notify)
@@ -23,22 +26,60 @@ typedef struct ei_callback_widget_t {
     void*			user_param;
 } ei_callback_widget_t;
 
+/*
+ *\brief Bits of the "set" mask of the widgets below: the bit of an attribute is set
+ * once the attribute has been given to the configure function, otherwise the attribute
+ * has its default value.
+ *
+ */
+typedef enum {
+    ei_attr_color		= 1 << 0,
+    ei_attr_border_width	= 1 << 1,
+    ei_attr_relief		= 1 << 2,
+    ei_attr_text		= 1 << 3,
+    ei_attr_text_font		= 1 << 4,
+    ei_attr_text_color		= 1 << 5,
+    ei_attr_text_anchor		= 1 << 6,
+    ei_attr_img			= 1 << 7,
+    ei_attr_img_rect		= 1 << 8,
+    ei_attr_img_anchor		= 1 << 9,
+    ei_attr_corner_radius	= 1 << 10,
+    ei_attr_callback		= 1 << 11,
+    ei_attr_user_param		= 1 << 12,
+    ei_attr_title		= 1 << 13,
+    ei_attr_closable		= 1 << 14,
+    ei_attr_resizable		= 1 << 15,
+    ei_attr_min_size		= 1 << 16,
+    ei_attr_requested_size	= 1 << 17,
+    ei_attr_content_size	= 1 << 18
+} ei_attr_t;
+
+typedef uint32_t ei_attr_mask_t;
+
+/* Attributs qui changent la geometrie du widget */
+#define EI_ATTR_LAYOUT		(ei_attr_requested_size)
+/* Attributs qui changent l'affichage du widget */
+#define EI_ATTR_VISIBLE		(~(ei_attr_callback | ei_attr_user_param | ei_attr_min_size))
+
 /*
  *\brief Definition of a frame which can be used to draw a simple frame with 3D effect or not.
+ * The attributes are stored in the widget: creating a frame is a single allocation.
  *
  */
 typedef struct ei_frame_t {
     ei_callback_widget_t widget;
-    ei_color_t* color;
-    int* border_width;
-    ei_relief_t* relief;
-    char **text;
-    ei_font_t* text_font;
-    ei_color_t* text_color;
-    ei_anchor_t* text_anchor;
-    ei_surface_t* img;
-    ei_rect_t** img_rect;
-    ei_anchor_t* img_anchor;
+    ei_attr_mask_t set;
+    ei_color_t color;
+    int border_width;
+    ei_relief_t relief;
+    ei_anchor_t text_anchor;
+    ei_anchor_t img_anchor;
+    ei_color_t text_color;
+    ei_font_t text_font;
+    char* text;
+    ei_surface_t img;
+    ei_rect_t img_rect;
+    ei_scaling_t img_scaling;
 } ei_frame_t;
 
 /*
@@ -47,19 +88,21 @@ typedef struct ei_frame_t {
  */
 typedef struct ei_button_t {
     ei_callback_widget_t widget;
-    ei_color_t* color;
-    int*		border_width;
-    int*		corner_radius;
-    ei_relief_t*	relief;
-    char **text;
-    ei_font_t* text_font;
-    ei_color_t* text_color;
-    ei_anchor_t* text_anchor;
-    ei_surface_t* img;
-    ei_rect_t** img_rect;
-    ei_anchor_t* img_anchor;
-    ei_callback_t*		callback;
-    void**			user_param;
+    ei_attr_mask_t set;
+    ei_color_t color;
+    int		border_width;
+    int		corner_radius;
+    ei_relief_t	relief;
+    ei_anchor_t text_anchor;
+    ei_anchor_t img_anchor;
+    ei_color_t text_color;
+    ei_font_t text_font;
+    char* text;
+    ei_surface_t img;
+    ei_rect_t img_rect;
+    ei_scaling_t img_scaling;
+    ei_callback_t		callback;
+    void*			user_param;
 } ei_button_t;
 
 /*
@@ -68,15 +111,56 @@ typedef struct ei_button_t {
  */
 typedef struct ei_toplevel_t {
     ei_callback_widget_t widget;
-    ei_color_t* color;
-    int*		border_width;
-    char **title;
-    ei_bool_t* closable;
-    ei_axis_set_t* resizable;
-    ei_size_t** min_size;
+    ei_attr_mask_t set;
+    ei_color_t color;
+    int		border_width;
+    ei_bool_t closable;
+    ei_axis_set_t resizable;
+    ei_size_t min_size;
+    char* title;
     ei_widget_t* button_closable;
+    ei_rect_t content;
 } ei_toplevel_t;
 
+/*
+ *\brief Definition of a scrollframe: a frame that shows the part of its content that starts
+ * at "offset" in its viewport (the screen location without the border). The viewfunc of a
+ * subclass, if not NULL, is called when the offset or the viewport has changed.
+ *
+ */
+typedef struct ei_scrollframe_t {
+    ei_callback_widget_t widget;
+    ei_attr_mask_t set;
+    ei_color_t color;
+    int		border_width;
+    ei_relief_t	relief;
+    ei_size_t content_size;
+    ei_point_t offset;
+    ei_rect_t viewport;
+    ei_bool_t dragging;
+    ei_point_t drag_from;
+    void (*viewfunc)(ei_widget_t* widget);
+} ei_scrollframe_t;
+
+/*
+ *\brief Definition of a listbox: a scrollframe whose content is a list of "item_count" rows.
+ * rows[slot] shows the item items[slot] (-1 if none); the item k is shown by the slot
+ * k % row_count, so that scrolling only gives new items to the rows that wrap around.
+ *
+ */
+typedef struct ei_listbox_t {
+    ei_scrollframe_t scrollframe;
+    int item_count;
+    int row_height;
+    ei_widgetclass_name_t row_class;
+    ei_listbox_rowfunc_t rowfunc;
+    void* user_param;
+    ei_widget_t** rows;
+    int* items;
+    int row_count;
+    int row_capacity;
+} ei_listbox_t;
+
 /**
  * @brief	Returns the widget that has the given id
  *
@@ -95,9 +179,29 @@ ei_widget_t* ei_find_pick_color(ei_widget_t* widget, uint32_t pick_id);
  */
 void free_widgets(ei_widget_t* widget);
 
+/**
+ * @brief	Allocates a widget of a class: from the slab cache of the class if it has one,
+ *		with its allocfunc otherwise.
+ *
+ * @param	class		The class of the widget.
+ * @param	id		The identifier of the class, see \ref ei_widgetclass_get_id.
+ *
+ * @return			The widget, with all bytes set to 0 except its class.
+ */
+ei_widget_t* ei_widget_alloc(ei_widgetclass_t* class, ei_widgetclass_id_t id);
 
 /**
- * \brief	Draws all the widgets
+ * @brief	Releases a widget allocated by \ref ei_widget_alloc: calls the releasefunc of its
+ *		class, then frees its placer parameters, its pick color and its structure.
+ *
+ * @param	widget		The widget, already unlinked from its parent.
+ */
+void ei_widget_release(ei_widget_t* widget);
+
+
+/**
+ * \brief	Draws the root widget and its descendants in the region to redraw,
+ * tile by tile on the threads of the pool (see \ref ei_render).
  *
  * @param   widget  root widget from which it draws the widgets
  *
@@ -105,6 +209,128 @@ void free_widgets(ei_widget_t* widget);
 void draw_widgets(ei_widget_t* widget);
 
 
+/**
+ * \brief	Processes all the events that are already pending after a mouse
+ * move. Consecutive mouse moves for the same active widget are collapsed into
+ * the latest one, so that the caller renders once for the whole batch.
+ *
+ * @param	first		The mouse move event that started the batch.
+ * @param	immediate	Set to EI_TRUE if the batch held a click or a key, which is
+ *				drawn without waiting for the next frame. Left as is otherwise.
+ *
+ * @return			EI_TRUE if the default handle function asked for a redraw.
+ */
+ei_bool_t ei_app_pump_events(ei_event_t* first, ei_bool_t* immediate);
+
+/**
+ * \brief	Sends an event to the widget concerned, or to the default handle
+ * function if no widget is concerned.
+ *
+ * @param	event		The event to process.
+ *
+ * @return			EI_TRUE if the default handle function asked for a redraw.
+ */
+ei_bool_t ei_app_dispatch_event(ei_event_t* event);
+
+/**
+ * \brief	Calls the callbacks bound (see \ref ei_bind) to a widget, then to its
+ * class, then to the "all" tag, until one of them handles the event. The dispatch
+ * stops when a callback destroys the widget.
+ *
+ * @param	widget		The widget concerned by the event, or NULL.
+ * @param	event		The event to process.
+ *
+ * @return			EI_TRUE if a callback handled the event or destroyed the
+ *				widget, which must not be used anymore.
+ */
+ei_bool_t ei_event_call_bindings(ei_widget_t* widget, ei_event_t* event);
+
+/**
+ * \brief	Tests if at least one callback is bound to a type of event.
+ *
+ * @param	eventtype	The type of event.
+ *
+ * @return			EI_TRUE if a callback is bound.
+ */
+ei_bool_t ei_event_has_bindings(ei_eventtype_t eventtype);
+
+/**
+ * \brief	Removes the bindings of a widget, its focus and its activity. Called when
+ * the widget is destroyed.
+ *
+ * @param	widget		The widget.
+ */
+void ei_event_forget_widget(ei_widget_t* widget);
+
+/**
+ * \brief	Frees all the bindings and tags. Called by \ref ei_app_free.
+ */
+void ei_event_free_bindings();
+
+/**
+ * \brief	Redraws the picking offscreen in the region invalidated since the
+ * last pick (see \ref ei_invalidate_pick_rect). Does nothing if it is up to date.
+ */
+void draw_pick();
+
+/**
+ * \brief	Draws all the widgets in the picking offscreen only. If widgets of classes
+ * registered outside of the library exist, the screen is drawn too, since their drawfunc
+ * expects both surfaces, and the region is invalidated.
+ *
+ * @param   widget  root widget from which it draws the widgets
+ */
+void draw_pick_widgets(ei_widget_t* widget);
+
+/**
+ * \brief	Returns the number of living widgets whose class is not one of the library
+ * (see \ref ei_class_first_user).
+ *
+ * @return	The number of widgets.
+ */
+int ei_widget_user_class_count();
+
+/**
+ * \brief	Tells if a widget is a decoration of its parent (the close button of
+ * a toplevel): it is then clipped by the screen location of its parent instead
+ * of its content_rect.
+ *
+ * @param   widget  The widget
+ *
+ * @return  EI_TRUE if the widget is a decoration
+ */
+ei_bool_t ei_widget_is_decoration(ei_widget_t* widget);
+
+/**
+ * \brief	Gives the part of a widget that its drawing covers with opaque pixels, whatever
+ * is under it: the screen location of a frame or of a button with an opaque color and
+ * straight corners, the body of a toplevel with an opaque color.
+ *
+ * @param   widget  The widget
+ * @param   rect    Where to store the opaque part, in the root window coordinates.
+ *
+ * @return  EI_TRUE if the widget has an opaque part
+ */
+ei_bool_t ei_widget_opaque_rect(ei_widget_t* widget, ei_rect_t* rect);
+
+/**
+ * \brief	Adds a rectangle to the region of the screen that must be updated at the next
+ * frame without being redrawn, because its pixels have been moved in the root surface
+ * (see \ref ei_scroll_pixels).
+ *
+ * @param	rect		The rectangle to add, expressed in the root window coordinates.
+ */
+void ei_app_present_rect(ei_rect_t* rect);
+
+/**
+ * \brief	Adds a rectangle to the region of the picking offscreen that must be
+ * redrawn before the next pick. Must be called when the geometry, the creation,
+ * the destruction or the stacking order of a widget changes.
+ *
+ * @param	rect		The rectangle to add, expressed in the root window coordinates.
+ */
+void ei_invalidate_pick_rect(ei_rect_t* rect);
+
 /**
  * \brief  The function gives the top_left from which to draw a text or an
  * image in the rectangle specified
@@ -114,18 +340,90 @@ void draw_widgets(ei_widget_t* widget);
  *
  * @return  The top_left point to start drawing
  */
+ei_point_t ei_anchor_point(ei_rect_t rectangle, ei_anchor_t* anchor, int border_width, ei_size_t size);
+
+/**
+ * \brief  Same as \ref ei_anchor_point, the point is allocated in the frame arena
+ * (\ref ei_arena_alloc).
+ */
 ei_point_t* ei_get_where(ei_rect_t rectangle, ei_anchor_t* anchor, int border_width, ei_size_t size);
 
+/*
+ *\brief What the library keeps for each widget outside of \ref ei_widget_t, whose layout
+ * is shared with classes compiled separately. It is allocated with the pick color: the
+ * pick_color field of the widget points to its first member.
+ *
+ */
+typedef struct ei_widget_links_t {
+    ei_color_t pick_color;
+    ei_widget_t* prev_sibling;
+    int animations;		///< Nombre d'animations en cours ou terminees du widget
+    struct ei_animation_t* animation_head;	///< Ces animations, chainees entre elles
+    ei_widgetclass_id_t class_id;	///< Identifiant de sa classe, pour les bindings des tags
+} ei_widget_links_t;
+
+/**
+ * @brief	Returns what the library keeps for a widget outside of its structure.
+ *
+ * @param	widget		The widget, created by the library.
+ *
+ * @return			The links of the widget.
+ */
+static inline ei_widget_links_t* ei_widget_links(ei_widget_t* widget){
+    return (ei_widget_links_t*) widget -> pick_color;
+}
+
 /**
  * @brief	Converts pick_id to pick_color.
  *
  *
  * @param	id      The pick_id.
  *
- * @return			Returns the pick color.
+ * @return			Returns the pick color, the first member of a new
+ *				\ref ei_widget_links_t.
  */
 ei_color_t* convert_pick_id_to_pick_color(uint32_t id);
 
+/**
+ * @brief	Converts pick_id to pick_color, by value.
+ *
+ * @param	id      The pick_id.
+ *
+ * @return			Returns the pick color.
+ */
+ei_color_t ei_pick_id_to_color(uint32_t id);
+
+/**
+ * @brief	Applies the changes made by a configure function: recomputes the geometry of the
+ *		widget if an attribute of \ref EI_ATTR_LAYOUT has changed, and damages it if an
+ *		attribute of \ref EI_ATTR_VISIBLE has changed. Does nothing otherwise.
+ *
+ * @param	widget		The widget that has been configured.
+ * @param	changed		The attributes whose value has changed.
+ */
+void ei_widget_configured(ei_widget_t* widget, ei_attr_mask_t changed);
+
+/**
+ * @brief	Compares two colors.
+ *
+ * @return			EI_TRUE if all their channels are equal.
+ */
+ei_bool_t ei_color_equal(ei_color_t color1, ei_color_t color2);
+
+/**
+ * @brief	Compares two rectangles.
+ *
+ * @return			EI_TRUE if they have the same position and size.
+ */
+ei_bool_t ei_rect_equal(const ei_rect_t* rect1, const ei_rect_t* rect2);
+
+/**
+ * @brief	Compares two strings, any of them can be NULL.
+ *
+ * @return			EI_TRUE if both are NULL or both have the same characters.
+ */
+ei_bool_t ei_string_equal(const char* string1, const char* string2);
+
 /**
  * @brief	Changes the design of the button specified
  *
@@ -142,6 +440,12 @@ void ei_change_relief_button(ei_relief_t* relief, ei_widget_t* widget);
  *
  * @return			Returns the intersection between 2 rectangles
  */
+ei_rect_t ei_rect_intersection(const ei_rect_t* rect1, const ei_rect_t* rect2);
+
+/**
+ * @brief	Same as \ref ei_rect_intersection, the rectangle is allocated in the
+ *		frame arena (\ref ei_arena_alloc).
+ */
 ei_rect_t* ei_intersection(ei_rect_t* rect1, ei_rect_t* rect2) ;
 
 /**
@@ -182,6 +486,12 @@ void ei_intersection_linked_rect(ei_rect_t* rect1, ei_linked_rect_t* rect2);
  *
  * @return			Returns the rectangle that contains the 2 rectangles
  */
+ei_rect_t ei_rect_union(const ei_rect_t* rect1, const ei_rect_t* rect2);
+
+/**
+ * @brief	Same as \ref ei_rect_union, the rectangle is allocated in the frame arena
+ *		(\ref ei_arena_alloc).
+ */
 ei_rect_t* ei_union(ei_rect_t* rect1, ei_rect_t* rect2);
 
 /**
@@ -189,10 +499,26 @@ ei_rect_t* ei_union(ei_rect_t* rect1, ei_rect_t* rect2);
  *
  * @param   widget  The widget that is concerned.
  *
- * @return			Returns the pick color.
+ * @return			Returns the previous sibling, or NULL for the first child.
  */
 ei_widget_t*    ei_widget_previous (ei_widget_t* widget);
 
+/**
+ * @brief	Adds a widget at the end of the children of a parent, ie. on top of its siblings.
+ *
+ * @param	parent		The new parent of the widget.
+ * @param	widget		The widget, not linked to any parent.
+ */
+void ei_widget_append(ei_widget_t* parent, ei_widget_t* widget);
+
+/**
+ * @brief	Removes a widget from the children of its parent. The widget keeps its parent
+ *		pointer.
+ *
+ * @param	widget		The widget.
+ */
+void ei_widget_unlink(ei_widget_t* widget);
+
 /**
  * @brief   Draws the widgets.
  *
@@ -206,6 +532,11 @@ void draw();
  */
 void free_class();
 
+/**
+ * \brief	Empties the registry of the class names. Called by \ref free_class.
+ */
+void ei_widgetclass_free_registry();
+
 /*Declaration of all the global variables of the library */
 ei_widgetclass_t* LIB;
 ei_widget_t* ROOT;
@@ -217,5 +548,6 @@ ei_point_t* WIN_MOVE;
 ei_point_t* WIN_RESIZ;
 ei_default_handle_func_t DEF_FUNC;
 ei_linked_rect_t* DRAW_RECT;
+ei_linked_rect_t* PICK_RECT;
 
 #endif
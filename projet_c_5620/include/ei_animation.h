@@ -0,0 +1,105 @@
+/**
+ *  @file	ei_animation.h
+ *  @brief	Animates properties of widgets: the values are interpolated over a duration, and
+ *		the widgets are redrawn at each step. All the animations are stepped together by
+ *		a single timer (see \ref ei_timer_add), at the frame rate of the application.
+ *
+ */
+#ifndef EI_ANIMATION_H
+#define EI_ANIMATION_H
+
+#include "ei_types.h"
+#include "ei_widget.h"
+
+/**
+ * @brief	How the progression of an animation is distributed over its duration.
+ */
+typedef enum {
+    ei_ease_linear	= 0,	///< Constant speed.
+    ei_ease_in,			///< Starts slowly, ends fast.
+    ei_ease_out,		///< Starts fast, ends slowly.
+    ei_ease_in_out		///< Starts and ends slowly.
+} ei_easing_t;
+
+/**
+ * @brief	An opaque animation, returned by \ref ei_animate_int and \ref ei_animate_color.
+ */
+typedef struct ei_animation_t ei_animation_t;
+
+/**
+ * @brief	The function called when an animation reaches its final value.
+ *
+ * @param	widget		The animated widget.
+ * @param	user_param	The user parameter given when the animation was started.
+ */
+typedef void (*ei_animation_done_t) (ei_widget_t* widget, void* user_param);
+
+/**
+ * @brief	Animates an integer property of a widget (for example its border width) from its
+ *		current value to a final value. An animation already running on the same
+ *		property is cancelled.
+ *
+ * @param	widget		The widget to redraw at each step.
+ * @param	property	The property: a value read by the widget each time it is drawn.
+ * @param	to		The final value.
+ * @param	duration	The duration of the animation, in milliseconds.
+ * @param	easing		The easing of the animation.
+ * @param	done		The function called at the end of the animation, may be NULL.
+ * @param	user_param	A parameter passed to done.
+ *
+ * @return			The animation. It is released at its end: it must not be
+ *				cancelled from then on.
+ */
+ei_animation_t* ei_animate_int(ei_widget_t* widget, int* property, int to, int duration,
+			       ei_easing_t easing, ei_animation_done_t done, void* user_param);
+
+/**
+ * @brief	Animates a color property of a widget, channel by channel. Same as
+ *		\ref ei_animate_int.
+ */
+ei_animation_t* ei_animate_color(ei_widget_t* widget, ei_color_t* property, ei_color_t to,
+				 int duration, ei_easing_t easing, ei_animation_done_t done,
+				 void* user_param);
+
+/**
+ * @brief	Animates the background color of a frame, a button or a toplevel. Same as
+ *		\ref ei_animate_color.
+ *
+ * @return			The animation, or NULL if the widget has no background color.
+ */
+ei_animation_t* ei_animate_background(ei_widget_t* widget, ei_color_t to, int duration,
+				      ei_easing_t easing, ei_animation_done_t done,
+				      void* user_param);
+
+/**
+ * @brief	Animates the border width of a frame, a button or a toplevel. Same as
+ *		\ref ei_animate_int.
+ *
+ * @return			The animation, or NULL if the widget has no border.
+ */
+ei_animation_t* ei_animate_border_width(ei_widget_t* widget, int to, int duration,
+					ei_easing_t easing, ei_animation_done_t done,
+					void* user_param);
+
+/**
+ * @brief	Stops an animation: the property keeps its current value, done is not called.
+ *
+ * @param	animation	The animation to stop.
+ */
+void ei_animation_cancel(ei_animation_t* animation);
+
+/**
+ * @brief	Stops all the animations of a widget. Called when the widget is destroyed.
+ *
+ * @param	widget		The widget.
+ */
+void ei_animation_cancel_widget(ei_widget_t* widget);
+
+/**
+ * @brief	Returns the number of running animations.
+ *
+ * @return			The number of animations.
+ */
+int ei_animation_count();
+
+#endif
@@ -81,6 +81,15 @@ ei_widget_t* ei_app_root_widget();
  */
 ei_surface_t ei_app_root_surface();
 
+/**
+ * \brief	Returns the number of mouse move events that have been dropped since the
+ *		application started because a more recent move for the same active widget
+ *		was already pending: only the latest position of a batch is processed.
+ *
+ * @return 			The number of coalesced events.
+ */
+unsigned long ei_app_coalesced_events();
+
 
 
 
@@ -0,0 +1,76 @@
+/**
+ *  @file	ei_arena.h
+ *  @brief	Per-frame arena for the temporary values of the drawing code (points of the
+ *		polygons, sides of the scanline fill, ...). Allocating is a pointer bump, and
+ *		everything is released at once at the end of each frame. Each thread has its
+ *		own arena.
+ *
+ */
+#ifndef EI_ARENA_H
+#define EI_ARENA_H
+
+#include <stddef.h>
+
+/**
+ * @brief	A position in the arena, returned by \ref ei_arena_mark.
+ */
+typedef struct {
+    void*	chunk;		///< The chunk that was being filled.
+    size_t	used;		///< The number of bytes used in this chunk.
+} ei_arena_mark_t;
+
+/**
+ * @brief	Usage statistics of the arena.
+ */
+typedef struct {
+    size_t		capacity;	///< The total size of the chunks, in bytes.
+    size_t		used;		///< The number of bytes currently allocated.
+    size_t		peak;		///< The highest number of bytes allocated in a frame.
+    unsigned long	chunks;		///< The number of chunks allocated so far.
+} ei_arena_stats_t;
+
+/**
+ * @brief	Allocates a block in the arena. The block is valid until the end of the current
+ *		frame (see \ref ei_arena_reset), or until a \ref ei_arena_rewind to a mark taken
+ *		before it. It must not be freed.
+ *
+ * @param	size		The size of the block, in bytes.
+ *
+ * @return			A block with all bytes set to 0.
+ */
+void* ei_arena_alloc(size_t size);
+
+/**
+ * @brief	Returns the current position in the arena.
+ *
+ * @return			The mark.
+ */
+ei_arena_mark_t ei_arena_mark();
+
+/**
+ * @brief	Releases all the blocks allocated since a mark. Used by the drawing functions
+ *		so that their temporaries do not accumulate over a frame.
+ *
+ * @param	mark		A mark returned by \ref ei_arena_mark in the same frame.
+ */
+void ei_arena_rewind(ei_arena_mark_t mark);
+
+/**
+ * @brief	Releases all the blocks. Called at the end of each frame. If the frame needed
+ *		several chunks, they are replaced by a single one big enough for all of them.
+ */
+void ei_arena_reset();
+
+/**
+ * @brief	Returns the usage statistics of the arena.
+ *
+ * @param	stats		Where to store the statistics.
+ */
+void ei_arena_get_stats(ei_arena_stats_t* stats);
+
+/**
+ * @brief	Releases the memory of the arena. Called by \ref ei_app_free.
+ */
+void ei_arena_free();
+
+#endif
@@ -67,7 +67,8 @@ void			ei_draw_polygon		(ei_surface_t			surface,
 						 const ei_rect_t*		clipper);
 
 /**
- * \brief	Draws text by calling \ref hw_text_create_surface.
+ * \brief	Draws text with the glyph atlas of its font (see \ref ei_glyph_draw_text):
+ *		each character is rasterized once by \ref hw_text_create_surface.
  *
  * @param	surface 	Where to draw the text. The surface must be *locked* by
  *				\ref hw_surface_lock.
@@ -118,6 +119,9 @@ void			ei_fill			(ei_surface_t		surface,
  *				transparency of the final pixels is set	to opaque.
  *				If false, the final pixels are an exact copy of the source pixels,
  				including the alpha channel.
+ *				A premultiplied source (see \ref ei_layer_is_premultiplied) is
+ *				blended as such, and converted when copied in a surface that is
+ *				not premultiplied.
  *
  * @return			Returns 0 on success, 1 on failure (different ROI size).
  */
@@ -1,6 +1,7 @@
 #ifndef EI_DRAW_EXTENSION_H
 #define EI_DRAW_EXTENSION_H
 
+#include <stddef.h>
 #include "ei_types.h"
 
 /**
@@ -36,4 +37,48 @@ ei_bool_t pixel_is_in_rect(ei_point_t pixel, const ei_rect_t* rect);
  */
 void ei_copy2(const ei_rect_t* dst_rect, const ei_rect_t* src_rect, const ei_surface_t destination, const ei_surface_t source, const ei_bool_t alpha);
 
+/**
+ * \brief	Multiplies the colors of pixels by their alpha, see \ref ei_layer_premultiply.
+ *
+ * @param	pixels		The pixels.
+ * @param	count		The number of pixels.
+ * @param	ia		The index of the alpha channel in a pixel.
+ */
+void ei_premultiply_pixels(uint32_t* pixels, size_t count, int ia);
+
+/**
+ * \brief	Moves the pixels of a rectangle of a surface, the rectangles of the source and of
+ * the destination overlapping. The pixels moved out of the rectangle are lost, and the part
+ * of the rectangle that is uncovered keeps its old pixels.
+ *
+ * @param	surface		The surface, locked.
+ * @param	rect		The rectangle.
+ * @param	dx		The horizontal move, in pixels.
+ * @param	dy		The vertical move, in pixels.
+ */
+void ei_scroll_pixels(ei_surface_t surface, const ei_rect_t* rect, int dx, int dy);
+
+/* Taille a partir de laquelle un dessin est partage en bandes entre les threads */
+#define EI_BAND_MIN_PIXELS	65536
+#define EI_BAND_MIN_ROWS	16
+
+/**
+ * \brief	A function that draws the part of a primitive within a band.
+ *
+ * @param	band		The rows to draw, and the columns of the whole area.
+ * @param	user_param	The parameter given to \ref ei_draw_bands.
+ */
+typedef void (*ei_band_func_t) (const ei_rect_t* band, void* user_param);
+
+/**
+ * \brief	Splits an area in horizontal bands drawn in parallel by the threads of the pool
+ * (see \ref ei_pool_run). Below EI_BAND_MIN_PIXELS, or when called from a task of the
+ * pool (a tile of the renderer), the whole area is drawn at once by the calling thread.
+ *
+ * @param	area		The area to draw.
+ * @param	func		The function that draws a band.
+ * @param	user_param	A parameter passed to func.
+ */
+void ei_draw_bands(const ei_rect_t* area, ei_band_func_t func, void* user_param);
+
 #endif
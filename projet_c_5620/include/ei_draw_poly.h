@@ -44,7 +44,8 @@ typedef struct {
  *
  * @param	first_point 	The head of a linked list of the points of the line. It is either
  *				NULL (i.e. draws nothing), or has more than 2 points.
- * @return                  int* returns skyline min and max
+ * @return                  int* returns skyline min and max, allocated in the frame
+ *                          arena (\ref ei_arena_alloc)
  */
 int *init_scanline(ei_linked_point_t* first_point);
 
@@ -67,10 +68,10 @@ void move_side(ei_TCA_t* TCA, ei_TC_t* TC, int scanline);
 ei_TC_t* init_TC(const ei_linked_point_t* first_point, int y_min, int y_max);
 
 /**
- * \brief	Orders TCA according to x_y
+ * \brief	Orders TCA according to x_y, in place
  *
  * @param	TCA         TCA that needs to be ordered
- * @return  TCA2	    TCA ordered
+ * @return  TCA	    TCA ordered
  */
 ei_TCA_t* order_TCA(ei_TCA_t *TCA);
 
@@ -99,13 +100,5 @@ void update_intersect(ei_TCA_t* TCA);
  */
 void draw_scanline(ei_surface_t surface, ei_TCA_t *TCA, uint32_t color_rgba, int y, const ei_rect_t* clipper);
 
-/**
- * \brief	A function to free them all #LordOfTheMallocs
- *
- * @param	TCA Table of active sides
- * @param	TC 	Table of sides
- */
-void free_all(ei_TC_t *TC, ei_TCA_t *TCA, int* tab);
-
 
 #endif
@@ -20,7 +20,8 @@
  * @param	angle_debut	The angle where the first point is at
  * @param	angle_fin The angle where the last point is at
  *
- * @return			Returns the list of points that make the arc
+ * @return			Returns the list of points that make the arc. The points are
+ *				allocated in the frame arena (\ref ei_arena_alloc).
  */
 ei_linked_point_t *ei_arc(ei_point_t centre, uint32_t rayon, int angle_debut, int angle_fin);
 
@@ -41,15 +42,6 @@ void print_linked_point(ei_linked_point_t* first);
 ei_linked_point_t* ei_linked_inverse(ei_linked_point_t* first);
 
 
-
-/**
-* \brief	This function frees a ei_linked_point structure
-*
-* @param	first	The first point of the chained list
-*
-*/
-void free_ei_linked_point(ei_linked_point_t* first);
-
 /**
 * \brief	The fonction returns a list of points that represents a rounded frame
 *
@@ -57,7 +49,8 @@ void free_ei_linked_point(ei_linked_point_t* first);
 * @param  rayon the radius of the rounded part of the frame
 * @param  choice if 0: all of the frame; if 1: only the top part; if 2: only the bottom part
 *
-* @return			Returns the list of points that represents a rounded frame
+* @return			Returns the list of points that represents a rounded frame, allocated
+*				in the frame arena (\ref ei_arena_alloc).
 */
 ei_linked_point_t* ei_rounded_frame(ei_rect_t rectangle, uint32_t rayon, int choice);
 
@@ -146,5 +146,78 @@ void ei_event_set_default_handle_func(ei_default_handle_func_t func);
 ei_default_handle_func_t ei_event_get_default_handle_func();
 
 
+/**
+ * @brief	A string naming a group of widgets: the name of a class of widget (eg. "button")
+ *		binds all the widgets of this class, "all" binds all the widgets.
+ */
+typedef char*		ei_tag_t;
+
+/**
+ * @brief	A function that is called in response to an event, see \ref ei_bind.
+ *
+ * @param	widget		The widget for which the event was generated, or NULL if the event
+ *				is not related to a widget (only for bindings on the "all" tag).
+ * @param	event		The event containing all its parameters (type, etc.)
+ * @param	user_param	The user parameters that was provided by the caller when binding
+ *				this callback.
+ *
+ * @return			EI_TRUE if the function handled the event: the callbacks that
+ *				come next, the handle function of the class and the default
+ *				handle function are not called. EI_FALSE otherwise.
+ */
+typedef ei_bool_t		(*ei_bind_callback_t)	(ei_widget_t*		widget,
+							 struct ei_event_t*	event,
+							 void*			user_param);
+
+/**
+ * @brief	Binds a callback to an event type and a widget or a tag. The bindings of a
+ *		widget are called first, then the bindings of its class, then the bindings of
+ *		the "all" tag, then the handle function of the class. Several callbacks can be
+ *		bound to the same event type and widget or tag, they are called in the order of
+ *		the calls to ei_bind.
+ *		Mouse events are sent to the widget under the mouse (or the active widget),
+ *		keyboard events to the focus widget (see \ref ei_event_set_focus_widget).
+ *
+ * @param	eventtype	The type of the event.
+ * @param	widget		The callback is only called if the event is related to this widget.
+ *				This parameter must be NULL if the "tag" parameter is not NULL.
+ * @param	tag		The callback is only called if the event is related to a widget of
+ *				this class, or any widget if tag is "all". This parameter must be
+ *				NULL is the "widget" parameter is not NULL.
+ * @param	callback	The callback (ie. the function to call).
+ * @param	user_param	A user parameter that will be passed to the callback when it is
+ *				called.
+ */
+void		ei_bind			(ei_eventtype_t		eventtype,
+					 ei_widget_t*		widget,
+					 ei_tag_t		tag,
+					 ei_bind_callback_t	callback,
+					 void*			user_param);
+
+/**
+ * @brief	Unbinds a callback from an event type and a widget or a tag. The parameters must
+ *		be the same as in the call to \ref ei_bind.
+ */
+void		ei_unbind		(ei_eventtype_t		eventtype,
+					 ei_widget_t*		widget,
+					 ei_tag_t		tag,
+					 ei_bind_callback_t	callback,
+					 void*			user_param);
+
+/**
+ * Sets the widget that receives the keyboard events.
+ *
+ * @param	widget		The widget that gets the focus, or NULL: keyboard events are then
+ *				only sent to the bindings of the "all" tag and to the default
+ *				handle function.
+ */
+void ei_event_set_focus_widget(ei_widget_t* widget);
+
+/**
+ * Returns the widget that receives the keyboard events.
+ *
+ * @return			The widget that has the focus, or NULL.
+ */
+ei_widget_t* ei_event_get_focus_widget();
 
 #endif
@@ -0,0 +1,40 @@
+/**
+ *  @file	ei_frame_scheduler.h
+ *  @brief	Decides when the damaged region of the screen is redrawn: at most once per
+ *		frame interval, or immediately for latency-critical input.
+ *
+ */
+#ifndef EI_FRAME_SCHEDULER_H
+#define EI_FRAME_SCHEDULER_H
+
+#include "ei_types.h"
+
+/* Nombre d'images par seconde par defaut */
+#define EI_DEFAULT_FRAME_RATE	60
+
+/**
+ * @brief	Sets the maximum number of frames drawn per second. Damage received between two
+ *		frames is accumulated and drawn by the next frame.
+ *
+ * @param	frame_rate	The number of frames per second. 0 or less means that every
+ *				damage is drawn as soon as it is received.
+ */
+void ei_app_set_frame_rate(int frame_rate);
+
+/**
+ * @brief	Returns the maximum number of frames drawn per second.
+ *
+ * @return			The number of frames per second, 0 if not limited.
+ */
+int ei_app_get_frame_rate();
+
+/**
+ * @brief	Asks for the damaged region (\ref DRAW_RECT) to be drawn. If the last frame is
+ *		older than the frame interval or if immediate is true, the frame is drawn
+ *		now. Otherwise a single timer is set for the deadline (see \ref ei_timer_add).
+ *
+ * @param	immediate	EI_TRUE for latency-critical input (clicks, keys).
+ */
+void ei_frame_request(ei_bool_t immediate);
+
+#endif
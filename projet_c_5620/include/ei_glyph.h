@@ -0,0 +1,58 @@
+/**
+ *  @file	ei_glyph.h
+ *  @brief	Glyph atlas: each character of a font is rasterized once by
+ *		\ref hw_text_create_surface, and its coverage is kept in the atlas of the font.
+ *		Texts are drawn by blending the coverage of their glyphs in the target surface.
+ *
+ */
+#ifndef EI_GLYPH_H
+#define EI_GLYPH_H
+
+#include "ei_types.h"
+#include "hw_interface.h"
+
+/**
+ * @brief	Usage statistics of the glyph atlases.
+ */
+typedef struct {
+    int			fonts;		///< The number of fonts with an atlas.
+    int			glyphs;		///< The number of glyphs rasterized so far.
+    size_t		bytes;		///< The size of the coverage of all the atlases, in bytes.
+    unsigned long	drawn;		///< The number of glyphs drawn.
+} ei_glyph_stats_t;
+
+/**
+ * @brief	Draws a text with the glyphs of the atlas of its font. The glyphs are placed
+ *		one after the other, without kerning.
+ *
+ * @param	surface		Where to draw the text. The surface must be locked.
+ * @param	where		Coordinates, in the surface, of the top-left corner of the text.
+ * @param	text		The string of the text.
+ * @param	font		The font, or NULL for \ref ei_default_font.
+ * @param	color		The color of the text. The alpha parameter is not used.
+ * @param	clipper		If not NULL, the drawing is restricted within this rectangle.
+ */
+void ei_glyph_draw_text(ei_surface_t surface, const ei_point_t* where, const char* text,
+			ei_font_t font, const ei_color_t* color, const ei_rect_t* clipper);
+
+/**
+ * @brief	Returns the usage statistics of the glyph atlases.
+ *
+ * @param	stats		Where to store the statistics.
+ */
+void ei_glyph_get_stats(ei_glyph_stats_t* stats);
+
+/**
+ * @brief	Releases the atlas of a font. Must be called before the font is freed by
+ *		\ref hw_text_font_free.
+ *
+ * @param	font		The font.
+ */
+void ei_glyph_forget_font(ei_font_t font);
+
+/**
+ * @brief	Releases all the atlases. Called by \ref ei_app_free.
+ */
+void ei_glyph_free_atlases();
+
+#endif
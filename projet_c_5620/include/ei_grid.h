@@ -0,0 +1,133 @@
+/**
+ *  @file	ei_grid.h
+ *  @brief	The "grid" geometry manager: the children of a widget (the master) are placed
+ *		in the cells of a table of rows and columns. The size of each row and column
+ *		is kept between layouts: a change of the requested size of a widget only
+ *		recomputes its row and its column, and only moves the widgets whose cell has
+ *		changed.
+ *
+ */
+#ifndef EI_GRID_H
+#define EI_GRID_H
+
+#include "ei_types.h"
+#include "ei_widget.h"
+
+/**
+ * @brief	Usage statistics of the grid geometry manager.
+ */
+typedef struct {
+    int			masters;	///< The number of widgets with a grid.
+    int			slaves;		///< The number of widgets placed in a grid.
+    unsigned long	lines_solved;	///< The number of rows and columns whose size was computed.
+    unsigned long	axes_solved;	///< The number of times the offsets of the rows or the
+					///< columns of a grid were computed.
+    unsigned long	moves;		///< The number of widgets moved or resized by the grid.
+} ei_grid_stats_t;
+
+/**
+ * \brief	Configures the geometry of a widget using the "grid" geometry manager: the
+ *		widget is placed in a cell of a table over its parent. The width of a column is
+ *		the largest requested width of the widgets in it, the height of a row the
+ *		largest requested height; the space left in the parent is shared between the
+ *		columns and the rows that have a weight (\ref ei_grid_column_configure).
+ *		If the widget was managed by the placer, it is first removed from it.
+ *		If the widget was already managed by the grid, then this calls simply updates
+ *		the grid parameters: arguments that are not NULL replace previous values.
+ *
+ * @param	widget		The widget to place.
+ * @param	row		The row of the cell (defaults to 0).
+ * @param	column		The column of the cell (defaults to 0).
+ * @param	row_span	The number of rows of the cell (defaults to 1).
+ * @param	column_span	The number of columns of the cell (defaults to 1).
+ * @param	anchor		Where the widget is in its cell, if it does not fill it
+ *				(defaults to ei_anc_center).
+ * @param	fill		If EI_TRUE, the widget has the size of its cell. Otherwise, it
+ *				keeps its requested size, reduced to the size of the cell
+ *				(defaults to EI_FALSE).
+ */
+void ei_grid(struct ei_widget_t* widget, int* row, int* column, int* row_span,
+    int* column_span, ei_anchor_t* anchor, ei_bool_t* fill);
+
+/**
+ * \brief	Configures a column of the grid of a master. Arguments that are not NULL replace
+ *		previous values.
+ *
+ * @param	master		The widget whose children are placed by the grid.
+ * @param	column		The index of the column.
+ * @param	weight		The share of the space left in the master that the column gets
+ *				(defaults to 0: the column keeps its size).
+ * @param	min_size	The minimal width of the column (defaults to 0).
+ */
+void ei_grid_column_configure(struct ei_widget_t* master, int column, int* weight,
+    int* min_size);
+
+/**
+ * \brief	Configures a row of the grid of a master, as \ref ei_grid_column_configure
+ *		does for a column.
+ *
+ * @param	master		The widget whose children are placed by the grid.
+ * @param	row		The index of the row.
+ * @param	weight		The share of the space left in the master that the row gets
+ *				(defaults to 0: the row keeps its size).
+ * @param	min_size	The minimal height of the row (defaults to 0).
+ */
+void ei_grid_row_configure(struct ei_widget_t* master, int row, int* weight, int* min_size);
+
+/**
+ * \brief	Tells the grid to remove a widget from the screen and forget about it. The other
+ *		widgets of its row and column are placed again. Note: the widget is not
+ *		destroyed and still exists in memory.
+ *
+ * @param	widget		The widget to remove from screen.
+ */
+void ei_grid_forget(struct ei_widget_t* widget);
+
+/**
+ * @brief	Tells if a widget is placed by the grid.
+ *
+ * @param	widget		The widget.
+ *
+ * @return			EI_TRUE if the widget is in the grid of its parent.
+ */
+ei_bool_t ei_grid_is_managed(struct ei_widget_t* widget);
+
+/**
+ * @brief	Places a widget of a grid again after its requested size has changed: computes
+ *		the size of its row and of its column, and moves the widgets whose cell has
+ *		changed. Called by \ref ei_widget_configured.
+ *
+ * @param	widget		A widget placed by the grid.
+ */
+void ei_grid_update(struct ei_widget_t* widget);
+
+/**
+ * @brief	Shares the space of a master between its rows and columns again after its size
+ *		has changed. Called by the placer when it resizes a widget; nothing is done if
+ *		the widget has no grid.
+ *
+ * @param	master		The widget that has been resized.
+ */
+void ei_grid_resized(struct ei_widget_t* master);
+
+/**
+ * @brief	Forgets a widget that is being destroyed: its grid if it is a master, without
+ *		placing its children again, and its cell if it is in a grid.
+ *
+ * @param	widget		The widget.
+ */
+void ei_grid_release(struct ei_widget_t* widget);
+
+/**
+ * @brief	Returns the usage statistics of the grid geometry manager.
+ *
+ * @param	stats		Where to store the statistics.
+ */
+void ei_grid_get_stats(ei_grid_stats_t* stats);
+
+/**
+ * @brief	Frees all the grids. Called by \ref ei_app_free.
+ */
+void ei_grid_free_all();
+
+#endif
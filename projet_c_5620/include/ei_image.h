@@ -0,0 +1,134 @@
+/**
+ *  @file	ei_image.h
+ *  @brief	Registry of the images loaded from files: an image is decoded once by
+ *		\ref hw_image_load and shared by all the widgets that display it. The images that
+ *		are no longer used are kept within a memory budget, and the least recently used
+ *		ones are freed first. The images can also be decoded by a loader thread, a
+ *		placeholder being displayed until they arrive.
+ *
+ */
+#ifndef EI_IMAGE_H
+#define EI_IMAGE_H
+
+#include <stddef.h>
+#include "ei_types.h"
+#include "hw_interface.h"
+#include "ei_event.h"
+
+/* Budget par defaut des images inutilisees, en octets */
+#define EI_IMAGE_DEFAULT_BUDGET		(16 * 1024 * 1024)
+
+/**
+ * @brief	Usage statistics of the image registry.
+ */
+typedef struct {
+    int			images;		///< The number of images in the registry.
+    int			unused;		///< The number of images that no widget uses.
+    int			loading;	///< The number of images being decoded by the loader.
+    size_t		bytes;		///< The size of all the images, in bytes.
+    size_t		unused_bytes;	///< The size of the unused images, in bytes.
+    unsigned long	loads;		///< The number of files loaded, synchronously or not.
+    unsigned long	hits;		///< The number of images found in the registry.
+    unsigned long	evictions;	///< The number of unused images freed for the budget.
+} ei_image_stats_t;
+
+/**
+ * @brief	Returns the image of a file, and takes a reference on it. The file is decoded
+ *		the first time only, the following calls return the same surface.
+ *
+ * @param	filename	The path of the file.
+ *
+ * @return			The image, or NULL if the file could not be loaded. It must be
+ *				given back with \ref ei_image_release.
+ */
+ei_surface_t ei_image_acquire(const char* filename);
+
+/**
+ * @brief	Same as \ref ei_image_acquire, but returns at once: the file is decoded by a
+ *		loader thread, and a placeholder is returned meanwhile. The frames and buttons
+ *		configured with the placeholder are drawn without image; when the image arrives,
+ *		they are configured with it (their size is updated if it was not given) and
+ *		only they are redrawn. The placeholder stays valid until the last reference
+ *		on the image is released, and can be released instead of the image.
+ *
+ * @param	filename	The path of the file.
+ *
+ * @return			The image if it was already loaded, its placeholder otherwise.
+ *				It must be given back with \ref ei_image_release. If the file
+ *				cannot be decoded, the widgets keep the placeholder.
+ */
+ei_surface_t ei_image_acquire_async(const char* filename);
+
+/**
+ * @brief	Tells if a surface is the placeholder of an image loaded by
+ *		\ref ei_image_acquire_async. The drawing functions of the widgets do not
+ *		display the placeholders.
+ *
+ * @param	image		The surface.
+ *
+ * @return			EI_TRUE for a placeholder.
+ */
+ei_bool_t ei_image_is_placeholder(ei_surface_t image);
+
+/**
+ * @brief	Processes the application event posted by the loader thread when an image has
+ *		been decoded. Called by \ref ei_app_dispatch_event.
+ *
+ * @param	event		The event.
+ *
+ * @return			EI_TRUE if the event came from the loader thread.
+ */
+ei_bool_t ei_image_handle_event(ei_event_t* event);
+
+/**
+ * @brief	Takes one more reference on an image. Called by the configure functions when
+ *		an image is given to a widget.
+ *
+ * @param	image		The image.
+ * @param	holder		The widget that displays the image, or NULL. The widgets that
+ *				display a placeholder are given the image when it is decoded.
+ *
+ * @return			EI_FALSE if the image was not returned by \ref ei_image_acquire,
+ *				in which case nothing is done.
+ */
+ei_bool_t ei_image_retain(ei_surface_t image, ei_widget_t* holder);
+
+/**
+ * @brief	Gives back a reference on an image. An image without reference stays in the
+ *		registry until the memory budget is exceeded.
+ *
+ * @param	image		The image. Nothing is done if it does not come from the registry.
+ */
+void ei_image_release(ei_surface_t image);
+
+/**
+ * @brief	Gives back a reference taken by \ref ei_image_retain. Called by the configure
+ *		functions when a widget is given another image, and when it is destroyed.
+ *
+ * @param	image		The image. Nothing is done if it does not come from the registry.
+ * @param	holder		The widget given to \ref ei_image_retain.
+ */
+void ei_image_release_holder(ei_surface_t image, ei_widget_t* holder);
+
+/**
+ * @brief	Sets the memory budget of the unused images, and frees the least recently
+ *		used ones until it is met.
+ *
+ * @param	bytes		The budget, in bytes. The default is EI_IMAGE_DEFAULT_BUDGET.
+ */
+void ei_image_set_budget(size_t bytes);
+
+/**
+ * @brief	Returns the usage statistics of the image registry.
+ *
+ * @param	stats		Where to store the statistics.
+ */
+void ei_image_get_stats(ei_image_stats_t* stats);
+
+/**
+ * @brief	Stops the loader thread and frees all the images of the registry. Called by
+ *		\ref ei_app_free.
+ */
+void ei_image_free_all();
+
+#endif
@@ -0,0 +1,90 @@
+/**
+ *  @file	ei_layer.h
+ *  @brief	Premultiplied alpha surfaces. The colors of a premultiplied surface are already
+ *		weighted by their alpha, so drawing it over another surface is a single
+ *		multiply per channel: dst = src + dst * (1 - alpha). The library keeps in this
+ *		format the layers of the translucent widgets, the images of the registry (see
+ *		\ref ei_image_acquire) and their scaled copies. The surfaces given by the
+ *		application are left as they are.
+ *
+ */
+#ifndef EI_LAYER_H
+#define EI_LAYER_H
+
+#include "ei_types.h"
+#include "hw_interface.h"
+
+/**
+ * @brief	Usage statistics of the layers.
+ */
+typedef struct {
+    int			premultiplied;	///< The number of surfaces marked as premultiplied.
+    int			layers;		///< The number of layers, in use or kept free (one per thread at most).
+    unsigned long	created;	///< The number of layers created.
+    unsigned long	reused;		///< The number of times a layer was reused.
+} ei_layer_stats_t;
+
+/**
+ * @brief	Marks a surface as premultiplied, or not. A surface must be unmarked before
+ *		being freed. Can be called from several threads.
+ *
+ * @param	surface		A surface with an alpha channel.
+ * @param	premultiplied	EI_TRUE if the colors of the surface are premultiplied.
+ */
+void ei_layer_set_premultiplied(ei_surface_t surface, ei_bool_t premultiplied);
+
+/**
+ * @brief	Tells whether the colors of a surface are premultiplied by their alpha.
+ *
+ * @param	surface		The surface.
+ *
+ * @return			EI_TRUE if the surface has been marked, EI_FALSE otherwise (and
+ *				always for the surfaces without an alpha channel).
+ */
+ei_bool_t ei_layer_is_premultiplied(ei_surface_t surface);
+
+/**
+ * @brief	Converts the pixels of a surface to premultiplied alpha, and marks it. Nothing
+ *		is done if the surface has no alpha channel or is already premultiplied.
+ *
+ * @param	surface		The surface, for example an image just returned by
+ *				\ref hw_image_load.
+ */
+void ei_layer_premultiply(ei_surface_t surface);
+
+/**
+ * @brief	Returns a transparent premultiplied surface of the size of a surface, to draw a
+ *		translucent widget before blending it with \ref ei_layer_end. The layers are
+ *		reused from one draw to the next, only the clipper is cleared.
+ *
+ * @param	surface		The surface where the layer will be blended.
+ * @param	clipper		The part of the layer that will be drawn, or NULL for all of it.
+ *
+ * @return			The layer.
+ */
+ei_surface_t ei_layer_begin(ei_surface_t surface, const ei_rect_t* clipper);
+
+/**
+ * @brief	Blends a layer returned by \ref ei_layer_begin in the surface, and gives it back.
+ *		It is freed if there are already as many free layers as threads in the pool.
+ *
+ * @param	surface		The surface.
+ * @param	layer		The layer.
+ * @param	clipper		The clipper given to \ref ei_layer_begin.
+ */
+void ei_layer_end(ei_surface_t surface, ei_surface_t layer, const ei_rect_t* clipper);
+
+/**
+ * @brief	Returns the usage statistics of the layers.
+ *
+ * @param	stats		Where to store the statistics.
+ */
+void ei_layer_get_stats(ei_layer_stats_t* stats);
+
+/**
+ * @brief	Frees the layers and forgets the premultiplied surfaces. Called by
+ *		\ref ei_app_free.
+ */
+void ei_layer_free_all();
+
+#endif
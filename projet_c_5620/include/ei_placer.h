@@ -47,16 +47,37 @@ typedef struct ei_placer_params_t {
 	float			rw_data;
 	float*			rh;		///< The requested relative height.
 	float			rh_data;
+
+	ei_bool_t		dirty;		///< The geometry must be computed by the next layout pass.
+	ei_bool_t		children_dirty;	///< The geometry of a descendant must be computed by the next layout pass.
+	ei_point_t		origin;		///< The top left corner of the area of the parent when the geometry was last computed.
 } ei_placer_params_t;
 
 
 
+/**
+ * @brief	Usage statistics of the placer.
+ */
+typedef struct {
+	unsigned long		placements;	///< The number of calls to \ref ei_place.
+	unsigned long		coalesced;	///< The number of calls to \ref ei_place on a widget that
+						///< was already waiting for the layout pass.
+	unsigned long		passes;		///< The number of layout passes.
+	unsigned long		runs;		///< The number of geometry computations.
+} ei_placer_stats_t;
+
+
+
 /**
  * \brief	Configures the geometry of a widget using the "placer" geometry manager.
  * 		If the widget was already managed by another geometry manager, then it is first
  *		removed from the previous geometry manager.
  * 		If the widget was already managed by the "placer", then this calls simply updates
  *		the placer parameters: arguments that are not NULL replace previous values.
+ *		The geometry is not computed by this call: the widget is marked, and all the
+ *		widgets placed before the next frame are placed together by one layout pass
+ *		(\ref ei_placer_flush). Placing the same widget several times before the frame
+ *		costs a single computation.
  * 		When the arguments are passed as NULL, the placer uses default values (detailed in
  *		the argument descriptions below). If no size is provided (either absolute or
  *		relative), then the requested size of the widget is used, i.e. the minimal size
@@ -106,13 +127,68 @@ void ei_placer_run(struct ei_widget_t* widget);
 
 
 
+/**
+ * \brief	Marks a widget placed by the placer: its geometry is computed by the next layout
+ *		pass, with the other marked widgets. Does nothing if the widget is not placed.
+ *
+ * @param	widget		The widget which geometry must be re-computed.
+ */
+void ei_placer_invalidate(struct ei_widget_t* widget);
+
+
+
+/**
+ * \brief	Runs the layout pass: computes the geometry of the marked widgets, from the root
+ *		down to the leaves, so that a widget is placed after its parent. The old and the
+ *		new locations of a widget that has moved are invalidated. Called before each
+ *		frame is drawn; the application can call it to know the position of the widgets
+ *		it has just placed.
+ */
+void ei_placer_flush();
+
+
+
+/**
+ * \brief	Tells if widgets are waiting for the layout pass.
+ *
+ * @return			EI_TRUE if a widget is marked.
+ */
+ei_bool_t ei_placer_pending();
+
+
+
+/**
+ * @brief	Returns the usage statistics of the placer.
+ *
+ * @param	stats		Where to store the statistics.
+ */
+void ei_placer_get_stats(ei_placer_stats_t* stats);
+
+
+
 /**
  * \brief	Tells the placer to remove a widget from the screen and forget about it.
- *		Note: the widget is not destroyed and still exists in memory.
+ *		Note: the widget is not destroyed and still exists in memory. When it is
+ *		placed again, the next layout pass also places its descendants that were
+ *		waiting for it.
  *
  * @param	widget		The widget to remove from screen.
  */
 void ei_placer_forget(struct ei_widget_t* widget);
 
 
+
+/**
+ * \brief	Returns the area in which the placer puts the children of a widget: its screen
+ *		location, the content of a scrollframe, without the title bar of a toplevel.
+ *		The absolute coordinates given to \ref ei_place are relative to its top left
+ *		corner.
+ *
+ * @param	widget		The parent widget.
+ *
+ * @return			The area, in the root window coordinates.
+ */
+ei_rect_t ei_placer_area(struct ei_widget_t* widget);
+
+
 #endif
@@ -0,0 +1,76 @@
+/**
+ *  @file	ei_pool.h
+ *  @brief	Pool of worker threads used by the renderer and the drawing primitives. A run
+ *		splits a number of tasks between the workers and the calling thread; a worker
+ *		that has finished its share steals half of the remaining tasks of another one.
+ *
+ */
+#ifndef EI_POOL_H
+#define EI_POOL_H
+
+#include "ei_types.h"
+
+/**
+ * @brief	A task of a run.
+ *
+ * @param	index		The index of the task, from 0 to the number of tasks - 1.
+ * @param	user_param	The parameter given to \ref ei_pool_run.
+ */
+typedef void (*ei_pool_task_t) (int index, void* user_param);
+
+/**
+ * @brief	Usage statistics of the pool.
+ */
+typedef struct {
+    int			threads;	///< The number of threads, the calling thread included.
+    unsigned long	runs;		///< The number of runs executed in parallel.
+    unsigned long	tasks;		///< The number of tasks executed in parallel.
+    unsigned long	steals;		///< The number of times a thread stole tasks.
+} ei_pool_stats_t;
+
+/**
+ * @brief	Executes count tasks and returns when all of them are done. The tasks are run
+ *		in parallel, in any order. When called from a task, or with a single thread, the
+ *		tasks are run one after the other by the calling thread.
+ *
+ * @param	count		The number of tasks.
+ * @param	task		The function of the tasks.
+ * @param	user_param	A parameter passed to all the tasks.
+ */
+void ei_pool_run(int count, ei_pool_task_t task, void* user_param);
+
+/**
+ * @brief	Sets the number of threads of the pool, the calling thread included. The
+ *		default is the number of processors, up to 16.
+ *
+ * @param	threads		The number of threads, 1 to draw in the calling thread only.
+ */
+void ei_pool_set_threads(int threads);
+
+/**
+ * @brief	Returns the number of threads of the pool, the calling thread included.
+ *
+ * @return			The number of threads.
+ */
+int ei_pool_get_threads();
+
+/**
+ * @brief	Tells if the calling thread is executing a task of the pool.
+ *
+ * @return			EI_TRUE inside a task.
+ */
+ei_bool_t ei_pool_in_task();
+
+/**
+ * @brief	Returns the usage statistics of the pool.
+ *
+ * @param	stats		Where to store the statistics.
+ */
+void ei_pool_get_stats(ei_pool_stats_t* stats);
+
+/**
+ * @brief	Stops the worker threads. Called by \ref ei_app_free.
+ */
+void ei_pool_free();
+
+#endif
@@ -0,0 +1,77 @@
+/**
+ *  @file	ei_renderer.h
+ *  @brief	Tiled renderer: the region to redraw is split into tiles, the visible widgets
+ *		are sorted into the tiles they overlap, and the tiles are drawn in parallel by the
+ *		threads of the pool (see \ref ei_pool_run), each one clipped to its tile.
+ *
+ */
+#ifndef EI_RENDERER_H
+#define EI_RENDERER_H
+
+#include "ei_types.h"
+#include "ei_widget.h"
+
+/* Taille par defaut des tuiles, en pixels */
+#define EI_RENDERER_DEFAULT_TILE_SIZE	128
+
+/**
+ * @brief	Usage statistics of the renderer.
+ */
+typedef struct {
+    unsigned long	frames;		///< The number of calls to \ref ei_render.
+    unsigned long	parallel_frames;///< The number of frames drawn by several threads.
+    int			items;		///< The number of widgets drawn in the last frame.
+    int			tiles;		///< The number of tiles of the last frame.
+    int			binned;		///< The number of (widget, tile) pairs of the last frame.
+    int			culled;		///< The number of widgets of the last frame that were not
+					///< drawn, hidden by opaque widgets in front of them.
+    int			trimmed;	///< The number of widgets of the last frame whose clipper
+					///< was reduced by opaque widgets in front of them.
+} ei_renderer_stats_t;
+
+/**
+ * @brief	Draws a widget and its descendants in a region. The clipper of each widget is
+ *		computed once, from the clipper of its parent restricted to the content_rect of
+ *		the parent. The widgets must have been placed (\ref ei_placer_flush).
+ *		A widget hidden by opaque widgets drawn after it (its descendants, later
+ *		siblings, later toplevels) is not drawn, see \ref ei_widget_opaque_rect.
+ *		The tiles are drawn by the threads of the pool, unless a widget of a class
+ *		registered by the application is drawn: its drawfunc may not be thread-safe.
+ *
+ * @param	root		The widget at the top of the tree, usually the root widget.
+ * @param	region		The region to redraw, or NULL for the whole root widget.
+ * @param	surface		Where to draw the widgets, or NULL.
+ * @param	pick_surface	Where to draw the pick colors of the widgets, or NULL.
+ */
+void ei_render(ei_widget_t* root, ei_linked_rect_t* region, ei_surface_t surface,
+	       ei_surface_t pick_surface);
+
+/**
+ * @brief	Sets the size of the tiles.
+ *
+ * @param	size		The width and height of the tiles, in pixels. The default is
+ *				EI_RENDERER_DEFAULT_TILE_SIZE.
+ */
+void ei_renderer_set_tile_size(int size);
+
+/**
+ * @brief	Enables or disables the occlusion culling: when disabled, every visible widget
+ *		is drawn, back to front. Enabled by default.
+ *
+ * @param	enabled		EI_TRUE to skip the widgets hidden by opaque widgets.
+ */
+void ei_renderer_set_culling(ei_bool_t enabled);
+
+/**
+ * @brief	Returns the usage statistics of the renderer.
+ *
+ * @param	stats		Where to store the statistics.
+ */
+void ei_renderer_get_stats(ei_renderer_stats_t* stats);
+
+/**
+ * @brief	Releases the memory of the renderer. Called by \ref ei_app_free.
+ */
+void ei_renderer_free();
+
+#endif
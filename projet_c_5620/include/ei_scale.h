@@ -0,0 +1,113 @@
+/**
+ *  @file	ei_scale.h
+ *  @brief	Scaled copies of the images displayed by the frames and the buttons. A scaled
+ *		copy is resampled once per size and kept in a cache; strong reductions start
+ *		from a chain of images halved with a box filter (mipmaps), then the last step
+ *		is bilinear.
+ *
+ */
+#ifndef EI_SCALE_H
+#define EI_SCALE_H
+
+#include <stddef.h>
+#include "ei_types.h"
+#include "ei_widget.h"
+#include "hw_interface.h"
+
+/* Budget par defaut des copies redimensionnees et des mipmaps, en octets */
+#define EI_SCALE_DEFAULT_BUDGET		(8 * 1024 * 1024)
+
+/**
+ * @brief	How the image of a frame or a button is displayed in the widget.
+ */
+typedef enum {
+    ei_scale_none	= 0,	///< The image (or its "img_rect" part) is displayed at 1:1 scale.
+    ei_scale_stretch,		///< The image fills the inside of the widget.
+    ei_scale_fit		///< The image fits in the widget, keeping its proportions.
+} ei_scaling_t;
+
+/**
+ * @brief	Usage statistics of the scaling cache.
+ */
+typedef struct {
+    int			copies;		///< The number of scaled copies in the cache.
+    int			mip_levels;	///< The number of mipmaps, all sources included.
+    size_t		bytes;		///< The size of the copies and of the mipmaps, in bytes.
+    unsigned long	hits;		///< The number of copies found in the cache.
+    unsigned long	resamples;	///< The number of copies computed.
+    unsigned long	evictions;	///< The number of copies freed for the budget.
+} ei_scale_stats_t;
+
+/**
+ * @brief	Sets how the image of a frame or a button is displayed. With scaling, the
+ *		image (or its "img_rect" part) is resized to the inside of the widget, the
+ *		anchor of the image placing it when its proportions are kept.
+ *
+ * @param	widget		A frame or a button. Nothing is done for the other classes.
+ * @param	scaling		The scaling mode, ei_scale_none by default.
+ */
+void ei_widget_set_img_scaling(ei_widget_t* widget, ei_scaling_t scaling);
+
+/**
+ * @brief	Computes the size at which an image is displayed in an area.
+ *
+ * @param	image		The size of the image.
+ * @param	area		The size of the area.
+ * @param	scaling		The scaling mode.
+ *
+ * @return			The size of the displayed image, at least 1x1.
+ */
+ei_size_t ei_scale_fit_size(ei_size_t image, ei_size_t area, ei_scaling_t scaling);
+
+/**
+ * @brief	Returns a part of an image resized to a given size. The copy is computed the
+ *		first time, and taken from the cache the following times. Can be called from
+ *		several threads.
+ *
+ * @param	source		The image.
+ * @param	rect		The part of the image to resize, or NULL for the whole image.
+ * @param	size		The size of the copy.
+ *
+ * @return			The copy, which must be given back with \ref ei_scale_release,
+ *				or NULL if the parameters are invalid.
+ */
+ei_surface_t ei_scale_acquire(ei_surface_t source, const ei_rect_t* rect, ei_size_t size);
+
+/**
+ * @brief	Gives back a copy returned by \ref ei_scale_acquire. It stays in the cache
+ *		within the memory budget.
+ *
+ * @param	scaled		The copy.
+ */
+void ei_scale_release(ei_surface_t scaled);
+
+/**
+ * @brief	Frees the copies and the mipmaps of an image. Must be called before freeing
+ *		an image that has been scaled, or after changing its pixels. The images of the
+ *		registry (see \ref ei_image_acquire) are forgotten automatically.
+ *
+ * @param	source		The image.
+ */
+void ei_scale_forget(ei_surface_t source);
+
+/**
+ * @brief	Sets the memory budget of the cache, and frees the least recently used copies
+ *		until it is met.
+ *
+ * @param	bytes		The budget, in bytes. The default is EI_SCALE_DEFAULT_BUDGET.
+ */
+void ei_scale_set_budget(size_t bytes);
+
+/**
+ * @brief	Returns the usage statistics of the scaling cache.
+ *
+ * @param	stats		Where to store the statistics.
+ */
+void ei_scale_get_stats(ei_scale_stats_t* stats);
+
+/**
+ * @brief	Frees all the copies and the mipmaps. Called by \ref ei_app_free.
+ */
+void ei_scale_free_all();
+
+#endif
@@ -0,0 +1,112 @@
+/**
+ *  @file	ei_slab.h
+ *  @brief	Slab allocator for the widget instances: the widgets of a class are allocated in
+ *		blocks of fixed-size slots instead of one malloc each, and a freed slot is reused
+ *		by the next widget of the same class.
+ *
+ */
+#ifndef EI_SLAB_H
+#define EI_SLAB_H
+
+#include <stddef.h>
+#include "ei_types.h"
+#include "ei_widgetclass.h"
+
+/**
+ * @brief	An opaque cache of slabs holding objects of one size.
+ */
+typedef struct ei_slab_cache_t ei_slab_cache_t;
+
+/**
+ * @brief	Usage statistics of a slab cache.
+ */
+typedef struct {
+    size_t		object_size;		///< The size of an object, in bytes.
+    int			objects_per_slab;	///< The number of objects that fit in a slab.
+    int			slabs;			///< The number of slabs currently allocated.
+    int			live;			///< The number of objects currently allocated.
+    int			peak;			///< The highest number of live objects so far.
+    unsigned long	allocations;		///< The number of calls to \ref ei_slab_alloc.
+    unsigned long	releases;		///< The number of calls to \ref ei_slab_free.
+    float		utilization;		///< live / (slabs * objects_per_slab), 0 if no slab.
+} ei_slab_stats_t;
+
+/**
+ * @brief	Creates a cache for objects of a given size.
+ *
+ * @param	object_size	The size of the objects, in bytes.
+ *
+ * @return			The cache.
+ */
+ei_slab_cache_t* ei_slab_cache_create(size_t object_size);
+
+/**
+ * @brief	Releases a cache and all its slabs. The objects still allocated become invalid.
+ *
+ * @param	cache		The cache.
+ */
+void ei_slab_cache_destroy(ei_slab_cache_t* cache);
+
+/**
+ * @brief	Allocates an object from a cache. Like calloc, all its bytes are set to 0.
+ *
+ * @param	cache		The cache.
+ *
+ * @return			The object.
+ */
+void* ei_slab_alloc(ei_slab_cache_t* cache);
+
+/**
+ * @brief	Gives an object back to the cache it was allocated from. Slabs left empty are
+ *		returned to the system, except one which is kept for the next allocations.
+ *
+ * @param	object		The object, returned by \ref ei_slab_alloc.
+ */
+void ei_slab_free(void* object);
+
+/**
+ * @brief	Returns the usage statistics of a cache.
+ *
+ * @param	cache		The cache.
+ * @param	stats		Where to store the statistics.
+ */
+void ei_slab_get_stats(ei_slab_cache_t* cache, ei_slab_stats_t* stats);
+
+/**
+ * @brief	Declares the size of the widgets of a class: they are then allocated by
+ *		\ref ei_widget_create from a slab cache of this class instead of by its
+ *		allocfunc, and released by \ref ei_widget_destroy after its releasefunc.
+ *		Classes that do not call this function keep using their allocfunc, and are
+ *		released with free.
+ *
+ * @param	widgetclass	The class, already registered.
+ * @param	widget_size	The size of the structure of the widgets of the class.
+ */
+void ei_widgetclass_set_slab(ei_widgetclass_t* widgetclass, size_t widget_size);
+
+/**
+ * @brief	Returns the slab cache of a class.
+ *
+ * @param	id		The identifier of the class, see \ref ei_widgetclass_get_id.
+ *
+ * @return			The cache, or NULL if \ref ei_widgetclass_set_slab was not
+ *				called for this class.
+ */
+ei_slab_cache_t* ei_widgetclass_get_slab(ei_widgetclass_id_t id);
+
+/**
+ * @brief	Returns the usage statistics of the widgets of a class.
+ *
+ * @param	name		The name of the class.
+ * @param	stats		Where to store the statistics.
+ *
+ * @return			EI_FALSE if the class does not exist or has no slab cache.
+ */
+ei_bool_t ei_widgetclass_get_stats(ei_widgetclass_name_t name, ei_slab_stats_t* stats);
+
+/**
+ * @brief	Releases the slab caches of all the classes. Called by \ref ei_app_free.
+ */
+void ei_widgetclass_free_slabs();
+
+#endif
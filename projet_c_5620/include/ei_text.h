@@ -0,0 +1,59 @@
+/**
+ *  @file	ei_text.h
+ *  @brief	Measurement of texts: the size of a text in a font is computed once by
+ *		\ref hw_text_compute_size, without rendering it, and kept in a cache.
+ *
+ */
+#ifndef EI_TEXT_H
+#define EI_TEXT_H
+
+#include "ei_types.h"
+
+/**
+ * @brief	Usage statistics of the measurement cache.
+ */
+typedef struct {
+    unsigned long	hits;		///< The number of sizes found in the cache.
+    unsigned long	misses;		///< The number of sizes computed by \ref hw_text_compute_size.
+    int			entries;	///< The number of sizes currently in the cache.
+} ei_text_stats_t;
+
+/**
+ * @brief	Returns the size of the surface that \ref hw_text_create_surface would create
+ *		for a text, without rendering it.
+ *
+ * @param	text		The text, can be NULL.
+ * @param	font		The font, or NULL for \ref ei_default_font.
+ *
+ * @return			The size of the text, (0, 0) if text is NULL.
+ */
+ei_size_t ei_text_measure(const char* text, ei_font_t font);
+
+/**
+ * @brief	Takes the lock that serializes the calls to the font library (hw_text_*
+ *		functions), which is not thread-safe. The texts are measured and rasterized
+ *		by the threads of the renderer: every call that uses a font from them must be
+ *		made with this lock held.
+ */
+void ei_text_lock_fonts();
+
+/**
+ * @brief	Releases the lock taken by \ref ei_text_lock_fonts.
+ */
+void ei_text_unlock_fonts();
+
+/**
+ * @brief	Returns the usage statistics of the measurement cache.
+ *
+ * @param	stats		Where to store the statistics.
+ */
+void ei_text_get_stats(ei_text_stats_t* stats);
+
+/**
+ * @brief	Empties the measurement cache. Must be called before a font is freed by
+ *		\ref hw_text_font_free, since the sizes are identified by the address of the font.
+ *		Called by \ref ei_app_free.
+ */
+void ei_text_free_cache();
+
+#endif
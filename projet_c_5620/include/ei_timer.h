@@ -0,0 +1,69 @@
+/**
+ *  @file	ei_timer.h
+ *  @brief	Timers multiplexed on a single application event (see \ref hw_event_schedule_app)
+ *		with a hierarchical timing wheel: adding, cancelling and firing a timer do not
+ *		depend on the number of timers.
+ *
+ */
+#ifndef EI_TIMER_H
+#define EI_TIMER_H
+
+#include "ei_types.h"
+#include "ei_event.h"
+
+/**
+ * @brief	An opaque timer, returned by \ref ei_timer_add.
+ */
+typedef struct ei_timer_t ei_timer_t;
+
+/**
+ * @brief	The function called when a timer expires.
+ *
+ * @param	user_param	The user parameter given to \ref ei_timer_add.
+ */
+typedef void (*ei_timer_callback_t) (void* user_param);
+
+/**
+ * @brief	Calls a function after a delay. The precision is one millisecond, the callback
+ *		is called from the main loop (see \ref ei_app_run).
+ *
+ * @param	ms_delay	The delay, in milliseconds.
+ * @param	callback	The function to call.
+ * @param	user_param	A parameter passed to the callback.
+ *
+ * @return			The timer. It is released after its callback returns: it must not
+ *				be cancelled from then on.
+ */
+ei_timer_t* ei_timer_add(int ms_delay, ei_timer_callback_t callback, void* user_param);
+
+/**
+ * @brief	Cancels a timer that has not expired yet, and releases it.
+ *
+ * @param	timer		The timer, as returned by \ref ei_timer_add.
+ */
+void ei_timer_cancel(ei_timer_t* timer);
+
+/**
+ * @brief	Tests if an event is a wake up scheduled by the timers, and if so, calls the
+ *		callbacks of all the expired timers.
+ *
+ * @param	event		The event received by the main loop.
+ *
+ * @return			EI_TRUE if the event was for the timers (it must not be
+ *				dispatched), EI_FALSE otherwise.
+ */
+ei_bool_t ei_timer_handle_event(ei_event_t* event);
+
+/**
+ * @brief	Returns the number of timers that have not expired yet.
+ *
+ * @return			The number of pending timers.
+ */
+int ei_timer_pending();
+
+/**
+ * @brief	Cancels all the pending timers. Called by \ref ei_app_free.
+ */
+void ei_timer_free_all();
+
+#endif
@@ -0,0 +1,140 @@
+/**
+ *  @file	ei_widget_listbox.h
+ *  @brief	Functions related to listboxes: a scrollframe that shows a list of items, one
+ *		row per item. Only the rows that are visible exist as widgets: they are
+ *		taken from a pool and given the data of their item by a user function.
+ *
+ */
+#ifndef EI_WIDGET_LISTBOX_H
+#define EI_WIDGET_LISTBOX_H
+
+#include "ei_draw.h"
+#include "ei_widgetclass.h"
+#include "ei_placer.h"
+#include "ei_types.h"
+#include "ei_widget.h"
+
+/**
+ * @brief	The function that gives a row the data of an item, usually by configuring it
+ *		(\ref ei_frame_configure for the default class of rows). The row keeps the
+ *		attributes it was given until it is given another item.
+ *
+ * @param	row		The row widget, placed where the item is.
+ * @param	index		The index of the item, between 0 and the number of items - 1.
+ * @param	user_param	The user parameter given to \ref ei_listbox_configure.
+ */
+typedef void (*ei_listbox_rowfunc_t) (ei_widget_t* row, int index, void* user_param);
+
+/**
+ * @brief	Usage statistics of the listboxes.
+ */
+typedef struct {
+    unsigned long	rows;		///< The number of row widgets created.
+    unsigned long	binds;		///< The number of calls of the row functions.
+    unsigned long	hidden;		///< The number of rows removed from screen, without item.
+} ei_listbox_stats_t;
+
+/**
+ * @brief	Configures the attributes of widgets of the class "listbox". The parameters
+ *		obey the "default" protocol of \ref ei_frame_configure.
+ *
+ * @param	widget		The widget to configure.
+ * @param	requested_size	The size requested for this widget, including borders.
+ *				Defaults to 200 pixels wide and 10 rows high.
+ * @param	color		The color of the background of the widget. Defaults to
+ *				\ref ei_default_background_color.
+ * @param	border_width	The width in pixel of the border decoration of the widget.
+ *				Defaults to 0.
+ * @param	relief		Appearance of the border of the widget. Defaults to
+ *				\ref ei_relief_none.
+ * @param	item_count	The number of items of the list. Defaults to 0.
+ * @param	row_height	The height of a row, in pixels. Defaults to the height of a line
+ *				of text in \ref ei_default_font, plus 4.
+ * @param	row_class	The class of the row widgets, which must be registered: an unknown
+ *				class is ignored. Defaults to "frame". Changing it destroys the
+ *				rows of the pool. Dragging a row drags the list, the row still
+ *				receives the mouse events.
+ * @param	rowfunc		The function that gives a row the data of its item. Defaults to
+ *				NULL: the rows are only placed.
+ * @param	user_param	A programmer supplied parameter that will be passed to the row
+ *				function. Defaults to NULL.
+ */
+void			ei_listbox_configure		(ei_widget_t*		widget,
+        ei_size_t*		requested_size,
+        const ei_color_t*	color,
+        int*			border_width,
+        ei_relief_t*		relief,
+        int*			item_count,
+        int*			row_height,
+        char**			row_class,
+        ei_listbox_rowfunc_t*	rowfunc,
+        void**			user_param);
+
+/**
+ * @brief	Scrolls a listbox so that an item is at the top of the viewport, or as close
+ *		as possible if the list ends before.
+ *
+ * @param	widget		The listbox.
+ * @param	index		The index of the item.
+ */
+void ei_listbox_scroll_to_item(ei_widget_t* widget, int index);
+
+/**
+ * @brief	Calls the row function again for the rows that show items in a range, after
+ *		the data of these items has changed. The other items are given their data when
+ *		they become visible.
+ *
+ * @param	widget		The listbox.
+ * @param	first		The index of the first item that has changed.
+ * @param	count		The number of items that have changed.
+ */
+void ei_listbox_refresh(ei_widget_t* widget, int first, int count);
+
+/**
+ * @brief	Returns the item shown by a row of a listbox, for example in the callback of a
+ *		click on the row.
+ *
+ * @param	widget		The listbox.
+ * @param	row		A row widget of the listbox.
+ *
+ * @return			The index of the item, or -1 if the row shows no item.
+ */
+int ei_listbox_row_item(ei_widget_t* widget, ei_widget_t* row);
+
+/**
+ * @brief	Returns the usage statistics of the listboxes.
+ *
+ * @param	stats		Where to store the statistics.
+ */
+void ei_listbox_get_stats(ei_listbox_stats_t* stats);
+
+/**
+ * \brief	Registers the "listbox" widget class in the program. This must be called
+ *		only once before widgets of the class "listbox" can be created and
+ *		configured with \ref ei_listbox_configure.
+ */
+void			ei_listbox_register_class	();
+
+/**
+ * \brief	A function that allocates a block of memory that is big enough to store the
+ *		attributes of a listbox. After allocation, the function *must* initialize
+ *		the memory to 0.
+ */
+void*	ei_listbox_allocfunc_t		();
+
+/**
+ * \brief	A function that releases the memory used by a listbox before it is destroyed:
+ *		the pool of rows. The rows themselves are destroyed as its children.
+ *
+ * @param	widget		The widget which resources are to be freed.
+ */
+void	ei_listbox_releasefunc_t	(struct ei_widget_t*	widget);
+
+/**
+ * \brief	A function that sets the default values for a listbox.
+ *
+ * @param	widget		A pointer to the widget instance to intialize.
+ */
+void	ei_listbox_setdefaultsfunc_t	(struct ei_widget_t*	widget);
+
+#endif
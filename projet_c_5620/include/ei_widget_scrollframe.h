@@ -0,0 +1,159 @@
+/**
+ *  @file	ei_widget_scrollframe.h
+ *  @brief	Functions related to scrollframes: a frame that shows a part (the viewport) of a
+ *		larger content where its children are placed. Scrolling moves the pixels already
+ *		on screen and only redraws the strip that is uncovered.
+ *
+ */
+#ifndef EI_WIDGET_SCROLLFRAME_H
+#define EI_WIDGET_SCROLLFRAME_H
+
+#include "ei_draw.h"
+#include "ei_widgetclass.h"
+#include "ei_placer.h"
+#include "ei_types.h"
+#include "ei_widget.h"
+
+/**
+ * @brief	Usage statistics of the scrollframes.
+ */
+typedef struct {
+    unsigned long	scrolls;	///< The number of changes of offset.
+    unsigned long	blits;		///< The number of scrolls done by moving the pixels.
+    unsigned long	repaints;	///< The number of scrolls that redrew the whole viewport.
+    unsigned long	moved_pixels;	///< The number of pixels moved on screen.
+    unsigned long	exposed_pixels;	///< The number of pixels uncovered and redrawn.
+    unsigned long	placed_children;///< The number of children placed again by the scrolls: only
+					///< those in the viewport are.
+} ei_scrollframe_stats_t;
+
+/**
+ * @brief	Configures the attributes of widgets of the class "scrollframe". The parameters
+ *		obey the "default" protocol of \ref ei_frame_configure.
+ *
+ * @param	widget		The widget to configure.
+ * @param	requested_size	The size requested for this widget, including borders.
+ *				Defaults to the size of the content plus the borders.
+ * @param	color		The color of the background of the widget. Defaults to
+ *				\ref ei_default_background_color.
+ * @param	border_width	The width in pixel of the border decoration of the widget.
+ *				Defaults to 0.
+ * @param	relief		Appearance of the border of the widget. Defaults to
+ *				\ref ei_relief_none.
+ * @param	content_size	The size of the content. The children are placed in the content:
+ *				their positions are relative to its top left corner, and their
+ *				relative sizes to its size. Defaults to (0, 0).
+ */
+void			ei_scrollframe_configure	(ei_widget_t*		widget,
+        ei_size_t*		requested_size,
+        const ei_color_t*	color,
+        int*			border_width,
+        ei_relief_t*		relief,
+        ei_size_t*		content_size);
+
+/**
+ * @brief	Scrolls a scrollframe: the point "offset" of the content is shown at the top
+ *		left corner of the viewport. The offset is kept between (0, 0) and the size of
+ *		the content minus the size of the viewport. Only the children in the viewport,
+ *		or that leave it, are placed again: the others keep their screen location until
+ *		a scroll brings them into view.
+ *
+ * @param	widget		The scrollframe.
+ * @param	offset		The new offset.
+ */
+void ei_scrollframe_scroll_to(ei_widget_t* widget, ei_point_t offset);
+
+/**
+ * @brief	Returns the point of the content shown at the top left corner of the viewport.
+ *
+ * @param	widget		The scrollframe.
+ *
+ * @return			The offset.
+ */
+ei_point_t ei_scrollframe_get_offset(ei_widget_t* widget);
+
+/**
+ * @brief	Returns where the content of a scrollframe is on screen, for the placer. Only
+ *		the part of it within the viewport (the content_rect) is visible.
+ *
+ * @param	widget		The scrollframe.
+ *
+ * @return			The rectangle of the content, in the root window coordinates.
+ */
+ei_rect_t ei_scrollframe_content_area(ei_widget_t* widget);
+
+/**
+ * @brief	Returns the usage statistics of the scrollframes.
+ *
+ * @param	stats		Where to store the statistics.
+ */
+void ei_scrollframe_get_stats(ei_scrollframe_stats_t* stats);
+
+/**
+ * \brief	Registers the "scrollframe" widget class in the program. This must be called
+ *		only once before widgets of the class "scrollframe" can be created and
+ *		configured with \ref ei_scrollframe_configure.
+ */
+void			ei_scrollframe_register_class	();
+
+/**
+ * \brief	A function that allocates a block of memory that is big enough to store the
+ *		attributes of a scrollframe. After allocation, the function *must* initialize
+ *		the memory to 0.
+ */
+void*	ei_scrollframe_allocfunc_t		();
+
+/**
+ * \brief	A function that releases the memory used by a scrollframe before it is
+ *		destroyed. The \ref ei_widget_t structure itself must *not* by freed.
+ *
+ * @param	widget		The widget which resources are to be freed.
+ */
+void	ei_scrollframe_releasefunc_t	(struct ei_widget_t*	widget);
+
+/**
+ * \brief	A function that draws a scrollframe: its border and the background of the
+ *		viewport. The children are drawn by the renderer, clipped to the viewport.
+ *
+ * @param	widget		A pointer to the widget instance to draw.
+ * @param	surface		Where to draw the widget, or NULL.
+ * @param	pick_surface	Where to draw the pick color of the widget, or NULL.
+ * @param	clipper		If not NULL, the drawing is restricted within this rectangle
+ *				(expressed in the surface reference frame).
+ */
+void	ei_scrollframe_drawfunc_t	(struct ei_widget_t*	widget,
+        ei_surface_t		surface,
+        ei_surface_t		pick_surface,
+        ei_rect_t*		clipper);
+
+/**
+ * \brief	A function that sets the default values for a scrollframe.
+ *
+ * @param	widget		A pointer to the widget instance to intialize.
+ */
+void	ei_scrollframe_setdefaultsfunc_t	(struct ei_widget_t*	widget);
+
+/**
+ * \brief 	A function that is called to notify the scrollframe that its geometry has been
+ *		modified by its geometry manager: updates its viewport.
+ *
+ * @param	widget		The widget instance to notify of a geometry change.
+ * @param	rect		The new rectangular screen location of the widget
+ *				(i.e. = widget->screen_location).
+ */
+void	ei_scrollframe_geomnotifyfunc_t	(struct ei_widget_t*	widget,
+        ei_rect_t		rect);
+
+/**
+ * @brief	A function that is called in response to an event: dragging the background of
+ *		a scrollframe, or a frame of its content, scrolls it.
+ *
+ * @param	widget		The widget for which the event was generated.
+ * @param	event		The event containing all its parameters (type, etc.)
+ *
+ * @return			EI_TRUE, the event is consumed.
+ */
+ei_bool_t ei_scrollframe_handlefunc_t (struct ei_widget_t*	widget,
+        struct ei_event_t*	event);
+
+#endif
@@ -44,11 +44,20 @@ typedef void*	(*ei_widgetclass_allocfunc_t)		();
 typedef void	(*ei_widgetclass_releasefunc_t)		(struct ei_widget_t*	widget);
 
 /**
- * \brief	A function that draws widgets of a class.
+ * \brief	A function that draws widgets of a class. The drawfuncs of the classes of the
+ *		library may be called by the threads of the renderer (see \ref ei_render), once
+ *		per tile with the clipper restricted to the tile. The drawfunc of a class
+ *		registered by the application is always called on the main thread: a frame
+ *		that shows a widget of such a class is drawn by the main thread only.
  *
  * @param	widget		A pointer to the widget instance to draw.
  * @param	surface		Where to draw the widget. The actual location of the widget in the
- *				surface is stored in its "screen_location" field.
+ *				surface is stored in its "screen_location" field. NULL when only
+ *				the picking offscreen has to be redrawn, for the classes of the
+ *				library only: the drawfunc of a class registered by the
+ *				application is always given the screen surface.
+ * @param	pick_surface	The picking offscreen. NULL when the picking offscreen is up to
+ *				date and only the screen has to be redrawn.
  * @param	clipper		If not NULL, the drawing is restricted within this rectangle
  *				(expressed in the surface reference frame).
  */
@@ -137,10 +146,82 @@ void			ei_widgetclass_register		(ei_widgetclass_t* widgetclass);
  *
  * @param	name		The name of the class of widget.
  *
- * @return			The structure describing the class.
+ * @return			The structure describing the class, or NULL if no class has
+ *				exactly this name.
  */
 ei_widgetclass_t*	ei_widgetclass_from_name	(ei_widgetclass_name_t name);
 
+/**
+ * \brief	A stable integer that identifies a class name. Comparing identifiers replaces
+ *		comparing names in the type checks.
+ */
+typedef uint32_t	ei_widgetclass_id_t;
+
+/* Nombre d'identifiants du registre des classes, ei_class_none compris */
+#define EI_MAX_CLASSES		64
+
+/**
+ * \brief	The identifiers of the classes of the library. The other classes get the next
+ *		identifiers, in the order their names are first seen.
+ */
+typedef enum {
+	ei_class_none		= 0,	///< Not a class.
+	ei_class_frame,			///< The class "frame".
+	ei_class_button,		///< The class "button".
+	ei_class_toplevel,		///< The class "toplevel".
+	ei_class_scrollframe,		///< The class "scrollframe".
+	ei_class_listbox,		///< The class "listbox".
+	ei_class_first_user		///< The identifier of the first other class.
+} ei_widgetclass_builtin_t;
+
+/**
+ * @brief	Returns the identifier of a class name. The name is added to the registry if it
+ *		is not there yet, so the identifier can be known before the class is registered.
+ *
+ * @param	name		The name of the class.
+ *
+ * @return			The identifier, or ei_class_none if the registry is full.
+ */
+ei_widgetclass_id_t	ei_widgetclass_intern		(const char* name);
+
+/**
+ * @brief	Returns the identifier of a class name, without adding it to the registry.
+ *
+ * @param	name		The name of the class.
+ *
+ * @return			The identifier, or ei_class_none if the name was never interned.
+ */
+ei_widgetclass_id_t	ei_widgetclass_lookup		(const char* name);
+
+/**
+ * @brief	Returns the identifier of a registered class.
+ *
+ * @param	widgetclass	The class.
+ *
+ * @return			The identifier, or ei_class_none if the class is not registered.
+ */
+ei_widgetclass_id_t	ei_widgetclass_get_id		(ei_widgetclass_t* widgetclass);
+
+/**
+ * @brief	Returns the structure describing a class, from its identifier.
+ *
+ * @param	id		The identifier of the class.
+ *
+ * @return			The structure, or NULL if the class is not registered.
+ */
+ei_widgetclass_t*	ei_widgetclass_from_id		(ei_widgetclass_id_t id);
+
+/**
+ * @brief	Tells if a widget is of a class, without comparing names.
+ *
+ * @param	widget		The widget.
+ * @param	id		The identifier of the class.
+ *
+ * @return			EI_TRUE if the widget is an instance of this class.
+ */
+ei_bool_t		ei_widget_is			(struct ei_widget_t* widget,
+							 ei_widgetclass_id_t id);
+
 /**
  * \brief	Registers the "frame" widget class in the program. This must be called only
  *		once before widgets of the class "frame" can be created and configured with
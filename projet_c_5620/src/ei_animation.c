@@ -0,0 +1,304 @@
+/**
+ *  @file	ei_animation.c
+ *  @brief	Animates properties of widgets: the values are interpolated over a duration, and
+ *		the widgets are redrawn at each step. All the animations are stepped together by
+ *		a single timer (see \ref ei_timer_add), at the frame rate of the application.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ei_animation.h"
+#include "ei_all_widgets.h"
+#include "ei_application.h"
+#include "ei_frame_scheduler.h"
+#include "ei_timer.h"
+#include "hw_interface.h"
+
+#define max(a,b) ((a) > (b) ? a : b)
+#define min(a,b) ((a) < (b) ? a : b)
+
+/* Une propriete entiere, ou les 4 canaux d'une couleur */
+#define MAX_CHANNELS	4
+
+struct ei_animation_t {
+    ei_widget_t*		widget;
+    void*			property;
+    ei_bool_t			is_color;
+    int				from[MAX_CHANNELS];
+    int				to[MAX_CHANNELS];
+    double			start;
+    double			duration;
+    ei_easing_t			easing;
+    ei_animation_done_t		done;
+    void*			user_param;
+    struct ei_animation_t**	list;
+    struct ei_animation_t*	prev;
+    struct ei_animation_t*	next;
+    /* Les animations du meme widget */
+    struct ei_animation_t*	widget_prev;
+    struct ei_animation_t*	widget_next;
+};
+
+static ei_animation_t* ANIMATIONS = NULL;
+/* Animations terminees dont done n'a pas encore ete appele */
+static ei_animation_t* FINISHED = NULL;
+static int COUNT = 0;
+/* L'unique timer qui fait avancer toutes les animations */
+static ei_timer_t* DRIVER = NULL;
+
+/**
+ * \brief	Forgets an animation which has been removed from its list, before freeing it.
+ */
+static void animation_forget(ei_animation_t* animation){
+    ei_widget_links_t* links = ei_widget_links(animation -> widget);
+    if (animation -> widget_prev != NULL) {
+        animation -> widget_prev -> widget_next = animation -> widget_next;
+    } else {
+        links -> animation_head = animation -> widget_next;
+    }
+    if (animation -> widget_next != NULL) {
+        animation -> widget_next -> widget_prev = animation -> widget_prev;
+    }
+    COUNT --;
+    links -> animations --;
+}
+
+static void list_push(ei_animation_t** list, ei_animation_t* animation){
+    animation -> list = list;
+    animation -> prev = NULL;
+    animation -> next = *list;
+    if (*list != NULL) {
+        (*list) -> prev = animation;
+    }
+    *list = animation;
+}
+
+static void list_remove(ei_animation_t* animation){
+    if (animation -> prev != NULL) {
+        animation -> prev -> next = animation -> next;
+    } else {
+        *(animation -> list) = animation -> next;
+    }
+    if (animation -> next != NULL) {
+        animation -> next -> prev = animation -> prev;
+    }
+    animation -> list = NULL;
+}
+
+static double ease(ei_easing_t easing, double t){
+    switch (easing) {
+        case ei_ease_in:
+            return t * t;
+        case ei_ease_out:
+            return t * (2 - t);
+        case ei_ease_in_out:
+            return t < 0.5 ? 2 * t * t : -1 + (4 - 2 * t) * t;
+        default:
+            return t;
+    }
+}
+
+/**
+ * \brief	Writes the value of an animation at progression t in its property.
+ *
+ * @return	EI_TRUE if the property has changed.
+ */
+static ei_bool_t animation_apply(ei_animation_t* animation, double t){
+    double k = ease(animation -> easing, t);
+    int value[MAX_CHANNELS];
+    for (int i = 0; i < MAX_CHANNELS; i++) {
+        value[i] = (int) lround(animation -> from[i]
+            + (animation -> to[i] - animation -> from[i]) * k);
+    }
+    if (animation -> is_color == EI_FALSE) {
+        int* property = (int*) animation -> property;
+        if (*property == value[0]) {
+            return EI_FALSE;
+        }
+        *property = value[0];
+        return EI_TRUE;
+    }
+    ei_color_t* color = (ei_color_t*) animation -> property;
+    ei_color_t new_color = {value[0], value[1], value[2], value[3]};
+    if (color -> red == new_color.red && color -> green == new_color.green
+        && color -> blue == new_color.blue && color -> alpha == new_color.alpha) {
+        return EI_FALSE;
+    }
+    *color = new_color;
+    return EI_TRUE;
+}
+
+static void animation_tick(void* user_param);
+
+/**
+ * \brief	Arms the timer for the next step, once per frame.
+ */
+static void driver_start(){
+    if (DRIVER == NULL && ANIMATIONS != NULL) {
+        int frame_rate = ei_app_get_frame_rate();
+        if (frame_rate <= 0) {
+            frame_rate = EI_DEFAULT_FRAME_RATE;
+        }
+        DRIVER = ei_timer_add(max(1, 1000 / frame_rate), animation_tick, NULL);
+    }
+}
+
+static void animation_tick(void* user_param){
+    DRIVER = NULL;
+    double now = hw_now();
+    ei_animation_t* animation = ANIMATIONS;
+    while (animation != NULL) {
+        ei_animation_t* next = animation -> next;
+        double t = 1;
+        if (animation -> duration > 0) {
+            t = min(1.0, (now - animation -> start) / animation -> duration);
+        }
+        if (animation_apply(animation, t) == EI_TRUE) {
+            ei_widget_t* widget = animation -> widget;
+            // Une propriete entiere peut changer la zone de contenu (bordure d'un toplevel)
+            if (animation -> is_color == EI_FALSE && widget -> wclass -> geomnotifyfunc != NULL) {
+                (widget -> wclass -> geomnotifyfunc)(widget, widget -> screen_location);
+            }
+            ei_app_invalidate_rect(&(widget -> screen_location));
+        }
+        if (t >= 1) {
+            list_remove(animation);
+            list_push(&FINISHED, animation);
+        }
+        animation = next;
+    }
+    // done peut annuler ou lancer d'autres animations
+    while (FINISHED != NULL) {
+        animation = FINISHED;
+        list_remove(animation);
+        // done peut detruire le widget
+        animation_forget(animation);
+        if (animation -> done != NULL) {
+            (animation -> done)(animation -> widget, animation -> user_param);
+        }
+        free(animation);
+    }
+    driver_start();
+}
+
+/**
+ * \brief	Creates an animation and starts the timer if needed.
+ */
+static ei_animation_t* animation_start(ei_widget_t* widget, void* property, ei_bool_t is_color,
+        int duration, ei_easing_t easing, ei_animation_done_t done, void* user_param){
+    // Seules les animations du widget peuvent porter sur la meme propriete ; les
+    // animations terminees dont done n'a pas ete appele sont laissees
+    ei_widget_links_t* links = ei_widget_links(widget);
+    ei_animation_t* animation = links -> animation_head;
+    while (animation != NULL) {
+        ei_animation_t* next = animation -> widget_next;
+        if (animation -> property == property && animation -> list == &ANIMATIONS) {
+            ei_animation_cancel(animation);
+        }
+        animation = next;
+    }
+    animation = calloc(1, sizeof(ei_animation_t));
+    animation -> widget = widget;
+    animation -> property = property;
+    animation -> is_color = is_color;
+    animation -> start = hw_now();
+    animation -> duration = max(0, duration) / 1000.0;
+    animation -> easing = easing;
+    animation -> done = done;
+    animation -> user_param = user_param;
+    list_push(&ANIMATIONS, animation);
+    animation -> widget_next = links -> animation_head;
+    if (links -> animation_head != NULL) {
+        links -> animation_head -> widget_prev = animation;
+    }
+    links -> animation_head = animation;
+    COUNT ++;
+    links -> animations ++;
+    driver_start();
+    return animation;
+}
+
+ei_animation_t* ei_animate_int(ei_widget_t* widget, int* property, int to, int duration,
+			       ei_easing_t easing, ei_animation_done_t done, void* user_param){
+    ei_animation_t* animation = animation_start(widget, property, EI_FALSE, duration,
+        easing, done, user_param);
+    animation -> from[0] = *property;
+    animation -> to[0] = to;
+    return animation;
+}
+
+ei_animation_t* ei_animate_color(ei_widget_t* widget, ei_color_t* property, ei_color_t to,
+				 int duration, ei_easing_t easing, ei_animation_done_t done,
+				 void* user_param){
+    ei_animation_t* animation = animation_start(widget, property, EI_TRUE, duration,
+        easing, done, user_param);
+    animation -> from[0] = property -> red;
+    animation -> from[1] = property -> green;
+    animation -> from[2] = property -> blue;
+    animation -> from[3] = property -> alpha;
+    animation -> to[0] = to.red;
+    animation -> to[1] = to.green;
+    animation -> to[2] = to.blue;
+    animation -> to[3] = to.alpha;
+    return animation;
+}
+
+ei_animation_t* ei_animate_background(ei_widget_t* widget, ei_color_t to, int duration,
+				      ei_easing_t easing, ei_animation_done_t done,
+				      void* user_param){
+    ei_color_t* color = NULL;
+    if (ei_widget_is(widget, ei_class_frame) == EI_TRUE) {
+        color = &(((ei_frame_t*) widget) -> color);
+    } else if (ei_widget_is(widget, ei_class_button) == EI_TRUE) {
+        color = &(((ei_button_t*) widget) -> color);
+    } else if (ei_widget_is(widget, ei_class_toplevel) == EI_TRUE) {
+        color = &(((ei_toplevel_t*) widget) -> color);
+    }
+    if (color == NULL) {
+        return NULL;
+    }
+    return ei_animate_color(widget, color, to, duration, easing, done, user_param);
+}
+
+ei_animation_t* ei_animate_border_width(ei_widget_t* widget, int to, int duration,
+					ei_easing_t easing, ei_animation_done_t done,
+					void* user_param){
+    int* border_width = NULL;
+    if (ei_widget_is(widget, ei_class_frame) == EI_TRUE) {
+        border_width = &(((ei_frame_t*) widget) -> border_width);
+    } else if (ei_widget_is(widget, ei_class_button) == EI_TRUE) {
+        border_width = &(((ei_button_t*) widget) -> border_width);
+    } else if (ei_widget_is(widget, ei_class_toplevel) == EI_TRUE) {
+        border_width = &(((ei_toplevel_t*) widget) -> border_width);
+    }
+    if (border_width == NULL) {
+        return NULL;
+    }
+    return ei_animate_int(widget, border_width, to, duration, easing, done, user_param);
+}
+
+void ei_animation_cancel(ei_animation_t* animation){
+    if (animation == NULL || animation -> list == NULL) {
+        return;
+    }
+    list_remove(animation);
+    animation_forget(animation);
+    free(animation);
+    if (ANIMATIONS == NULL && DRIVER != NULL) {
+        ei_timer_cancel(DRIVER);
+        DRIVER = NULL;
+    }
+}
+
+void ei_animation_cancel_widget(ei_widget_t* widget){
+    ei_widget_links_t* links = ei_widget_links(widget);
+    while (links -> animation_head != NULL) {
+        ei_animation_cancel(links -> animation_head);
+    }
+}
+
+int ei_animation_count(){
+    return COUNT;
+}
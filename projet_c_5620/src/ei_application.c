@@ -17,6 +17,21 @@
 #include "ei_widget_frame.h"
 #include "ei_widget_button.h"
 #include "ei_widget_toplevel.h"
+#include "ei_widget_scrollframe.h"
+#include "ei_widget_listbox.h"
+#include "ei_frame_scheduler.h"
+#include "ei_timer.h"
+#include "ei_animation.h"
+#include "ei_slab.h"
+#include "ei_arena.h"
+#include "ei_text.h"
+#include "ei_glyph.h"
+#include "ei_image.h"
+#include "ei_pool.h"
+#include "ei_renderer.h"
+#include "ei_scale.h"
+#include "ei_layer.h"
+#include "ei_grid.h"
 
 #define max(a,b) ((a) > (b) ? a : b)
 #define min(a,b) ((a) < (b) ? a : b)
@@ -52,13 +67,15 @@ void ei_app_create(ei_size_t* main_window_size, ei_bool_t fullscreen){
     ei_frame_register_class();
     ei_button_register_class();
     ei_toplevel_register_class();
+    ei_scrollframe_register_class();
+    ei_listbox_register_class();
     ei_widgetclass_name_t name;
     strncpy(name, "frame", 20);
     ei_widgetclass_t *class = ei_widgetclass_from_name(name);
-    ei_widget_t *widget = (class -> allocfunc)();
-    widget -> wclass = class;
+    ei_widget_t *widget = ei_widget_alloc(class, ei_class_frame);
     widget -> screen_location = hw_surface_get_rect(main_window);
     widget -> pick_color = convert_pick_id_to_pick_color(0);
+    ei_widget_links(widget) -> class_id = ei_class_frame;
     ROOT = widget;
     SORTIE = EI_FALSE;
     (ROOT -> wclass -> setdefaultsfunc)(ROOT);
@@ -74,6 +91,8 @@ void ei_app_create(ei_size_t* main_window_size, ei_bool_t fullscreen){
     ei_event_set_active_widget(NULL);
     ei_place(ROOT, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
     DRAW_RECT = NULL;
+    PICK_RECT = NULL;
+    ei_invalidate_pick_rect(&(ROOT -> screen_location));
 }
 
 /**
@@ -82,6 +101,18 @@ void ei_app_create(ei_size_t* main_window_size, ei_bool_t fullscreen){
  */
 void ei_app_free(){
     free_widgets(ei_app_root_widget ());
+    ei_grid_free_all();
+    ei_timer_free_all();
+    ei_event_free_bindings();
+    ei_widgetclass_free_slabs();
+    ei_pool_free();
+    ei_renderer_free();
+    ei_arena_free();
+    ei_text_free_cache();
+    ei_glyph_free_atlases();
+    ei_scale_free_all();
+    ei_image_free_all();
+    ei_layer_free_all();
     free_class();
     hw_quit();
 
@@ -100,6 +131,7 @@ void free_class(){
         suiv = suiv -> next;
     }
     free(suiv);
+    ei_widgetclass_free_registry();
 }
 
 
@@ -112,12 +144,44 @@ void free_class(){
  */
 void free_widgets(ei_widget_t* widget){
     while (widget != NULL){
-        (*(widget -> wclass) ->  releasefunc)(widget);
+        // Le widget est libere : on lit son frere avant
+        ei_widget_t* next = widget -> next_sibling;
+        ei_grid_release(widget);
         free_widgets(widget -> children_head);
-        widget = widget -> next_sibling;
+        ei_animation_cancel_widget(widget);
+        ei_event_forget_widget(widget);
+        ei_widget_release(widget);
+        widget = next;
     }
 }
 
+/**
+ * \brief	Region of the screen to update at the next frame without redrawing it,
+ * see \ref ei_app_present_rect.
+ */
+static ei_linked_rect_t* PRESENT_RECT = NULL;
+
+/**
+ * \brief	Storage of the damaged regions: each one is a single rectangle, so invalidating
+ * a widget at every mouse move never allocates.
+ */
+static ei_linked_rect_t DRAW_STORAGE;
+static ei_linked_rect_t PICK_STORAGE;
+static ei_linked_rect_t PRESENT_STORAGE;
+
+/**
+ * \brief	Marker posted at the end of the event queue to find out which
+ * events were already pending: every event received before it belongs to the
+ * current batch.
+ */
+static int BATCH_END;
+
+/**
+ * \brief	Number of mouse move events that have been dropped because a more
+ * recent move for the same active widget was pending in the same batch.
+ */
+static unsigned long COALESCED_EVENTS = 0;
+
 /**
  * \brief	Runs the application: enters the main event loop. Exits when
  *		\ref ei_app_quit_request is called.
@@ -125,113 +189,262 @@ void free_widgets(ei_widget_t* widget){
 void ei_app_run(){
     hw_surface_lock(ei_app_root_surface());
     hw_surface_lock(SURFACE_PICK);
+    // La premiere frame dessine toute la fenetre, quels que soient les dommages
+    ei_placer_flush();
+    DRAW_RECT = NULL;
     draw_widgets(ei_app_root_widget());
     hw_surface_unlock(ei_app_root_surface());
     hw_surface_update_rects(ei_app_root_surface(), NULL);
     DRAW_RECT = NULL;
     ei_event_t event;
     event.type = ei_ev_none;
-    ei_point_t where;
-    ei_widget_t* widget;
-    ei_default_handle_func_t def_func = ei_event_get_default_handle_func();
+    ei_bool_t redraw;
+    ei_bool_t immediate;
     while (SORTIE == EI_FALSE){
         hw_event_wait_next(&event);
-        if(event.type == ei_ev_mouse_buttondown){
-            where = event.param.mouse.where;
-            widget = ei_widget_pick(&where);
-            if (widget != NULL) {
-                (widget -> wclass -> handlefunc)(widget, &event);
-            }
-            else{
-                if (def_func != NULL){
-                    if (def_func(&event) == EI_TRUE) {
-                        draw();
-                    }
-                }
-            }
+        // Les clics et les touches sont dessines sans attendre l'echeance
+        immediate = (event.type != ei_ev_mouse_move && event.type != ei_ev_app);
+        if (event.type == ei_ev_mouse_move && hw_event_post_app(&BATCH_END) >= 0) {
+            redraw = ei_app_pump_events(&event, &immediate);
+        } else {
+            redraw = ei_app_dispatch_event(&event);
         }
-        else if (event.type == ei_ev_mouse_buttonup ||
-            event.type == ei_ev_mouse_move) {
-            widget = ei_event_get_active_widget();
-            if (widget != NULL) {
-                (widget -> wclass -> handlefunc)(widget, &event);
-            }
-            else{
-                if (def_func != NULL){
-                    if (def_func(&event) == EI_TRUE) {
-                        draw();
-                    }       }
-            }
+        if (redraw == EI_TRUE) {
+            // Le traitant par defaut ne dit pas ce qui a change
+            ei_app_invalidate_rect(&(ei_app_root_widget() -> screen_location));
+        }
+        if (SORTIE == EI_FALSE) {
+            ei_frame_request(immediate);
         }
-        else{
-            if (def_func != NULL){
-                if (def_func(&event) == EI_TRUE) {
-                    draw();
-                }
+    }
+}
+
+/**
+ * \brief	Processes all the events that are already pending after a mouse
+ * move, in order. Consecutive mouse moves for the same active widget are
+ * collapsed into the latest one. The caller renders once for the whole batch.
+ *
+ * @param	first		The mouse move event that started the batch.
+ * @param	immediate	Set to EI_TRUE if the batch held a click or a key.
+ *
+ * @return			EI_TRUE if the default handle function asked for a redraw.
+ */
+ei_bool_t ei_app_pump_events(ei_event_t* first, ei_bool_t* immediate){
+    ei_event_t event;
+    ei_event_t pending = *first;
+    ei_bool_t has_pending = EI_TRUE;
+    ei_widget_t* pending_widget = ei_event_get_active_widget();
+    ei_bool_t redraw = EI_FALSE;
+    while (SORTIE == EI_FALSE){
+        hw_event_wait_next(&event);
+        if (event.type == ei_ev_app
+            && event.param.application.user_param == &BATCH_END) {
+            break;
+        }
+        if (event.type == ei_ev_mouse_move && has_pending == EI_TRUE
+            && pending_widget == ei_event_get_active_widget()) {
+            pending = event;
+            COALESCED_EVENTS ++;
+            continue;
+        }
+        if (has_pending == EI_TRUE) {
+            if (ei_app_dispatch_event(&pending) == EI_TRUE) {
+                redraw = EI_TRUE;
             }
+            has_pending = EI_FALSE;
         }
-        if (DRAW_RECT != NULL){
-            draw();
+        if (event.type == ei_ev_mouse_move) {
+            pending = event;
+            has_pending = EI_TRUE;
+            pending_widget = ei_event_get_active_widget();
+            continue;
+        }
+        if (event.type != ei_ev_app) {
+            *immediate = EI_TRUE;
+        }
+        if (ei_app_dispatch_event(&event) == EI_TRUE) {
+            redraw = EI_TRUE;
+        }
+    }
+    if (has_pending == EI_TRUE && SORTIE == EI_FALSE) {
+        if (ei_app_dispatch_event(&pending) == EI_TRUE) {
+            redraw = EI_TRUE;
         }
     }
+    return redraw;
+}
+
+/**
+ * \brief	Sends an event to the widget concerned, or to the default handle
+ * function if no widget is concerned.
+ *
+ * @param	event		The event to process.
+ *
+ * @return			EI_TRUE if the default handle function asked for a redraw.
+ */
+ei_bool_t ei_app_dispatch_event(ei_event_t* event){
+    ei_widget_t* widget = NULL;
+    ei_default_handle_func_t def_func = ei_event_get_default_handle_func();
+    if (ei_timer_handle_event(event) == EI_TRUE) {
+        return EI_FALSE;
+    }
+    // Les widgets qui attendaient l'image se redessinent en la recevant
+    if (ei_image_handle_event(event) == EI_TRUE) {
+        return EI_FALSE;
+    }
+    // target recoit les bindings, widget le traitant de sa classe
+    ei_widget_t* target = NULL;
+    if (event -> type == ei_ev_mouse_buttondown){
+        ei_point_t where = event -> param.mouse.where;
+        widget = ei_widget_pick(&where);
+        target = widget;
+    }
+    else if (event -> type == ei_ev_mouse_buttonup ||
+        event -> type == ei_ev_mouse_move) {
+        widget = ei_event_get_active_widget();
+        target = widget;
+        ei_point_t where = event -> param.mouse.where;
+        // Le pick ne sert qu'aux bindings : inutile s'il n'y en a pas
+        if (target == NULL && ei_event_has_bindings(event -> type) == EI_TRUE
+            && pixel_is_in_rect(where, &(ei_app_root_widget() -> screen_location))) {
+            target = ei_widget_pick(&where);
+        }
+    }
+    else if (event -> type == ei_ev_keydown || event -> type == ei_ev_keyup) {
+        // Les traitants des classes ne gerent que la souris
+        target = ei_event_get_focus_widget();
+    }
+    if (ei_event_call_bindings(target, event) == EI_TRUE) {
+        return EI_FALSE;
+    }
+    if (widget != NULL) {
+        (widget -> wclass -> handlefunc)(widget, event);
+        return EI_FALSE;
+    }
+    if (def_func != NULL && def_func(event) == EI_TRUE) {
+        return EI_TRUE;
+    }
+    return EI_FALSE;
+}
+
+/**
+ * \brief	Returns the number of mouse move events that have been collapsed
+ * into a more recent one since the application started.
+ *
+ * @return			The number of coalesced events.
+ */
+unsigned long ei_app_coalesced_events(){
+    return COALESCED_EVENTS;
 }
 
 void draw(){
-    hw_surface_lock(ei_app_root_surface());
-    draw_widgets(ei_app_root_widget());
-    hw_surface_unlock(ei_app_root_surface());
+    // Les widgets places depuis la derniere frame le sont tous en une passe
+    ei_placer_flush();
+    if (DRAW_RECT == NULL && PRESENT_RECT == NULL) {
+        return;
+    }
     if (DRAW_RECT != NULL) {
-        DRAW_RECT -> rect = *ei_intersection(&(DRAW_RECT -> rect),
+        hw_surface_lock(ei_app_root_surface());
+        draw_widgets(ei_app_root_widget());
+        hw_surface_unlock(ei_app_root_surface());
+        DRAW_RECT -> rect = ei_rect_intersection(&(DRAW_RECT -> rect),
+        &(ei_app_root_widget() -> screen_location));
+    }
+    // Les pixels deplaces sont envoyes a l'ecran avec ceux qui ont ete redessines
+    ei_linked_rect_t* update = DRAW_RECT;
+    if (PRESENT_RECT != NULL) {
+        PRESENT_RECT -> rect = ei_rect_intersection(&(PRESENT_RECT -> rect),
         &(ei_app_root_widget() -> screen_location));
+        if (DRAW_RECT != NULL) {
+            DRAW_RECT -> next = PRESENT_RECT;
+        } else {
+            update = PRESENT_RECT;
+        }
     }
-    hw_surface_update_rects(ei_app_root_surface(), DRAW_RECT);
-    free(DRAW_RECT);
+    hw_surface_update_rects(ei_app_root_surface(), update);
     DRAW_RECT = NULL;
+    PRESENT_RECT = NULL;
+    // Les temporaires du dessin ne survivent pas a la frame
+    ei_arena_reset();
 }
 
 
 void draw_widgets(ei_widget_t* widget){
-    while (widget != NULL){
-        if (widget != ei_app_root_widget()){
-            ei_placer_run(widget);
-        }
-        ei_rect_t* clipper = &(widget -> screen_location);
-        ei_widget_t* current = widget;
-        while (current != ei_app_root_widget()) {
-            clipper = ei_intersection(clipper, &(current -> screen_location));
-            current = current -> parent;
-        }
-        clipper = ei_intersection(clipper, &(current -> screen_location));
-        if (DRAW_RECT != NULL) {
-            clipper = ei_intersection(clipper, &(DRAW_RECT -> rect));
-        }
-        (widget -> wclass ->  drawfunc)(widget, ei_app_root_surface(),
-         SURFACE_PICK, clipper);
-        draw_widgets(widget -> children_head);
-        widget = widget -> next_sibling;
+    ei_render(widget, DRAW_RECT, ei_app_root_surface(), NULL);
+}
+
+/**
+ * \brief	Redraws the picking offscreen where it has been invalidated by
+ * a change of geometry or of stacking order. Called lazily by
+ * \ref ei_widget_pick so that cosmetic redraws never touch the offscreen.
+ */
+void draw_pick(){
+    if (PICK_RECT != NULL) {
+        draw_pick_widgets(ei_app_root_widget());
+        PICK_RECT = NULL;
+    }
+}
+
+void draw_pick_widgets(ei_widget_t* widget){
+    if (ei_widget_user_class_count() == 0) {
+        ei_render(widget, PICK_RECT, NULL, SURFACE_PICK);
+        return;
+    }
+    // Les classes exterieures a la bibliotheque dessinent toujours l'ecran avec le
+    // picking : toute la zone est redessinee sur les deux surfaces
+    hw_surface_lock(ei_app_root_surface());
+    ei_render(widget, PICK_RECT, ei_app_root_surface(), SURFACE_PICK);
+    hw_surface_unlock(ei_app_root_surface());
+    if (PICK_RECT != NULL) {
+        ei_app_invalidate_rect(&(PICK_RECT -> rect));
+    }
+}
+
+/**
+ * \brief	Adds a rectangle to the region of the picking offscreen that must be
+ * redrawn before the next pick.
+ *
+ * @param	rect		The rectangle to add, expressed in the root window coordinates.
+ */
+void ei_invalidate_pick_rect(ei_rect_t* rect){
+    if (rect -> size.width <= 0 || rect -> size.height <= 0) {
+        return;
+    }
+    if (PICK_RECT == NULL){
+        PICK_RECT = &PICK_STORAGE;
+        PICK_RECT -> next = NULL;
+        PICK_RECT -> rect = *rect;
+    } else {
+        PICK_RECT -> rect = ei_rect_union(&(PICK_RECT -> rect), rect);
     }
 }
 
 void ei_intersection_linked_rect(ei_rect_t* rect1, ei_linked_rect_t* rect2) {
     ei_linked_rect_t* current = rect2;
     while (current != rect2) {
-        current -> rect = *(ei_intersection(&(current -> rect), rect1));
+        current -> rect = ei_rect_intersection(&(current -> rect), rect1);
         current = current -> next;
     }
 }
 
-ei_rect_t* ei_intersection(ei_rect_t* rect1, ei_rect_t* rect2) {
+ei_rect_t ei_rect_intersection(const ei_rect_t* rect1, const ei_rect_t* rect2) {
     ei_point_t point1 = rect1 -> top_left;
     ei_point_t point2 = rect2 -> top_left;
     ei_size_t size1 = rect1 -> size;
     ei_size_t size2 = rect2 -> size;
-    ei_rect_t* intersection = malloc(sizeof(ei_rect_t));
-    intersection -> top_left.x = max(point1.x, point2.x);
-    intersection -> top_left.y = max(point1.y, point2.y);
-    intersection -> size.width = max(min(size1.width - intersection ->top_left.x
-        + point1.x, size2.width - intersection ->top_left.x + point2.x),0);
-    intersection -> size.height = max(min(size1.height - intersection ->top_left.y
-         + point1.y, size2.height - intersection ->top_left.y + point2.y),0);
+    ei_rect_t intersection;
+    intersection.top_left.x = max(point1.x, point2.x);
+    intersection.top_left.y = max(point1.y, point2.y);
+    intersection.size.width = max(min(size1.width - intersection.top_left.x
+        + point1.x, size2.width - intersection.top_left.x + point2.x),0);
+    intersection.size.height = max(min(size1.height - intersection.top_left.y
+         + point1.y, size2.height - intersection.top_left.y + point2.y),0);
+    return intersection;
+}
+
+ei_rect_t* ei_intersection(ei_rect_t* rect1, ei_rect_t* rect2) {
+    ei_rect_t* intersection = ei_arena_alloc(sizeof(ei_rect_t));
+    *intersection = ei_rect_intersection(rect1, rect2);
     return intersection;
 }
 
@@ -243,7 +456,29 @@ ei_rect_t* ei_intersection(ei_rect_t* rect1, ei_rect_t* rect2) {
  *				A copy is made, so it is safe to release the rectangle on return.
  */
 void ei_app_invalidate_rect(ei_rect_t* rect){
+    if (rect -> size.width <= 0 || rect -> size.height <= 0) {
+        return;
+    }
+    if (DRAW_RECT == NULL){
+        DRAW_RECT = &DRAW_STORAGE;
+        DRAW_RECT -> next = NULL;
+        DRAW_RECT -> rect = *rect;
+    } else {
+        DRAW_RECT -> rect = ei_rect_union(&(DRAW_RECT -> rect), rect);
+    }
+}
 
+void ei_app_present_rect(ei_rect_t* rect){
+    if (rect -> size.width <= 0 || rect -> size.height <= 0) {
+        return;
+    }
+    if (PRESENT_RECT == NULL){
+        PRESENT_RECT = &PRESENT_STORAGE;
+        PRESENT_RECT -> next = NULL;
+        PRESENT_RECT -> rect = *rect;
+    } else {
+        PRESENT_RECT -> rect = ei_rect_union(&(PRESENT_RECT -> rect), rect);
+    }
 }
 
 /**
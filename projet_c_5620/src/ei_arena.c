@@ -0,0 +1,128 @@
+/**
+ *  @file	ei_arena.c
+ *  @brief	Per-frame arena for the temporary values of the drawing code (points of the
+ *		polygons, sides of the scanline fill, ...). Allocating is a pointer bump, and
+ *		everything is released at once at the end of each frame. Each thread has its
+ *		own arena.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "ei_arena.h"
+
+#define max(a,b) ((a) > (b) ? a : b)
+
+/* Taille minimale d'un bloc de l'arene */
+#define CHUNK_BYTES	65536
+#define ALIGNMENT	16
+
+/**
+ * \brief	A chunk of the arena. The blocks are allocated in data, one after the other.
+ */
+typedef struct ei_chunk_t {
+    struct ei_chunk_t*	next;
+    size_t		size;
+    size_t		used;
+    /* Octets utilises dans les blocs precedents */
+    size_t		base;
+    char*		data;
+} ei_chunk_t;
+
+/* Chaque thread a sa propre arene : les workers du rendu dessinent en parallele */
+static __thread ei_chunk_t* CHUNKS = NULL;
+static __thread ei_chunk_t* CURRENT = NULL;
+static __thread size_t CAPACITY = 0;
+static __thread size_t PEAK = 0;
+static __thread size_t FRAME_PEAK = 0;
+static __thread unsigned long CHUNK_COUNT = 0;
+
+static ei_chunk_t* chunk_create(size_t size){
+    ei_chunk_t* chunk = calloc(1, sizeof(ei_chunk_t));
+    chunk -> size = size;
+    chunk -> data = malloc(size);
+    CAPACITY += size;
+    CHUNK_COUNT ++;
+    return chunk;
+}
+
+static void chunks_free(){
+    while (CHUNKS != NULL) {
+        ei_chunk_t* next = CHUNKS -> next;
+        free(CHUNKS -> data);
+        free(CHUNKS);
+        CHUNKS = next;
+    }
+    CURRENT = NULL;
+    CAPACITY = 0;
+}
+
+void* ei_arena_alloc(size_t size){
+    size = (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    if (CURRENT == NULL) {
+        if (CHUNKS == NULL) {
+            CHUNKS = chunk_create(max(size, CHUNK_BYTES));
+        }
+        CURRENT = CHUNKS;
+        CURRENT -> used = 0;
+        CURRENT -> base = 0;
+    }
+    if (CURRENT -> used + size > CURRENT -> size) {
+        // Les blocs suivants trop petits sont remplaces par un nouveau bloc
+        ei_chunk_t* next = CURRENT -> next;
+        if (next == NULL || next -> size < size) {
+            next = chunk_create(max(size, CHUNK_BYTES));
+            next -> next = CURRENT -> next;
+            CURRENT -> next = next;
+        }
+        next -> used = 0;
+        next -> base = CURRENT -> base + CURRENT -> used;
+        CURRENT = next;
+    }
+    void* block = CURRENT -> data + CURRENT -> used;
+    CURRENT -> used += size;
+    FRAME_PEAK = max(FRAME_PEAK, CURRENT -> base + CURRENT -> used);
+    memset(block, 0, size);
+    return block;
+}
+
+ei_arena_mark_t ei_arena_mark(){
+    ei_arena_mark_t mark = {CURRENT, 0};
+    if (CURRENT != NULL) {
+        mark.used = CURRENT -> used;
+    }
+    return mark;
+}
+
+void ei_arena_rewind(ei_arena_mark_t mark){
+    CURRENT = (ei_chunk_t*) mark.chunk;
+    if (CURRENT != NULL) {
+        CURRENT -> used = mark.used;
+    }
+}
+
+void ei_arena_reset(){
+    PEAK = max(PEAK, FRAME_PEAK);
+    if (CHUNKS != NULL && CHUNKS -> next != NULL && FRAME_PEAK > CHUNKS -> size) {
+        // La frame a deborde du premier bloc : un seul bloc assez grand pour la suite
+        chunks_free();
+        CHUNKS = chunk_create(FRAME_PEAK);
+    }
+    CURRENT = NULL;
+    FRAME_PEAK = 0;
+}
+
+void ei_arena_get_stats(ei_arena_stats_t* stats){
+    stats -> capacity = CAPACITY;
+    stats -> used = 0;
+    if (CURRENT != NULL) {
+        stats -> used = CURRENT -> base + CURRENT -> used;
+    }
+    stats -> peak = max(PEAK, FRAME_PEAK);
+    stats -> chunks = CHUNK_COUNT;
+}
+
+void ei_arena_free(){
+    chunks_free();
+    FRAME_PEAK = 0;
+}
@@ -12,10 +12,54 @@
 #include "ei_draw_widgets.h"
 #include "ei_draw_poly.h"
 #include "ei_all_widgets.h"
+#include "ei_glyph.h"
+#include "ei_pool.h"
+#include "ei_layer.h"
 
 #define max(a,b) ((a) > (b) ? a : b)
 #define min(a,b) ((a) < (b) ? a : b)
 
+/**
+ * \brief	The layout of the pixels of a surface, resolved once for a whole copy.
+ */
+typedef struct {
+    int		ir;
+    int		ig;
+    int		ib;
+    /* -1 si la surface n'a pas de canal alpha */
+    int		ia;
+    ei_bool_t	premultiplied;
+} ei_pixel_format_t;
+
+static void pixel_format_get(ei_surface_t surface, ei_pixel_format_t* format){
+    hw_surface_get_channel_indices(surface, &(format -> ir), &(format -> ig), &(format -> ib),
+        &(format -> ia));
+    format -> premultiplied = ei_layer_is_premultiplied(surface);
+}
+
+/**
+ * \brief	Same as \ref ei_map_rgba, for a surface whose layout is known.
+ */
+static inline uint32_t map_rgba(const ei_pixel_format_t* format, const ei_color_t* color){
+    uint32_t couleur = 0;
+    uint32_t red = color -> red;
+    uint32_t green = color -> green;
+    uint32_t blue = color -> blue;
+    // Dans une surface premultipliee, les couleurs sont ponderees par l'alpha
+    if (format -> ia >= 0 && color -> alpha != 255 && format -> premultiplied == EI_TRUE) {
+        red = (red * color -> alpha + 127) / 255;
+        green = (green * color -> alpha + 127) / 255;
+        blue = (blue * color -> alpha + 127) / 255;
+    }
+    couleur = couleur | (blue << format -> ib*8);
+    couleur = couleur | (red << format -> ir*8);
+    couleur = couleur | (green << format -> ig*8);
+    if (format -> ia >= 0){
+        couleur = couleur | ((color -> alpha) << format -> ia*8);
+    }
+    return couleur;
+}
+
 /**
  * \brief	Converts the three red, green and blue component of a color in a 32 bits integer
  *		using the order of the channels of the surface. This integer can be stored directly
@@ -35,20 +79,15 @@ uint32_t		ei_map_rgba		(ei_surface_t surface, const ei_color_t* color){
      * ia -> Position of the aplha value in the 32 bit integer
      * *ia may be -1, this means that the surface does not handle alpha.
      */
-    int ir;
-    int ig;
-    int ib;
-    int ia;
-    uint32_t couleur = 0;
-    hw_surface_get_channel_indices(surface, &ir, &ig, &ib, &ia);
-    // We must recalculate ir, ig, ib, ia
-    couleur = couleur | ((color -> blue) << ib*8);
-    couleur = couleur | ((color -> red) << ir*8);
-    couleur = couleur | ((color -> green) << ig*8);
-    if (ia >= 0){
-        couleur = couleur | ((color -> alpha) << ia*8);
+    ei_pixel_format_t format;
+    hw_surface_get_channel_indices(surface, &(format.ir), &(format.ig), &(format.ib),
+        &(format.ia));
+    // La table des calques n'est consultee que pour une couleur transparente
+    format.premultiplied = EI_FALSE;
+    if (format.ia >= 0 && color -> alpha != 255) {
+        format.premultiplied = ei_layer_is_premultiplied(surface);
     }
-    return couleur;
+    return map_rgba(&format, color);
 }
 
 
@@ -61,13 +100,15 @@ uint32_t		ei_map_rgba		(ei_surface_t surface, const ei_color_t* color){
  * @return  true or false
  */
 ei_bool_t pixel_is_in_rect(ei_point_t pixel, const ei_rect_t* rect){
-    uint32_t y_px = pixel.y;
-    uint32_t x_px = pixel.x;
-    uint32_t x_min_rect = rect -> top_left.x;
-    uint32_t x_max_rect = x_min_rect + rect -> size.width;
-    uint32_t y_min_rect = rect -> top_left.y;
-    uint32_t y_max_rect = y_min_rect + rect -> size.height;
-    if ((x_px > x_min_rect)&&(x_px < x_max_rect)&&(y_px > y_min_rect)
+    int y_px = pixel.y;
+    int x_px = pixel.x;
+    int x_min_rect = rect -> top_left.x;
+    int x_max_rect = x_min_rect + rect -> size.width;
+    int y_min_rect = rect -> top_left.y;
+    int y_max_rect = y_min_rect + rect -> size.height;
+    // Le bord haut et le bord gauche font partie du rectangle : des clippers
+    // voisins (les tuiles du rendu) ne laissent pas de trou entre eux
+    if ((x_px >= x_min_rect)&&(x_px < x_max_rect)&&(y_px >= y_min_rect)
     &&(y_px < y_max_rect)) {
         return EI_TRUE;
     }
@@ -83,141 +124,350 @@ void			ei_draw_text		(ei_surface_t		surface,
         const ei_color_t*	color,
         const ei_rect_t*	clipper)
 {
-    ei_size_t surface_size = hw_surface_get_size(surface);
-    ei_surface_t text_surface = hw_text_create_surface(text, font, color);
-    ei_size_t text_surface_size = hw_surface_get_size(text_surface);
-    ei_rect_t* rect_source;
-    rect_source = calloc(1, sizeof(ei_rect_t));
-    *rect_source = hw_surface_get_rect(text_surface);
-    ei_rect_t* rect_dest;
-    rect_dest = calloc(1, sizeof(ei_rect_t));
-    rect_dest -> size = (text_surface_size);
-    rect_dest -> top_left =  *where;
-    ei_point_t current_pixel;
-    current_pixel = *where;
-    if (clipper == NULL) {
-        ei_copy_surface(surface, rect_dest ,text_surface,rect_source ,EI_TRUE);
+    ei_glyph_draw_text(surface, where, text, font, color, clipper);
+}
+
+
+/**
+ * \brief	What the bands of a primitive need, see \ref ei_draw_bands.
+ */
+typedef struct {
+    ei_rect_t		area;
+    int			bands;
+    ei_band_func_t	func;
+    void*		user_param;
+} ei_bands_t;
+
+static void draw_band(int index, void* user_param){
+    ei_bands_t* bands = (ei_bands_t*) user_param;
+    int y_begin = (int) ((long) bands -> area.size.height * index / bands -> bands);
+    int y_end = (int) ((long) bands -> area.size.height * (index + 1) / bands -> bands);
+    ei_rect_t band = bands -> area;
+    band.top_left.y += y_begin;
+    band.size.height = y_end - y_begin;
+    (bands -> func)(&band, bands -> user_param);
+}
+
+void ei_draw_bands(const ei_rect_t* area, ei_band_func_t func, void* user_param){
+    if (area -> size.width <= 0 || area -> size.height <= 0) {
+        return;
     }
-    else{
-        uint32_t* text_ptr = (uint32_t*)hw_surface_get_buffer(text_surface);
-        uint32_t* dest_ptr = (uint32_t*)hw_surface_get_buffer(surface);
-        dest_ptr += (rect_dest -> top_left.x)
-        + surface_size.width * (rect_dest -> top_left.y);
-        for (uint32_t j = 0; j < rect_source -> size.height; j++) {
-            for (uint32_t i = 0; i < rect_source -> size.width; i++) {
-                if (pixel_is_in_rect(current_pixel, clipper) == EI_TRUE) {
-                    copy_pixel(dest_ptr, text_ptr, text_surface, surface);
-                }
-                text_ptr ++;
-                dest_ptr ++;
-                current_pixel.x += 1;
-            }
-            dest_ptr += surface_size.width - rect_source -> size.width;
-            current_pixel.x = where -> x;
-            current_pixel.y += 1;
-        }
+    int count = 1;
+    if ((long) area -> size.width * area -> size.height >= EI_BAND_MIN_PIXELS
+        && ei_pool_in_task() == EI_FALSE) {
+        // Plus de bandes que de threads, pour que le vol de taches equilibre la charge
+        count = min(4 * ei_pool_get_threads(), area -> size.height / EI_BAND_MIN_ROWS);
     }
-    free(rect_source);
-    free(rect_dest);
+    if (count <= 1) {
+        func(area, user_param);
+        return;
+    }
+    ei_bands_t bands = {*area, count, func, user_param};
+    ei_pool_run(count, draw_band, &bands);
 }
 
+/**
+ * \brief	A color to write in a surface, see \ref fill_band.
+ */
+typedef struct {
+    uint32_t*	pixels;
+    int		width;
+    uint32_t	color;
+} ei_fill_param_t;
+
+static void fill_band(const ei_rect_t* band, void* user_param){
+    ei_fill_param_t* fill = (ei_fill_param_t*) user_param;
+    uint32_t* pixel_ptr = fill -> pixels + band -> top_left.x
+        + fill -> width * band -> top_left.y;
+    for (int j = 0; j < band -> size.height; j++) {
+        for (int i = 0; i < band -> size.width; i++) {
+            pixel_ptr[i] = fill -> color;
+        }
+        pixel_ptr += fill -> width;
+    }
+}
 
 void			ei_fill			(ei_surface_t		surface,
         const ei_color_t*	color,
         const ei_rect_t*	clipper)
 {
-    uint32_t converted_color;
+    ei_fill_param_t fill;
     if(color == NULL){
-        converted_color = 0;
+        fill.color = 0;
     }
     else{
-        converted_color = ei_map_rgba(surface, color);
+        fill.color = ei_map_rgba(surface, color);
     }
     ei_size_t surface_size = hw_surface_get_size(surface);
-    uint32_t* pixel_ptr = (uint32_t*)hw_surface_get_buffer(surface);
-    if (clipper == NULL) {
-        for (uint32_t i = 0; i < (surface_size.width * surface_size.height); i++){
-            *pixel_ptr =  converted_color;
-            pixel_ptr ++;
-        }
-    }
-    else {
-        pixel_ptr += (clipper -> top_left.x)
-        + surface_size.width * (clipper -> top_left.y);
-        for (uint32_t j = 0; j < clipper -> size.height; j++) {
-            for (uint32_t i = 0; i < clipper -> size.width; i++) {
-                *pixel_ptr =  converted_color;
-                pixel_ptr ++;
-            }
-            pixel_ptr += surface_size.width - clipper-> size.width;
-
-        }
+    fill.pixels = (uint32_t*)hw_surface_get_buffer(surface);
+    fill.width = surface_size.width;
+    ei_rect_t area = {{0, 0}, surface_size};
+    if (clipper != NULL) {
+        area = *clipper;
     }
+    ei_draw_bands(&area, fill_band, &fill);
 }
 
-void copy_pixel(uint32_t* dest_pixel, uint32_t* src_pixel, ei_surface_t src_surf,
-        ei_surface_t dest_surf){
-    int d_ir;
-    int d_ig;
-    int d_ib;
-    int d_ia;
-    int s_ir;
-    int s_ig;
-    int s_ib;
-    int s_ia;
-    hw_surface_get_channel_indices(dest_surf, &d_ir, &d_ig, &d_ib, &d_ia);
-    hw_surface_get_channel_indices(src_surf, &s_ir, &s_ig, &s_ib, &s_ia);
+/**
+ * \brief	Same as \ref copy_pixel, for surfaces whose layouts are known.
+ */
+static inline void pixel_copy(uint32_t* dest_pixel, const uint32_t* src_pixel,
+        const ei_pixel_format_t* src, const ei_pixel_format_t* dest){
     unsigned char pa;
-    if (s_ia == -1){
+    if (src -> ia == -1){
         pa = 255;
     }
     else{
-        pa = (*src_pixel <<((3-s_ia)*8)) >> (24);
+        pa = (*src_pixel <<((3-src -> ia)*8)) >> (24);
+    }
+    unsigned char pr = (unsigned char)((*src_pixel <<((3-src -> ir)*8)) >> 24);
+    unsigned char pg = (unsigned char)((*src_pixel <<((3-src -> ig)*8)) >> 24);
+    unsigned char pb = (unsigned char)((*src_pixel <<((3-src -> ib)*8)) >> 24);
+    unsigned char sr = (unsigned char)((*dest_pixel <<((3-dest -> ir)*8)) >> 24);
+    unsigned char sg = (unsigned char)((*dest_pixel <<((3-dest -> ig)*8)) >> 24);
+    unsigned char sb = (unsigned char)((*dest_pixel <<((3-dest -> ib)*8)) >> 24);
+    if (src -> premultiplied == EI_TRUE) {
+        // Comme copy_over : dst = src + dst * (1 - a), les canaux sont deja ponderes
+        unsigned char sa = 255;
+        if (dest -> ia >= 0) {
+            sa = (unsigned char)((*dest_pixel <<((3-dest -> ia)*8)) >> 24);
+        }
+        ei_color_t color = {min(255, pr + ((255 - pa) * sr + 127) / 255),
+            min(255, pg + ((255 - pa) * sg + 127) / 255),
+            min(255, pb + ((255 - pa) * sb + 127) / 255),
+            min(255, pa + ((255 - pa) * sa + 127) / 255)};
+        ei_pixel_format_t weighted = *dest;
+        weighted.premultiplied = EI_FALSE;
+        *dest_pixel = map_rgba(&weighted, &color);
+        return;
     }
-    unsigned char pr = (unsigned char)((*src_pixel <<((3-s_ir)*8)) >> 24);
-    unsigned char pg = (unsigned char)((*src_pixel <<((3-s_ig)*8)) >> 24);
-    unsigned char pb = (unsigned char)((*src_pixel <<((3-s_ib)*8)) >> 24);
-    unsigned char sr = (unsigned char)((*dest_pixel <<((3-d_ir)*8)) >> 24);
-    unsigned char sg = (unsigned char)((*dest_pixel <<((3-d_ig)*8)) >> 24);
-    unsigned char sb = (unsigned char)((*dest_pixel <<((3-d_ib)*8)) >> 24);
     sr = (pa * pr + (255 - pa) * sr) / 255;
     sg = (pa * pg + (255 - pa) * sg) / 255;
     sb = (pa * pb + (255 - pa) * sb) / 255;
-    ei_color_t* color = NULL;
-    color = calloc(1, sizeof(ei_color_t));
-    color -> red = sr;
-    color -> green = sg;
-    color -> blue = sb;
-    color -> alpha = pa;
-    uint32_t converted_color = ei_map_rgba(dest_surf, color);
-    *dest_pixel = converted_color;
-    free(color);
+    ei_color_t color = {sr, sg, sb, pa};
+    *dest_pixel = map_rgba(dest, &color);
+}
+
+void copy_pixel(uint32_t* dest_pixel, uint32_t* src_pixel, ei_surface_t src_surf,
+        ei_surface_t dest_surf){
+    ei_pixel_format_t src;
+    ei_pixel_format_t dest;
+    pixel_format_get(src_surf, &src);
+    pixel_format_get(dest_surf, &dest);
+    pixel_copy(dest_pixel, src_pixel, &src, &dest);
+}
+
+/**
+ * \brief	Multiplies the four channels of a pixel by a/255, two channels at a time.
+ */
+static inline uint32_t pixel_scale(uint32_t pixel, uint32_t a){
+    uint32_t rb = (pixel & 0x00ff00ff) * a + 0x00800080;
+    rb = ((rb + ((rb >> 8) & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+    uint32_t ag = ((pixel >> 8) & 0x00ff00ff) * a + 0x00800080;
+    ag = (ag + ((ag >> 8) & 0x00ff00ff)) & 0xff00ff00;
+    return rb | ag;
+}
+
+void ei_premultiply_pixels(uint32_t* pixels, size_t count, int ia){
+    uint32_t alpha_mask = (uint32_t) 0xff << (8 * ia);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t a = (pixels[i] >> (8 * ia)) & 0xff;
+        if (a != 255) {
+            pixels[i] = (pixel_scale(pixels[i], a) & ~alpha_mask) | (pixels[i] & alpha_mask);
+        }
+    }
+}
+
+/**
+ * \brief	How the pixels of a copy are combined, see \ref copy_band.
+ */
+typedef enum {
+    copy_raw,		///< Exact copy.
+    copy_over,		///< Premultiplied source: dst = src + dst * (1 - a).
+    copy_straight,	///< Source not premultiplied: dst = (src * a + dst * (1 - a)).
+    copy_unpremultiply,	///< Exact copy of a premultiplied source in a surface that is not.
+    copy_premultiply,	///< Exact copy of a source that is not premultiplied in a surface that is.
+    copy_opaque,	///< Source without alpha, channels in the same order: opaque pixels.
+    copy_generic	///< Channels in different orders: \ref copy_pixel.
+} ei_copy_mode_t;
+
+/**
+ * \brief	A copy between two surfaces, see \ref copy_band.
+ */
+typedef struct {
+    const ei_rect_t*	dst_rect;
+    const ei_rect_t*	src_rect;
+    ei_surface_t	destination;
+    ei_surface_t	source;
+    ei_copy_mode_t	mode;
+    /* Calques et ordre des canaux, lus une fois pour toute la copie */
+    ei_pixel_format_t	src_format;
+    ei_pixel_format_t	dst_format;
+    /* Position de l'alpha de la source, en bits */
+    int			alpha_shift;
+    /* Canaux gardes dans la destination (pas d'alpha si elle n'en a pas) */
+    uint32_t		keep;
+    /* Alpha opaque de la destination, 0 si elle n'en a pas */
+    uint32_t		opaque;
+} ei_copy_param_t;
+
+/**
+ * \brief	Combines a pixel of the source with a pixel of the destination.
+ */
+static inline uint32_t copy_combine(const ei_copy_param_t* copy, uint32_t dst, uint32_t src){
+    uint32_t a = (src >> copy -> alpha_shift) & 0xff;
+    switch (copy -> mode) {
+        case copy_over:
+            if (a == 0) {
+                return dst & copy -> keep;
+            }
+            if (a == 255) {
+                return src & copy -> keep;
+            }
+            return (src + pixel_scale(dst, 255 - a)) & copy -> keep;
+        case copy_straight: {
+            if (a == 255) {
+                return src & copy -> keep;
+            }
+            // Les deux canaux d'un mot de 16 bits : (x + 1 + (x >> 8)) >> 8 vaut x / 255
+            uint32_t rb = (src & 0x00ff00ff) * a + (dst & 0x00ff00ff) * (255 - a);
+            rb = ((rb + 0x00010001 + ((rb >> 8) & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+            uint32_t ag = ((src >> 8) & 0x00ff00ff) * a + ((dst >> 8) & 0x00ff00ff) * (255 - a);
+            ag = (ag + 0x00010001 + ((ag >> 8) & 0x00ff00ff)) & 0xff00ff00;
+            uint32_t alpha_mask = (uint32_t) 0xff << copy -> alpha_shift;
+            // Comme copy_pixel : l'alpha du resultat est celui de la source
+            return (((rb | ag) & ~alpha_mask) | (src & alpha_mask)) & copy -> keep;
+        }
+        case copy_unpremultiply: {
+            if (a == 255 || a == 0) {
+                return src;
+            }
+            uint32_t pixel = src & ((uint32_t) 0xff << copy -> alpha_shift);
+            for (int shift = 0; shift < 32; shift += 8) {
+                if (shift != copy -> alpha_shift) {
+                    uint32_t c = (((src >> shift) & 0xff) * 255 + a / 2) / a;
+                    pixel |= min(c, 255) << shift;
+                }
+            }
+            return pixel;
+        }
+        case copy_premultiply: {
+            uint32_t alpha_mask = (uint32_t) 0xff << copy -> alpha_shift;
+            if (a == 255) {
+                return src;
+            }
+            return (pixel_scale(src, a) & ~alpha_mask) | (src & alpha_mask);
+        }
+        default:
+            return src;
+    }
+}
+
+/**
+ * \brief	Copies the rows of a band of the destination rectangle.
+ */
+static void copy_band(const ei_rect_t* band, void* user_param){
+    ei_copy_param_t* copy = (ei_copy_param_t*) user_param;
+    int rows = band -> top_left.y - copy -> dst_rect -> top_left.y;
+    ei_size_t dest_surf_size = hw_surface_get_size(copy -> destination);
+    ei_size_t src_surf_size = hw_surface_get_size(copy -> source);
+    uint32_t* dest_ptr = (uint32_t*)hw_surface_get_buffer(copy -> destination);
+    uint32_t* src_ptr = (uint32_t*)hw_surface_get_buffer(copy -> source);
+    dest_ptr += (copy -> dst_rect -> top_left.x)
+    + dest_surf_size.width * (band -> top_left.y);
+    src_ptr += (copy -> src_rect -> top_left.x)
+     + src_surf_size.width * (copy -> src_rect -> top_left.y + rows);
+    for (int j = 0; j < band -> size.height; j++) {
+        if (copy -> mode == copy_raw) {
+            memcpy(dest_ptr, src_ptr, band -> size.width * sizeof(uint32_t));
+        } else if (copy -> mode == copy_opaque) {
+            for (int i = 0; i < band -> size.width; i++) {
+                dest_ptr[i] = (src_ptr[i] & copy -> keep) | copy -> opaque;
+            }
+        } else if (copy -> mode == copy_generic) {
+            for (int i = 0; i < band -> size.width; i++) {
+                pixel_copy(dest_ptr + i, src_ptr + i, &(copy -> src_format),
+                    &(copy -> dst_format));
+            }
+        } else {
+            for (int i = 0; i < band -> size.width; i++) {
+                dest_ptr[i] = copy_combine(copy, dest_ptr[i], src_ptr[i]);
+            }
+        }
+        dest_ptr += dest_surf_size.width;
+        src_ptr += src_surf_size.width;
+    }
 }
 
 void ei_copy2(const ei_rect_t* dst_rect, const ei_rect_t* src_rect,
     const ei_surface_t destination,
         const ei_surface_t source, const ei_bool_t alpha){
-    ei_size_t dest_surf_size = hw_surface_get_size(destination);
-    ei_size_t src_surf_size = hw_surface_get_size(source);
-    uint32_t* dest_ptr = (uint32_t*)hw_surface_get_buffer(destination);
-    uint32_t* src_ptr = (uint32_t*)hw_surface_get_buffer(source);
-    dest_ptr += (dst_rect -> top_left.x)
-    + dest_surf_size.width * (dst_rect -> top_left.y);
-    src_ptr += (src_rect -> top_left.x)
-     + src_surf_size.width * (src_rect -> top_left.y);
-    for (uint32_t j = 0; j < src_rect -> size.height; j++) {
-        for (uint32_t i = 0; i < src_rect -> size.width; i++) {
-            if (alpha == EI_TRUE) {
-                copy_pixel(dest_ptr, src_ptr, source, destination);
-            }
-            else{
-                *dest_ptr = *src_ptr;
-            }
-            src_ptr ++;
-            dest_ptr ++;
+    ei_copy_param_t copy = {dst_rect, src_rect, destination, source, copy_raw};
+    pixel_format_get(source, &(copy.src_format));
+    pixel_format_get(destination, &(copy.dst_format));
+    int d_ir = copy.dst_format.ir, d_ig = copy.dst_format.ig, d_ib = copy.dst_format.ib;
+    int d_ia = copy.dst_format.ia;
+    int s_ir = copy.src_format.ir, s_ig = copy.src_format.ig, s_ib = copy.src_format.ib;
+    int s_ia = copy.src_format.ia;
+    ei_bool_t src_premultiplied = copy.src_format.premultiplied;
+    ei_bool_t dst_premultiplied = copy.dst_format.premultiplied;
+    copy.alpha_shift = 8 * s_ia;
+    copy.keep = ((uint32_t) 0xff << (8 * d_ir)) | ((uint32_t) 0xff << (8 * d_ig))
+        | ((uint32_t) 0xff << (8 * d_ib));
+    if (d_ia >= 0) {
+        copy.keep |= (uint32_t) 0xff << (8 * d_ia);
+    }
+    ei_bool_t same_colors = (s_ir == d_ir && s_ig == d_ig && s_ib == d_ib) ? EI_TRUE : EI_FALSE;
+    ei_bool_t same_layout = (same_colors == EI_TRUE
+        && s_ia >= 0 && (d_ia < 0 || d_ia == s_ia)) ? EI_TRUE : EI_FALSE;
+    if (s_ia < 0 && same_colors == EI_TRUE) {
+        // Source opaque : copie exacte, l'alpha de la destination est mis a 255
+        if (d_ia >= 0) {
+            copy.mode = copy_opaque;
+            copy.opaque = (uint32_t) 0xff << (8 * d_ia);
+            copy.keep &= ~copy.opaque;
         }
-        dest_ptr += dest_surf_size.width - src_rect -> size.width;
-        src_ptr += src_surf_size.width - src_rect -> size.width;
+    } else if (alpha == EI_TRUE) {
+        if (same_layout == EI_FALSE) {
+            copy.mode = copy_generic;
+        } else if (src_premultiplied == EI_TRUE) {
+            copy.mode = copy_over;
+        } else {
+            copy.mode = copy_straight;
+        }
+    } else if (same_layout == EI_TRUE && src_premultiplied != dst_premultiplied) {
+        // Conversion a la frontiere entre les surfaces de l'application et les notres
+        copy.mode = (src_premultiplied == EI_TRUE) ? copy_unpremultiply : copy_premultiply;
+    }
+    ei_rect_t area = *dst_rect;
+    area.size = src_rect -> size;
+    ei_draw_bands(&area, copy_band, &copy);
+}
+
+void ei_scroll_pixels(ei_surface_t surface, const ei_rect_t* rect, int dx, int dy){
+    ei_rect_t surface_rect = hw_surface_get_rect(surface);
+    ei_rect_t area = ei_rect_intersection(rect, &surface_rect);
+    int width = area.size.width - abs(dx);
+    int height = area.size.height - abs(dy);
+    if (width <= 0 || height <= 0 || (dx == 0 && dy == 0)) {
+        return;
+    }
+    int stride = hw_surface_get_size(surface).width;
+    uint32_t* buffer = (uint32_t*) hw_surface_get_buffer(surface);
+    int src_x = area.top_left.x + max(0, -dx);
+    int dst_x = area.top_left.x + max(0, dx);
+    int src_y = area.top_left.y + max(0, -dy);
+    int dst_y = area.top_left.y + max(0, dy);
+    // Vers le bas, les lignes sont deplacees de la derniere a la premiere
+    int first = 0;
+    int step = 1;
+    if (dy > 0) {
+        first = height - 1;
+        step = -1;
+    }
+    for (int j = first; j >= 0 && j < height; j += step) {
+        memmove(buffer + (size_t) (dst_y + j) * stride + dst_x,
+            buffer + (size_t) (src_y + j) * stride + src_x, width * sizeof(uint32_t));
     }
 }
 
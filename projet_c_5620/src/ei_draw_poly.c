@@ -12,6 +12,7 @@
 #include "ei_draw_widgets.h"
 #include "ei_all_widgets.h"
 #include "ei_draw_poly.h"
+#include "ei_arena.h"
 
 #define max(a,b) ((a) > (b) ? a : b)
 #define min(a,b) ((a) < (b) ? a : b)
@@ -121,7 +122,7 @@ void			ei_draw_polyline	(ei_surface_t			surface,
 int* init_scanline(ei_linked_point_t* first_point){
     ei_linked_point_t* current;
     current = first_point;
-    int* tab = calloc(1, sizeof(int)*2);
+    int* tab = ei_arena_alloc(sizeof(int)*2);
     ei_point_t point = current -> point;
     int min = point.y;
     int max = point.y;
@@ -157,9 +158,9 @@ int* init_scanline(ei_linked_point_t* first_point){
  */
 
 ei_TC_t* init_TC(const ei_linked_point_t* first_point, int y_min, int y_max) {
-    ei_TC_t *TC = calloc(1, sizeof(ei_TC_t));
+    ei_TC_t *TC = ei_arena_alloc(sizeof(ei_TC_t));
     if (first_point != NULL) {
-        TC->tab = calloc(1, sizeof(ei_side_t *) * (y_max-y_min));
+        TC->tab = ei_arena_alloc(sizeof(ei_side_t *) * (y_max-y_min));
         ei_linked_point_t* current_point = (ei_linked_point_t *) first_point;
         while (current_point -> next != NULL) {
             ei_linked_point_t* next_point = current_point -> next;
@@ -170,7 +171,7 @@ ei_TC_t* init_TC(const ei_linked_point_t* first_point, int y_min, int y_max) {
             if (y1 != y2) {
                 // Add this side because not horizontal
                 int scanline = 0;
-                ei_side_t *side = calloc(1, sizeof(ei_side_t));
+                ei_side_t *side = ei_arena_alloc(sizeof(ei_side_t));
                 if (y1 < y2) {
                     scanline = y1;
                     side -> y_max = y2;
@@ -197,7 +198,7 @@ ei_TC_t* init_TC(const ei_linked_point_t* first_point, int y_min, int y_max) {
         if (y1 != y2) {
             // Add this side because not horizontal
             int scanline = 0;
-            ei_side_t *side = calloc(1, sizeof(ei_side_t));
+            ei_side_t *side = ei_arena_alloc(sizeof(ei_side_t));
             if (y1 < y2) {
                 scanline = y1;
                 side -> y_max = y2;
@@ -229,9 +230,9 @@ void delete_side(ei_TCA_t *TCA, int y) {
         ei_side_t *current_side = (TCA -> head) -> next;
         ei_side_t *ancien = TCA -> head;
         while (current_side != NULL) {
+            // Les cotes sont dans l'arene, ils sont liberes avec le polygone
             if (current_side -> y_max == y) {
                 ancien -> next = current_side -> next;
-                free(current_side);
             } else {
                 ancien = current_side;
             }
@@ -353,14 +354,13 @@ void draw_scanline(ei_surface_t surface, ei_TCA_t *TCA, uint32_t color_rgba, int
 
 
 /**
- * \brief	Orders TCA according to x_y
+ * \brief	Orders TCA according to x_y, in place
  *
  * @param	TCA         TCA that needs to be ordered
- * @return  TCA2	    TCA ordered
+ * @return  TCA	    TCA ordered
  */
 ei_TCA_t* order_TCA(ei_TCA_t *TCA) {
-    ei_TCA_t* TCA2 = calloc(1, sizeof(ei_TCA_t));
-    TCA2 -> head = NULL;
+    ei_side_t* sorted = NULL;
     while (TCA -> head != NULL) {
         ei_side_t *before = TCA -> head;
         ei_side_t *current = TCA -> head;
@@ -380,38 +380,52 @@ ei_TCA_t* order_TCA(ei_TCA_t *TCA) {
         } else {
             before -> next = maxi -> next;
         }
-        // ajout maxi au debut de TCA2
-        maxi -> next = (struct ei_side_t*) TCA2 -> head;
-        TCA2 -> head = maxi;
+        // ajout maxi au debut de la liste triee
+        maxi -> next = (struct ei_side_t*) sorted;
+        sorted = maxi;
     }
-    TCA -> head = NULL;
-    free(TCA);
-    return TCA2;
+    TCA -> head = sorted;
+    return TCA;
 }
 
+
+
 /**
- * \brief	A function to free them all
- *
- * @param	TCA 	Table of active sides
- * @param	TC 	Table of sides
+ * \brief	A polygon to fill, see \ref polygon_band.
+ */
+typedef struct {
+    ei_surface_t		surface;
+    const ei_linked_point_t*	first_point;
+    uint32_t			color_rgba;
+} ei_polygon_param_t;
+
+/**
+ * \brief	Fills the rows of a polygon within a band. The sides are followed from the top
+ * of the polygon, but only the scanlines of the band are drawn.
  */
-void free_all(ei_TC_t *TC, ei_TCA_t *TCA, int* tab) {
-    free(tab);
-    free(TC->tab);
-    ei_side_t* ancient = (ei_side_t*) TCA -> head;
-    ei_side_t* current = ancient;
-    while (current != NULL) {
-        current = (ei_side_t*) ancient -> next;
-        free(ancient);
-        ancient = current;
+static void polygon_band(const ei_rect_t* band, void* user_param){
+    ei_polygon_param_t* polygon = (ei_polygon_param_t*) user_param;
+    // Les tables de cotes ne vivent que le temps du remplissage
+    ei_arena_mark_t mark = ei_arena_mark();
+    int* tab = init_scanline((ei_linked_point_t*)polygon -> first_point);
+    ei_TC_t *TC = init_TC(polygon -> first_point, tab[0], tab[1]);
+    int y = tab[0];
+    int y_end = min(tab[1], band -> top_left.y + band -> size.height);
+    ei_TCA_t active = {NULL};
+    ei_TCA_t* TCA = &active;
+    while (y < y_end) {
+        move_side(TCA, TC, y - tab[0]);
+        delete_side(TCA, y);
+        TCA = order_TCA(TCA);
+        if (y >= band -> top_left.y) {
+            draw_scanline(polygon -> surface, TCA, polygon -> color_rgba, y, band);
+        }
+        y++;
+        update_intersect(TCA);
     }
-    free(ancient);
-    free(TC);
-    free(TCA);
+    ei_arena_rewind(mark);
 }
 
-
-
 /**
  * \brief	Draws a filled polygon.
  *
@@ -426,19 +440,21 @@ void			ei_draw_polygon		(ei_surface_t			surface,
         const ei_linked_point_t*	first_point,
         const ei_color_t		color,
         const ei_rect_t*		clipper) {
-    uint32_t color_rgba = ei_map_rgba(surface, &color);
-    int* tab = init_scanline((ei_linked_point_t*)first_point);
-    ei_TC_t *TC = init_TC(first_point, tab[0], tab[1]);
-    int y = tab[0];
-    ei_TCA_t* TCA = calloc(1, sizeof(ei_TCA_t));
-    TCA -> head = NULL;
-    while (y < tab[1]) {
-        move_side(TCA, TC, y - tab[0]);
-        delete_side(TCA, y);
-        TCA = order_TCA(TCA);
-        draw_scanline(surface, TCA, color_rgba, y, clipper);
-        y++;
-        update_intersect(TCA);
+    ei_polygon_param_t polygon = {surface, first_point, ei_map_rgba(surface, &color)};
+    // Les bandes couvrent le rectangle englobant du polygone, dans le clipper
+    ei_point_t top_left = first_point -> point;
+    ei_point_t bottom_right = first_point -> point;
+    for (const ei_linked_point_t* current = first_point -> next; current != NULL;
+        current = current -> next) {
+        top_left.x = min(top_left.x, current -> point.x);
+        top_left.y = min(top_left.y, current -> point.y);
+        bottom_right.x = max(bottom_right.x, current -> point.x);
+        bottom_right.y = max(bottom_right.y, current -> point.y);
+    }
+    ei_rect_t area = {top_left, {bottom_right.x - top_left.x + 1,
+        bottom_right.y - top_left.y}};
+    if (clipper != NULL) {
+        area = ei_rect_intersection(&area, clipper);
     }
-    free_all(TC, TCA, tab);
+    ei_draw_bands(&area, polygon_band, &polygon);
 }
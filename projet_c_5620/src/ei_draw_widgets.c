@@ -11,6 +11,7 @@
 #include "ei_draw_extension.h"
 #include "ei_draw_widgets.h"
 #include "ei_all_widgets.h"
+#include "ei_arena.h"
 
 #define max(a,b) ((a) > (b) ? a : b)
 #define min(a,b) ((a) < (b) ? a : b)
@@ -31,7 +32,7 @@ ei_linked_point_t* ei_arc(ei_point_t centre, uint32_t rayon, int angle_debut,
     float pas = ((float)(angle_fin - angle_debut)) /100;
     ei_point_t first_point = {(int) (centre.x + rayon*cos(angle_debut*val)),(int)
          (centre.y + rayon*sin(angle_debut*val))};
-    ei_linked_point_t* start = calloc(1, sizeof(ei_linked_point_t));
+    ei_linked_point_t* start = ei_arena_alloc(sizeof(ei_linked_point_t));
     start -> point = first_point;
     float angle, fin;
     if (pas > 0) {
@@ -42,18 +43,17 @@ ei_linked_point_t* ei_arc(ei_point_t centre, uint32_t rayon, int angle_debut,
         fin = angle_debut;
         pas = -pas;
     }
-    ei_linked_point_t* current = calloc(1, sizeof(ei_linked_point_t));
     ei_linked_point_t* ancient = start;
     while (angle < fin) {
         angle += pas;
         ei_point_t point = {(int) (centre.x + rayon*cos(angle*val)),
             (int) (centre.y + rayon*sin(angle*val))};
-        ei_linked_point_t* current = calloc(1, sizeof(ei_linked_point_t));
+        ei_linked_point_t* current = ei_arena_alloc(sizeof(ei_linked_point_t));
         current -> point = point;
         ancient -> next = current;
         ancient = current;
     }
-    current -> next = NULL;
+    ancient -> next = NULL;
     if (pas < 0) {
         start = ei_linked_inverse(start);
     }
@@ -121,8 +121,8 @@ ei_linked_point_t* ei_rounded_frame(ei_rect_t rectangle, uint32_t rayon, int cho
         point_gauche.x = rectangle.top_left.x + h;
         point_gauche.y = rectangle.top_left.y + rectangle.size.height - h;
     }
-    ei_linked_point_t* centre_gauche = calloc(1, sizeof(ei_linked_point_t));
-    ei_linked_point_t* centre_droit = calloc(1, sizeof(ei_linked_point_t));
+    ei_linked_point_t* centre_gauche = ei_arena_alloc(sizeof(ei_linked_point_t));
+    ei_linked_point_t* centre_droit = ei_arena_alloc(sizeof(ei_linked_point_t));
     centre_gauche -> point = point_gauche;
     centre_droit -> point = point_droit;
     if (choice == 1) {
@@ -228,6 +228,8 @@ void ei_draw_button(ei_surface_t surface,
         ei_rect_t* img_rect,
         ei_point_t where,
         ei_rect_t* clipper) {
+    // Les points des polygones sont liberes en sortie
+    ei_arena_mark_t mark = ei_arena_mark();
     ei_linked_point_t* frame = ei_rounded_frame(rectangle, corner_radius, 1);
     if (relief == ei_relief_raised) {
         color.blue = min(color.blue + 40, 255);
@@ -239,7 +241,6 @@ void ei_draw_button(ei_surface_t surface,
         color.green = max(color.green - 80, 0);
         frame = ei_rounded_frame(rectangle, corner_radius, 2);
         ei_draw_polygon(surface, frame, color, clipper);
-        free_ei_linked_point(frame);
         color.blue += 40;
         color.red += 40;
         color.green += 40;
@@ -254,7 +255,6 @@ void ei_draw_button(ei_surface_t surface,
         color.green = min(color.green + 80, 255);
         frame = ei_rounded_frame(rectangle, corner_radius, 2);
         ei_draw_polygon(surface, frame, color, clipper);
-        free_ei_linked_point(frame);
         color.blue -= 40;
         color.red -= 40;
         color.green -= 40;
@@ -265,22 +265,7 @@ void ei_draw_button(ei_surface_t surface,
     rectangle.top_left.y += border_width;
     frame = ei_rounded_frame(rectangle, corner_radius, 0);
     ei_draw_polygon(surface, frame, color, clipper);
-    free_ei_linked_point(frame);
-}
-
-/**
- * \brief	This function frees a ei_linked_point structure
- *
- * @param	first	The first point of the chained list
- *
- */
-void free_ei_linked_point(ei_linked_point_t* first){
-    ei_linked_point_t* current = first;
-    while (current != NULL){
-        ei_linked_point_t* suiv = current -> next;
-        free(current);
-        current = suiv;
-    }
+    ei_arena_rewind(mark);
 }
 
 /**
@@ -301,6 +286,7 @@ void ei_draw_toplevel(ei_surface_t surface,
         int border_width,
         char** title,
         ei_rect_t* clipper) {
+    ei_arena_mark_t mark = ei_arena_mark();
     ei_point_t centre = {rectangle.top_left.x + 10, rectangle.top_left.y + 10};
     ei_linked_point_t* first = ei_arc(centre, 10, 180, 270);
     centre.x = centre.x + rectangle.size.width - 20;
@@ -309,9 +295,9 @@ void ei_draw_toplevel(ei_surface_t surface,
         + rectangle.size.height};
     ei_point_t corner_southeast = {rectangle.top_left.x + rectangle.size.width,
          corner_southwest.y};
-    ei_linked_point_t* third = calloc(1, sizeof(ei_linked_point_t));
+    ei_linked_point_t* third = ei_arena_alloc(sizeof(ei_linked_point_t));
     third -> point = corner_southeast;
-    ei_linked_point_t* fourth = calloc(1, sizeof(ei_linked_point_t));
+    ei_linked_point_t* fourth = ei_arena_alloc(sizeof(ei_linked_point_t));
     fourth -> point = corner_southwest;
     ei_linked_point_t* current = first;
     while (current -> next != NULL) {
@@ -325,7 +311,6 @@ void ei_draw_toplevel(ei_surface_t surface,
     third -> next = fourth;
     fourth -> next = NULL;
     ei_draw_polygon(surface, first, *color2, clipper);
-    free_ei_linked_point(first);
     if (title != NULL) {
         rectangle.top_left.x += border_width;
         rectangle.top_left.y += 30; // on choisit arbitrairement la taille de la bannière
@@ -333,6 +318,6 @@ void ei_draw_toplevel(ei_surface_t surface,
         rectangle.size.height -= border_width + 30;
         first = ei_rounded_frame(rectangle, 0, 0);
         ei_draw_polygon(surface, first, *color, clipper);
-        free_ei_linked_point(first);
     }
+    ei_arena_rewind(mark);
 }
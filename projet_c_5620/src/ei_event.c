@@ -1,5 +1,7 @@
 #include "ei_event.h"
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include "ei_all_widgets.h"
 #include "ei_application.h"
 /**
@@ -12,6 +14,8 @@
  *
  */
 
+#define max(a,b) ((a) > (b) ? a : b)
+
 /**
  * Places the further right among its siblings.
  *
@@ -20,23 +24,13 @@
 void place_on_the_right(ei_widget_t* widget){
     if (widget != NULL && widget != ei_app_root_widget()){
         ei_widget_t* parent = (widget -> parent);
-        ei_widget_t* previous = ei_widget_previous(widget);
-        if (previous == NULL && widget != parent -> children_tail){
-            parent -> children_head = widget -> next_sibling;
-        } else if ( widget == parent -> children_tail) {
+        if (widget == parent -> children_tail) {
             return;
-        } else {
-            previous -> next_sibling = widget -> next_sibling;
         }
-        if (widget != parent -> children_tail){
-            if (DRAW_RECT == NULL){
-                DRAW_RECT = calloc(1, sizeof(ei_linked_rect_t));
-            }
-            DRAW_RECT -> rect = (widget -> screen_location);
-        }
-        parent -> children_tail -> next_sibling = widget;
-        parent -> children_tail = widget;
-        widget -> next_sibling = NULL;
+        ei_app_invalidate_rect(&(widget -> screen_location));
+        ei_invalidate_pick_rect(&(widget -> screen_location));
+        ei_widget_unlink(widget);
+        ei_widget_append(parent, widget);
     }
 }
 
@@ -89,3 +83,394 @@ void ei_event_set_default_handle_func(ei_default_handle_func_t func){
 ei_default_handle_func_t ei_event_get_default_handle_func(){
     return DEF_FUNC;
 }
+
+/*
+ * Tables de bindings : une table par type d'evenement. Les bindings d'un widget sont
+ * ranges dans une table de hachage dont la cle est l'adresse du widget, ceux d'un tag
+ * dans un tableau indexe par l'identifiant de la classe (ei_class_none pour "all"),
+ * si bien que la recherche ne compare jamais de noms.
+ */
+
+/**
+ * \brief	A callback bound by \ref ei_bind.
+ */
+typedef struct ei_binding_t {
+    ei_bind_callback_t		callback;
+    void*			user_param;
+    struct ei_binding_t*	next;
+} ei_binding_t;
+
+/**
+ * \brief	All the callbacks bound to one widget or tag, in the order of binding.
+ */
+typedef struct ei_binding_key_t {
+    void*			key;		///< The widget, or NULL for a tag.
+    ei_widgetclass_id_t		tag;		///< The class of a tag, ei_class_none for "all".
+    ei_binding_t*		head;
+    ei_binding_t*		tail;
+    struct ei_binding_key_t*	next;
+} ei_binding_key_t;
+
+/**
+ * \brief	A hash table of the \ref ei_binding_key_t of the widgets, and an array of
+ * those of the tags.
+ */
+typedef struct ei_binding_table_t {
+    ei_binding_key_t**		buckets;
+    int				size;
+    int				count;
+    ei_binding_key_t**		tags;
+    int				tag_size;
+} ei_binding_table_t;
+
+/**
+ * \brief	A dispatch in progress, see \ref ei_event_call_bindings. The dispatches
+ * nested in callbacks are chained to the outer ones.
+ */
+typedef struct ei_dispatch_t {
+    ei_widget_t*		widget;
+    ei_bool_t			destroyed;
+    struct ei_dispatch_t*	outer;
+} ei_dispatch_t;
+
+static ei_binding_table_t BINDINGS[ei_ev_last];
+static ei_widget_t* FOCUS = NULL;
+/* Profondeur d'appel des callbacks : on ne libere rien pendant un appel */
+static int DISPATCHING = 0;
+static ei_bool_t PURGE = EI_FALSE;
+static ei_dispatch_t* DISPATCH = NULL;
+
+static uint32_t hash_pointer(void* key){
+    uint64_t value = (uint64_t) (uintptr_t) key;
+    return (uint32_t) ((value >> 4) * 2654435761u);
+}
+
+/**
+ * \brief	Returns the identifier of the class named by a tag, ei_class_none for "all",
+ * or -1 if the name is unknown. Only \ref ei_bind adds the name to the registry of the
+ * classes, so that the class can be registered after the binding: a lookup must not
+ * use up one of its identifiers.
+ */
+static int tag_id(ei_tag_t tag, ei_bool_t intern){
+    if (strcmp(tag, "all") == 0) {
+        return ei_class_none;
+    }
+    ei_widgetclass_id_t id = (intern == EI_TRUE) ? ei_widgetclass_intern(tag)
+        : ei_widgetclass_lookup(tag);
+    return (id == ei_class_none) ? -1 : (int) id;
+}
+
+static ei_binding_key_t** binding_bucket(ei_binding_table_t* table, void* key){
+    return &(table -> buckets[hash_pointer(key) & (table -> size - 1)]);
+}
+
+static ei_binding_key_t* binding_find(ei_eventtype_t type, void* key){
+    ei_binding_table_t* table = &BINDINGS[type];
+    if (table -> size == 0 || key == NULL) {
+        return NULL;
+    }
+    for (ei_binding_key_t* entry = *binding_bucket(table, key); entry != NULL;
+         entry = entry -> next) {
+        if (entry -> key == key) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static ei_binding_key_t* binding_find_tag(ei_eventtype_t type, int tag){
+    ei_binding_table_t* table = &BINDINGS[type];
+    if (tag < 0 || tag >= table -> tag_size) {
+        return NULL;
+    }
+    return table -> tags[tag];
+}
+
+/**
+ * \brief	Doubles the number of buckets of a table when it has more keys than
+ * buckets.
+ */
+static void binding_grow(ei_binding_table_t* table){
+    int old_size = table -> size;
+    ei_binding_key_t** old_buckets = table -> buckets;
+    table -> size = max(16, 2 * old_size);
+    table -> buckets = calloc(table -> size, sizeof(ei_binding_key_t*));
+    for (int i = 0; i < old_size; i++) {
+        ei_binding_key_t* entry = old_buckets[i];
+        while (entry != NULL) {
+            ei_binding_key_t* next = entry -> next;
+            ei_binding_key_t** bucket = binding_bucket(table, entry -> key);
+            entry -> next = *bucket;
+            *bucket = entry;
+            entry = next;
+        }
+    }
+    free(old_buckets);
+}
+
+/**
+ * \brief	Removes a key and all its callbacks from a table.
+ */
+static void binding_remove_key(ei_binding_table_t* table, ei_binding_key_t* key){
+    if (key -> key == NULL) {
+        table -> tags[key -> tag] = NULL;
+    } else {
+        ei_binding_key_t** link = binding_bucket(table, key -> key);
+        while (*link != key) {
+            link = &((*link) -> next);
+        }
+        *link = key -> next;
+    }
+    ei_binding_t* binding = key -> head;
+    while (binding != NULL) {
+        ei_binding_t* next = binding -> next;
+        free(binding);
+        binding = next;
+    }
+    free(key);
+    table -> count --;
+}
+
+/**
+ * \brief	Frees the unbound callbacks of a key (their callback is NULL), and the
+ * key itself if it has no callback left.
+ */
+static void binding_purge_key(ei_binding_table_t* table, ei_binding_key_t* entry){
+    ei_binding_t** link = &(entry -> head);
+    entry -> tail = NULL;
+    while (*link != NULL) {
+        if ((*link) -> callback == NULL) {
+            ei_binding_t* removed = *link;
+            *link = removed -> next;
+            free(removed);
+        } else {
+            entry -> tail = *link;
+            link = &((*link) -> next);
+        }
+    }
+    if (entry -> head == NULL) {
+        binding_remove_key(table, entry);
+    }
+}
+
+/**
+ * \brief	Frees the callbacks unbound during a dispatch.
+ */
+static void binding_purge(){
+    for (int type = 0; type < ei_ev_last; type++) {
+        ei_binding_table_t* table = &BINDINGS[type];
+        for (int i = 0; i < table -> size; i++) {
+            ei_binding_key_t* entry = table -> buckets[i];
+            while (entry != NULL) {
+                ei_binding_key_t* next_entry = entry -> next;
+                binding_purge_key(table, entry);
+                entry = next_entry;
+            }
+        }
+        for (int i = 0; i < table -> tag_size; i++) {
+            if (table -> tags[i] != NULL) {
+                binding_purge_key(table, table -> tags[i]);
+            }
+        }
+    }
+    PURGE = EI_FALSE;
+}
+
+/**
+ * \brief	Frees the unbound callbacks of a key now, or after the dispatch if
+ * callbacks are being called.
+ */
+static void binding_release(ei_eventtype_t type, ei_binding_key_t* entry){
+    if (DISPATCHING > 0) {
+        PURGE = EI_TRUE;
+    } else {
+        binding_purge_key(&BINDINGS[type], entry);
+    }
+}
+
+void		ei_bind			(ei_eventtype_t		eventtype,
+					 ei_widget_t*		widget,
+					 ei_tag_t		tag,
+					 ei_bind_callback_t	callback,
+					 void*			user_param){
+    ei_binding_table_t* table = &BINDINGS[eventtype];
+    ei_binding_key_t* entry;
+    if (widget != NULL) {
+        entry = binding_find(eventtype, widget);
+        if (entry == NULL) {
+            if (table -> count >= table -> size) {
+                binding_grow(table);
+            }
+            ei_binding_key_t** bucket = binding_bucket(table, widget);
+            entry = calloc(1, sizeof(ei_binding_key_t));
+            entry -> key = widget;
+            entry -> next = *bucket;
+            *bucket = entry;
+            table -> count ++;
+        }
+    } else {
+        int id = tag_id(tag, EI_TRUE);
+        if (id < 0) {
+            return;
+        }
+        if (id >= table -> tag_size) {
+            int old_size = table -> tag_size;
+            table -> tag_size = max(ei_class_first_user, 2 * id);
+            table -> tags = realloc(table -> tags, table -> tag_size * sizeof(ei_binding_key_t*));
+            memset(table -> tags + old_size, 0, (table -> tag_size - old_size)
+                * sizeof(ei_binding_key_t*));
+        }
+        entry = table -> tags[id];
+        if (entry == NULL) {
+            entry = calloc(1, sizeof(ei_binding_key_t));
+            entry -> tag = (ei_widgetclass_id_t) id;
+            table -> tags[id] = entry;
+            table -> count ++;
+        }
+    }
+    ei_binding_t* binding = calloc(1, sizeof(ei_binding_t));
+    binding -> callback = callback;
+    binding -> user_param = user_param;
+    if (entry -> tail == NULL) {
+        entry -> head = binding;
+    } else {
+        entry -> tail -> next = binding;
+    }
+    entry -> tail = binding;
+}
+
+void		ei_unbind		(ei_eventtype_t		eventtype,
+					 ei_widget_t*		widget,
+					 ei_tag_t		tag,
+					 ei_bind_callback_t	callback,
+					 void*			user_param){
+    ei_binding_key_t* entry = (widget != NULL) ? binding_find(eventtype, widget)
+        : binding_find_tag(eventtype, tag_id(tag, EI_FALSE));
+    if (entry == NULL) {
+        return;
+    }
+    for (ei_binding_t* binding = entry -> head; binding != NULL; binding = binding -> next) {
+        if (binding -> callback == callback && binding -> user_param == user_param) {
+            // La liste est peut-etre en cours de parcours
+            binding -> callback = NULL;
+            binding_release(eventtype, entry);
+            return;
+        }
+    }
+}
+
+/**
+ * \brief	Calls the callbacks of a key until one of them handles the event, or
+ * destroys the widget of the dispatch.
+ */
+static ei_bool_t binding_call(ei_binding_key_t* entry, ei_widget_t* widget, ei_event_t* event){
+    if (entry == NULL) {
+        return EI_FALSE;
+    }
+    for (ei_binding_t* binding = entry -> head; binding != NULL; binding = binding -> next) {
+        if (binding -> callback != NULL
+            && (binding -> callback)(widget, event, binding -> user_param) == EI_TRUE) {
+            return EI_TRUE;
+        }
+        if (DISPATCH -> destroyed == EI_TRUE) {
+            return EI_FALSE;
+        }
+    }
+    return EI_FALSE;
+}
+
+ei_bool_t ei_event_call_bindings(ei_widget_t* widget, ei_event_t* event){
+    ei_eventtype_t type = event -> type;
+    if (type <= ei_ev_none || type >= ei_ev_last || BINDINGS[type].count == 0) {
+        return EI_FALSE;
+    }
+    ei_dispatch_t dispatch = {widget, EI_FALSE, DISPATCH};
+    DISPATCH = &dispatch;
+    DISPATCHING ++;
+    ei_bool_t handled = EI_FALSE;
+    if (widget != NULL) {
+        handled = binding_call(binding_find(type, widget), widget, event);
+        if (handled == EI_FALSE && dispatch.destroyed == EI_FALSE) {
+            ei_widgetclass_id_t id = ei_widget_links(widget) -> class_id;
+            handled = binding_call(binding_find_tag(type, id), widget, event);
+        }
+    }
+    if (handled == EI_FALSE && dispatch.destroyed == EI_FALSE) {
+        handled = binding_call(binding_find_tag(type, ei_class_none), widget, event);
+    }
+    DISPATCHING --;
+    DISPATCH = dispatch.outer;
+    if (DISPATCHING == 0 && PURGE == EI_TRUE) {
+        binding_purge();
+    }
+    // Le widget detruit par un callback ne doit plus etre lu : l'evenement est traite
+    return handled == EI_TRUE || dispatch.destroyed == EI_TRUE;
+}
+
+ei_bool_t ei_event_has_bindings(ei_eventtype_t eventtype){
+    return BINDINGS[eventtype].count > 0;
+}
+
+void ei_event_forget_widget(ei_widget_t* widget){
+    if (FOCUS == widget) {
+        FOCUS = NULL;
+    }
+    if (EVENT_ACTIVE == widget) {
+        EVENT_ACTIVE = NULL;
+    }
+    for (ei_dispatch_t* dispatch = DISPATCH; dispatch != NULL; dispatch = dispatch -> outer) {
+        if (dispatch -> widget == widget) {
+            dispatch -> destroyed = EI_TRUE;
+        }
+    }
+    for (int type = 0; type < ei_ev_last; type++) {
+        ei_binding_key_t* entry = binding_find(type, widget);
+        if (entry != NULL) {
+            for (ei_binding_t* binding = entry -> head; binding != NULL;
+                 binding = binding -> next) {
+                binding -> callback = NULL;
+            }
+            binding_release(type, entry);
+        }
+    }
+}
+
+void ei_event_free_bindings(){
+    for (int type = 0; type < ei_ev_last; type++) {
+        ei_binding_table_t* table = &BINDINGS[type];
+        for (int i = 0; i < table -> size; i++) {
+            while (table -> buckets[i] != NULL) {
+                binding_remove_key(table, table -> buckets[i]);
+            }
+        }
+        for (int i = 0; i < table -> tag_size; i++) {
+            if (table -> tags[i] != NULL) {
+                binding_remove_key(table, table -> tags[i]);
+            }
+        }
+        free(table -> buckets);
+        free(table -> tags);
+        table -> buckets = NULL;
+        table -> size = 0;
+        table -> tags = NULL;
+        table -> tag_size = 0;
+    }
+}
+
+/**
+ * Sets the widget that receives the keyboard events.
+ *
+ * @param	widget		The widget that gets the focus, or NULL.
+ */
+void ei_event_set_focus_widget(ei_widget_t* widget){
+    FOCUS = widget;
+}
+
+/**
+ * Returns the widget that receives the keyboard events.
+ *
+ * @return			The widget that has the focus, or NULL.
+ */
+ei_widget_t* ei_event_get_focus_widget(){
+    return FOCUS;
+}
@@ -0,0 +1,72 @@
+/**
+ *  @file	ei_frame_scheduler.c
+ *  @brief	Decides when the damaged region of the screen is redrawn: at most once per
+ *		frame interval, or immediately for latency-critical input.
+ *
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include "ei_frame_scheduler.h"
+#include "ei_all_widgets.h"
+#include "ei_timer.h"
+#include "ei_placer.h"
+#include "hw_interface.h"
+
+#define max(a,b) (a>=b?a:b)
+
+/* Duree minimale entre deux images, en secondes (0 : pas de limite) */
+static double FRAME_INTERVAL = 1.0 / EI_DEFAULT_FRAME_RATE;
+/* Date du dernier dessin */
+static double LAST_FRAME = 0;
+/* Vrai si un timer d'echeance est deja programme */
+static ei_bool_t DEADLINE_PENDING = EI_FALSE;
+
+void ei_app_set_frame_rate(int frame_rate){
+    if (frame_rate <= 0) {
+        FRAME_INTERVAL = 0;
+    } else {
+        FRAME_INTERVAL = 1.0 / frame_rate;
+    }
+}
+
+int ei_app_get_frame_rate(){
+    if (FRAME_INTERVAL == 0) {
+        return 0;
+    }
+    return (int) lround(1.0 / FRAME_INTERVAL);
+}
+
+/**
+ * \brief	Draws the pending damage and remembers when it was done.
+ */
+static void ei_frame_render(){
+    draw();
+    LAST_FRAME = hw_now();
+}
+
+/**
+ * \brief	Called by the timer at the deadline of the next frame: the frame itself
+ * is drawn by the next call to \ref ei_frame_request, so that a deadline reached
+ * in the middle of a batch of events does not split it.
+ */
+static void ei_frame_deadline(void* user_param){
+    DEADLINE_PENDING = EI_FALSE;
+}
+
+void ei_frame_request(ei_bool_t immediate){
+    // Un placement sans dommage attend aussi la frame : la passe du placeur invalide
+    // les widgets qui ont bouge
+    if (DRAW_RECT == NULL && ei_placer_pending() == EI_FALSE) {
+        return;
+    }
+    double late = hw_now() - LAST_FRAME;
+    // Le timer d'echeance a une precision d'une milliseconde
+    if (immediate == EI_TRUE || late >= FRAME_INTERVAL - 0.001) {
+        ei_frame_render();
+    } else if (DEADLINE_PENDING == EI_FALSE) {
+        int ms_delay = max(1, (int) ceil((FRAME_INTERVAL - late) * 1000));
+        DEADLINE_PENDING = EI_TRUE;
+        ei_timer_add(ms_delay, ei_frame_deadline, NULL);
+    }
+}
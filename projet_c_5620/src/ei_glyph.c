@@ -0,0 +1,270 @@
+/**
+ *  @file	ei_glyph.c
+ *  @brief	Glyph atlas: each character of a font is rasterized once by
+ *		\ref hw_text_create_surface, and its coverage is kept in the atlas of the font.
+ *		Texts are drawn by blending the coverage of their glyphs in the target surface.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "ei_glyph.h"
+#include "ei_draw.h"
+#include "ei_text.h"
+
+#define max(a,b) ((a) > (b) ? a : b)
+#define min(a,b) ((a) < (b) ? a : b)
+
+/* Un glyphe par valeur d'octet */
+#define GLYPHS		256
+/* Taille d'une page de couverture d'un atlas, en octets */
+#define PAGE_BYTES	16384
+
+/**
+ * \brief	A glyph in an atlas: its coverage is stored in a page of the atlas, one byte
+ * per pixel, line after line.
+ */
+typedef struct {
+    ei_bool_t		ready;
+    int			width;
+    int			height;
+    unsigned char*	coverage;
+} ei_glyph_t;
+
+/**
+ * \brief	A block of coverage of an atlas. The pages are never moved, so that the
+ * glyphs can be read while others are added.
+ */
+typedef struct ei_page_t {
+    struct ei_page_t*	next;
+    size_t		size;
+    size_t		used;
+    unsigned char*	data;
+} ei_page_t;
+
+/**
+ * \brief	The glyphs of a font.
+ */
+typedef struct ei_atlas_t {
+    ei_font_t		font;
+    ei_glyph_t		glyphs[GLYPHS];
+    ei_page_t*		pages;
+    size_t		bytes;
+    struct ei_atlas_t*	next;
+} ei_atlas_t;
+
+static ei_atlas_t* ATLASES = NULL;
+static int GLYPH_COUNT = 0;
+static unsigned long DRAWN = 0;
+/* Les textes peuvent etre dessines par plusieurs workers a la fois */
+static pthread_mutex_t LOCK = PTHREAD_MUTEX_INITIALIZER;
+
+static ei_atlas_t* atlas_get(ei_font_t font){
+    ei_atlas_t* atlas = ATLASES;
+    while (atlas != NULL) {
+        if (atlas -> font == font) {
+            return atlas;
+        }
+        atlas = atlas -> next;
+    }
+    atlas = calloc(1, sizeof(ei_atlas_t));
+    atlas -> font = font;
+    atlas -> next = ATLASES;
+    ATLASES = atlas;
+    return atlas;
+}
+
+/**
+ * \brief	Reserves bytes in the pages of an atlas.
+ */
+static unsigned char* atlas_reserve(ei_atlas_t* atlas, size_t bytes){
+    ei_page_t* page = atlas -> pages;
+    if (page == NULL || page -> used + bytes > page -> size) {
+        page = malloc(sizeof(ei_page_t));
+        page -> size = max(bytes, PAGE_BYTES);
+        page -> used = 0;
+        page -> data = malloc(page -> size);
+        page -> next = atlas -> pages;
+        atlas -> pages = page;
+    }
+    unsigned char* data = page -> data + page -> used;
+    page -> used += bytes;
+    atlas -> bytes += bytes;
+    return data;
+}
+
+static void atlas_free(ei_atlas_t* atlas){
+    while (atlas -> pages != NULL) {
+        ei_page_t* next = atlas -> pages -> next;
+        free(atlas -> pages -> data);
+        free(atlas -> pages);
+        atlas -> pages = next;
+    }
+    free(atlas);
+}
+
+/**
+ * \brief	Rasterizes a character and copies the alpha channel of its surface in the atlas.
+ * Called with the lock held.
+ */
+static ei_glyph_t* glyph_get(ei_atlas_t* atlas, unsigned char c){
+    ei_glyph_t* glyph = &(atlas -> glyphs[c]);
+    if (glyph -> ready == EI_TRUE) {
+        return glyph;
+    }
+    char text[2] = {(char) c, '\0'};
+    ei_color_t white = {255, 255, 255, 255};
+    // Les mesures de ei_text.c appellent aussi la bibliotheque de polices
+    ei_text_lock_fonts();
+    ei_surface_t surface = hw_text_create_surface(text, atlas -> font, &white);
+    ei_text_unlock_fonts();
+    glyph -> ready = EI_TRUE;
+    GLYPH_COUNT ++;
+    if (surface == NULL) {
+        return glyph;
+    }
+    ei_size_t size = hw_surface_get_size(surface);
+    size_t bytes = (size_t) size.width * size.height;
+    int ir, ig, ib, ia;
+    hw_surface_get_channel_indices(surface, &ir, &ig, &ib, &ia);
+    hw_surface_lock(surface);
+    uint32_t* pixel = (uint32_t*) hw_surface_get_buffer(surface);
+    unsigned char* cover = atlas_reserve(atlas, bytes);
+    for (size_t i = 0; i < bytes; i++) {
+        // Sans canal alpha, le texte blanc est opaque
+        cover[i] = (ia < 0) ? 255 : (unsigned char) (pixel[i] >> (8 * ia));
+    }
+    hw_surface_unlock(surface);
+    hw_surface_free(surface);
+    glyph -> width = size.width;
+    glyph -> height = size.height;
+    glyph -> coverage = cover;
+    return glyph;
+}
+
+/**
+ * \brief	Blends a color in a pixel, two channels at a time.
+ *
+ * @param	dst		The pixel.
+ * @param	src		The color, in the format of the surface.
+ * @param	a		The coverage, from 0 to 256.
+ */
+static inline uint32_t blend(uint32_t dst, uint32_t src, uint32_t a){
+    uint32_t rb = (((src & 0x00ff00ff) * a + (dst & 0x00ff00ff) * (256 - a)) >> 8)
+        & 0x00ff00ff;
+    uint32_t ag = ((((src >> 8) & 0x00ff00ff) * a + ((dst >> 8) & 0x00ff00ff) * (256 - a))
+        >> 8) & 0x00ff00ff;
+    return rb | (ag << 8);
+}
+
+/**
+ * \brief	Blends the visible part of a glyph in the surface.
+ */
+static void glyph_blit(uint32_t* buffer, int stride, ei_glyph_t* glyph,
+        ei_point_t origin, const ei_rect_t* area, uint32_t color){
+    int x0 = max(origin.x, area -> top_left.x);
+    int y0 = max(origin.y, area -> top_left.y);
+    int x1 = min(origin.x + glyph -> width, area -> top_left.x + area -> size.width);
+    int y1 = min(origin.y + glyph -> height, area -> top_left.y + area -> size.height);
+    for (int y = y0; y < y1; y++) {
+        const unsigned char* cover = glyph -> coverage
+            + (size_t) (y - origin.y) * glyph -> width + (x0 - origin.x);
+        uint32_t* pixel = buffer + (size_t) y * stride + x0;
+        for (int x = x0; x < x1; x++) {
+            uint32_t a = *cover;
+            if (a == 255) {
+                *pixel = color;
+            } else if (a != 0) {
+                *pixel = blend(*pixel, color, a + (a >> 7));
+            }
+            cover ++;
+            pixel ++;
+        }
+    }
+}
+
+void ei_glyph_draw_text(ei_surface_t surface, const ei_point_t* where, const char* text,
+			ei_font_t font, const ei_color_t* color, const ei_rect_t* clipper){
+    if (font == NULL) {
+        font = ei_default_font;
+    }
+    pthread_mutex_lock(&LOCK);
+    ei_atlas_t* atlas = atlas_get(font);
+    pthread_mutex_unlock(&LOCK);
+    ei_rect_t area = hw_surface_get_rect(surface);
+    if (clipper != NULL) {
+        int x0 = max(area.top_left.x, clipper -> top_left.x);
+        int y0 = max(area.top_left.y, clipper -> top_left.y);
+        int x1 = min(area.top_left.x + area.size.width,
+            clipper -> top_left.x + clipper -> size.width);
+        int y1 = min(area.top_left.y + area.size.height,
+            clipper -> top_left.y + clipper -> size.height);
+        area.top_left.x = x0;
+        area.top_left.y = y0;
+        area.size.width = x1 - x0;
+        area.size.height = y1 - y0;
+    }
+    if (area.size.width <= 0 || area.size.height <= 0) {
+        return;
+    }
+    // Le texte est opaque, son alpha n'est pas utilise
+    ei_color_t opaque = *color;
+    opaque.alpha = 255;
+    uint32_t pixel_color = ei_map_rgba(surface, &opaque);
+    uint32_t* buffer = (uint32_t*) hw_surface_get_buffer(surface);
+    int stride = hw_surface_get_size(surface).width;
+    ei_point_t origin = *where;
+    for (const unsigned char* c = (const unsigned char*) text; *c != '\0'; c++) {
+        if (origin.x >= area.top_left.x + area.size.width) {
+            break;
+        }
+        // Un glyphe pret n'est plus modifie, il est lu sans le verrou
+        pthread_mutex_lock(&LOCK);
+        ei_glyph_t* glyph = glyph_get(atlas, *c);
+        DRAWN ++;
+        pthread_mutex_unlock(&LOCK);
+        glyph_blit(buffer, stride, glyph, origin, &area, pixel_color);
+        origin.x += glyph -> width;
+    }
+}
+
+void ei_glyph_get_stats(ei_glyph_stats_t* stats){
+    pthread_mutex_lock(&LOCK);
+    stats -> fonts = 0;
+    stats -> glyphs = GLYPH_COUNT;
+    stats -> bytes = 0;
+    stats -> drawn = DRAWN;
+    for (ei_atlas_t* atlas = ATLASES; atlas != NULL; atlas = atlas -> next) {
+        stats -> fonts ++;
+        stats -> bytes += atlas -> bytes;
+    }
+    pthread_mutex_unlock(&LOCK);
+}
+
+void ei_glyph_forget_font(ei_font_t font){
+    pthread_mutex_lock(&LOCK);
+    ei_atlas_t** link = &ATLASES;
+    while (*link != NULL) {
+        ei_atlas_t* atlas = *link;
+        if (atlas -> font == font) {
+            *link = atlas -> next;
+            atlas_free(atlas);
+            break;
+        }
+        link = &(atlas -> next);
+    }
+    pthread_mutex_unlock(&LOCK);
+}
+
+void ei_glyph_free_atlases(){
+    pthread_mutex_lock(&LOCK);
+    while (ATLASES != NULL) {
+        ei_atlas_t* next = ATLASES -> next;
+        atlas_free(ATLASES);
+        ATLASES = next;
+    }
+    GLYPH_COUNT = 0;
+    pthread_mutex_unlock(&LOCK);
+}
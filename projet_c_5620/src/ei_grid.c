@@ -0,0 +1,559 @@
+/**
+ *  @file	ei_grid.c
+ *  @brief	The "grid" geometry manager. Each master keeps its rows and columns (the lines
+ *		of its two axes) with their size and offset, and each line the list of the
+ *		widgets that are only in it. When a widget changes, the lines it is in are
+ *		measured again, the offsets of the axis are summed again, and only the widgets
+ *		of the lines whose size or offset has changed are moved. The position found is
+ *		given to the placer as absolute coordinates in the master.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "ei_grid.h"
+#include "ei_placer.h"
+#include "ei_application.h"
+#include "ei_all_widgets.h"
+
+#define max(a,b) ((a) > (b) ? a : b)
+#define min(a,b) ((a) < (b) ? a : b)
+
+#define BUCKETS		64
+/* Axe des colonnes (x, largeur) et axe des lignes (y, hauteur) */
+#define COLUMNS		0
+#define ROWS		1
+
+struct ei_grid_master_t;
+
+/**
+ * \brief	A widget placed by the grid. With a span of 1 on an axis, it is in the list of
+ * its line of this axis; with a larger span, in the list of the spanning widgets of the
+ * axis.
+ */
+typedef struct ei_grid_slave_t {
+    ei_widget_t*		widget;
+    struct ei_grid_master_t*	master;
+    int				start[2];
+    int				span[2];
+    ei_anchor_t			anchor;
+    ei_bool_t			fill;
+    unsigned int		stamp;
+    struct ei_grid_slave_t*	next[2];
+    struct ei_grid_slave_t*	hash_next;
+} ei_grid_slave_t;
+
+/**
+ * \brief	A row or a column. "natural" is the largest request of its widgets, "size"
+ * and "offset" what the last layout gave it.
+ */
+typedef struct {
+    int			weight;
+    int			min_size;
+    int			natural;
+    int			size;
+    int			offset;
+    ei_bool_t		dirty;
+    ei_bool_t		moved;
+    ei_grid_slave_t*	slaves;
+} ei_grid_line_t;
+
+/**
+ * \brief	A widget whose children are placed by the grid.
+ */
+typedef struct ei_grid_master_t {
+    ei_widget_t*		widget;
+    ei_grid_line_t*		lines[2];
+    int				count[2];
+    ei_grid_slave_t*		spanning[2];
+    int*			dirty[2];
+    int				dirty_count[2];
+    int				dirty_capacity[2];
+    int				extent[2];
+    unsigned int		stamp;
+    struct ei_grid_master_t*	hash_next;
+} ei_grid_master_t;
+
+static ei_grid_master_t* MASTERS[BUCKETS];
+static ei_grid_slave_t* SLAVES[BUCKETS];
+static ei_grid_stats_t STATS;
+/* Taille des lignes et decalages calcules, reutilises d'un axe a l'autre */
+static int* SIZES = NULL;
+static int SIZES_CAPACITY = 0;
+
+static unsigned int bucket_of(ei_widget_t* widget){
+    uintptr_t key = (uintptr_t) widget;
+    return (unsigned int) ((key >> 4) ^ (key >> 12)) % BUCKETS;
+}
+
+static ei_grid_master_t* master_find(ei_widget_t* widget){
+    ei_grid_master_t* master = MASTERS[bucket_of(widget)];
+    while (master != NULL && master -> widget != widget) {
+        master = master -> hash_next;
+    }
+    return master;
+}
+
+static ei_grid_slave_t* slave_find(ei_widget_t* widget){
+    ei_grid_slave_t* slave = SLAVES[bucket_of(widget)];
+    while (slave != NULL && slave -> widget != widget) {
+        slave = slave -> hash_next;
+    }
+    return slave;
+}
+
+/**
+ * \brief	Returns the grid of a widget, created empty if it has none.
+ */
+static ei_grid_master_t* master_get(ei_widget_t* widget){
+    ei_grid_master_t* master = master_find(widget);
+    if (master == NULL) {
+        master = calloc(1, sizeof(ei_grid_master_t));
+        master -> widget = widget;
+        master -> hash_next = MASTERS[bucket_of(widget)];
+        MASTERS[bucket_of(widget)] = master;
+        STATS.masters ++;
+    }
+    return master;
+}
+
+/**
+ * \brief	Makes sure that an axis of a grid has at least "count" lines.
+ */
+static void master_grow(ei_grid_master_t* master, int axis, int count){
+    if (count <= master -> count[axis]) {
+        return;
+    }
+    master -> lines[axis] = realloc(master -> lines[axis], count * sizeof(ei_grid_line_t));
+    for (int i = master -> count[axis]; i < count; i++) {
+        ei_grid_line_t* line = &(master -> lines[axis][i]);
+        line -> weight = 0;
+        line -> min_size = 0;
+        line -> natural = 0;
+        line -> size = 0;
+        line -> offset = 0;
+        line -> dirty = EI_FALSE;
+        line -> moved = EI_FALSE;
+        line -> slaves = NULL;
+    }
+    master -> count[axis] = count;
+}
+
+/**
+ * \brief	Marks a line to be measured again at the next layout of its grid.
+ */
+static void master_dirty(ei_grid_master_t* master, int axis, int index){
+    ei_grid_line_t* line = &(master -> lines[axis][index]);
+    if (line -> dirty == EI_TRUE) {
+        return;
+    }
+    line -> dirty = EI_TRUE;
+    if (master -> dirty_count[axis] == master -> dirty_capacity[axis]) {
+        master -> dirty_capacity[axis] = max(8, 2 * master -> dirty_capacity[axis]);
+        master -> dirty[axis] = realloc(master -> dirty[axis],
+            master -> dirty_capacity[axis] * sizeof(int));
+    }
+    master -> dirty[axis][master -> dirty_count[axis]] = index;
+    master -> dirty_count[axis] ++;
+}
+
+static int slave_request(ei_grid_slave_t* slave, int axis){
+    return (axis == COLUMNS) ? slave -> widget -> requested_size.width
+        : slave -> widget -> requested_size.height;
+}
+
+/**
+ * \brief	Adds a widget to the lists of its lines and marks them.
+ */
+static void slave_link(ei_grid_slave_t* slave){
+    ei_grid_master_t* master = slave -> master;
+    for (int axis = 0; axis < 2; axis++) {
+        master_grow(master, axis, slave -> start[axis] + slave -> span[axis]);
+        ei_grid_slave_t** list = &(master -> spanning[axis]);
+        if (slave -> span[axis] == 1) {
+            list = &(master -> lines[axis][slave -> start[axis]].slaves);
+        }
+        slave -> next[axis] = *list;
+        *list = slave;
+        master_dirty(master, axis, slave -> start[axis]);
+    }
+}
+
+/**
+ * \brief	Removes a widget from the lists of its lines and marks them.
+ */
+static void slave_unlink(ei_grid_slave_t* slave){
+    ei_grid_master_t* master = slave -> master;
+    for (int axis = 0; axis < 2; axis++) {
+        ei_grid_slave_t** link = &(master -> spanning[axis]);
+        if (slave -> span[axis] == 1) {
+            link = &(master -> lines[axis][slave -> start[axis]].slaves);
+        }
+        while (*link != slave) {
+            link = &((*link) -> next[axis]);
+        }
+        *link = slave -> next[axis];
+        master_dirty(master, axis, slave -> start[axis]);
+    }
+}
+
+/**
+ * \brief	Computes the cell of a widget, then gives its rectangle in the master to the
+ * placer. The old and the new location are damaged if the widget has moved.
+ */
+static void slave_place(ei_grid_slave_t* slave){
+    ei_grid_master_t* master = slave -> master;
+    ei_widget_t* widget = slave -> widget;
+    int position[2];
+    int size[2];
+    for (int axis = 0; axis < 2; axis++) {
+        ei_grid_line_t* first = &(master -> lines[axis][slave -> start[axis]]);
+        ei_grid_line_t* last = first + slave -> span[axis] - 1;
+        position[axis] = first -> offset;
+        size[axis] = last -> offset + last -> size - first -> offset;
+    }
+    ei_rect_t cell = {{position[COLUMNS], position[ROWS]}, {size[COLUMNS], size[ROWS]}};
+    ei_rect_t rect = cell;
+    if (slave -> fill == EI_FALSE) {
+        rect.size.width = min(widget -> requested_size.width, cell.size.width);
+        rect.size.height = min(widget -> requested_size.height, cell.size.height);
+        rect.top_left = ei_anchor_point(cell, &(slave -> anchor), 0, rect.size);
+    }
+    ei_placer_params_t* params = widget -> placer_params;
+    if (params -> x_data == rect.top_left.x && params -> y_data == rect.top_left.y
+        && params -> w_data == rect.size.width && params -> h_data == rect.size.height) {
+        return;
+    }
+    params -> x_data = rect.top_left.x;
+    params -> y_data = rect.top_left.y;
+    params -> w_data = rect.size.width;
+    params -> h_data = rect.size.height;
+    ei_rect_t old_location = widget -> screen_location;
+    ei_placer_run(widget);
+    if (ei_rect_equal(&old_location, &(widget -> screen_location)) == EI_FALSE) {
+        ei_app_invalidate_rect(&old_location);
+        ei_app_invalidate_rect(&(widget -> screen_location));
+    }
+    STATS.moves ++;
+}
+
+/**
+ * \brief	Places a widget unless it has already been placed by the current layout.
+ */
+static void slave_visit(ei_grid_slave_t* slave){
+    if (slave -> stamp != slave -> master -> stamp) {
+        slave -> stamp = slave -> master -> stamp;
+        slave_place(slave);
+    }
+}
+
+/**
+ * \brief	Measures the marked lines of an axis, then computes the size and the offset of
+ * every line, and marks as moved the lines where they have changed. Only the widgets of
+ * the marked lines are measured.
+ *
+ * @param	force		If EI_TRUE, the axis is computed even without marked lines:
+ *				the size of the master has changed.
+ */
+static void master_solve_axis(ei_grid_master_t* master, int axis, int extent,
+    ei_bool_t force){
+    if (master -> dirty_count[axis] == 0 && force == EI_FALSE) {
+        return;
+    }
+    ei_grid_line_t* lines = master -> lines[axis];
+    int count = master -> count[axis];
+    for (int k = 0; k < master -> dirty_count[axis]; k++) {
+        ei_grid_line_t* line = &(lines[master -> dirty[axis][k]]);
+        int natural = line -> min_size;
+        for (ei_grid_slave_t* slave = line -> slaves; slave != NULL;
+            slave = slave -> next[axis]) {
+            natural = max(natural, slave_request(slave, axis));
+        }
+        line -> natural = natural;
+        line -> dirty = EI_FALSE;
+        STATS.lines_solved ++;
+    }
+    master -> dirty_count[axis] = 0;
+    STATS.axes_solved ++;
+    if (count > SIZES_CAPACITY) {
+        SIZES_CAPACITY = max(count, 2 * SIZES_CAPACITY);
+        SIZES = realloc(SIZES, SIZES_CAPACITY * sizeof(int));
+    }
+    for (int i = 0; i < count; i++) {
+        SIZES[i] = lines[i].natural;
+    }
+    // Un widget sur plusieurs lignes agrandit la derniere s'il n'y tient pas
+    for (ei_grid_slave_t* slave = master -> spanning[axis]; slave != NULL;
+        slave = slave -> next[axis]) {
+        int start = slave -> start[axis];
+        int end = start + slave -> span[axis];
+        int spanned = 0;
+        for (int i = start; i < end; i++) {
+            spanned += SIZES[i];
+        }
+        SIZES[end - 1] += max(0, slave_request(slave, axis) - spanned);
+    }
+    int total = 0;
+    int weights = 0;
+    int last_weighted = -1;
+    for (int i = 0; i < count; i++) {
+        total += SIZES[i];
+        weights += lines[i].weight;
+        if (lines[i].weight > 0) {
+            last_weighted = i;
+        }
+    }
+    // La place qui reste dans le master est partagee selon les poids
+    if (weights > 0 && extent > total) {
+        int extra = extent - total;
+        int given = 0;
+        for (int i = 0; i < count; i++) {
+            int share = (int) ((long) extra * lines[i].weight / weights);
+            SIZES[i] += share;
+            given += share;
+        }
+        SIZES[last_weighted] += extra - given;
+    }
+    int offset = 0;
+    for (int i = 0; i < count; i++) {
+        ei_grid_line_t* line = &(lines[i]);
+        if (line -> size != SIZES[i] || line -> offset != offset) {
+            line -> size = SIZES[i];
+            line -> offset = offset;
+            line -> moved = EI_TRUE;
+        }
+        offset += line -> size;
+    }
+}
+
+/**
+ * \brief	Places the widgets of the lines of an axis that have moved.
+ */
+static void master_move_axis(ei_grid_master_t* master, int axis){
+    ei_grid_line_t* lines = master -> lines[axis];
+    for (int i = 0; i < master -> count[axis]; i++) {
+        if (lines[i].moved == EI_FALSE) {
+            continue;
+        }
+        lines[i].moved = EI_FALSE;
+        for (ei_grid_slave_t* slave = lines[i].slaves; slave != NULL;
+            slave = slave -> next[axis]) {
+            slave_visit(slave);
+        }
+        for (ei_grid_slave_t* slave = master -> spanning[axis]; slave != NULL;
+            slave = slave -> next[axis]) {
+            if (i >= slave -> start[axis] && i < slave -> start[axis] + slave -> span[axis]) {
+                slave_visit(slave);
+            }
+        }
+    }
+}
+
+/**
+ * \brief	Lays out a grid: solves its two axes, then places each widget of a line that
+ * has moved once, and "changed" even if its cell has not moved (its requested size has
+ * changed).
+ */
+static void master_layout(ei_grid_master_t* master, ei_grid_slave_t* changed){
+    ei_rect_t area = ei_placer_area(master -> widget);
+    int extent[2] = {area.size.width, area.size.height};
+    for (int axis = 0; axis < 2; axis++) {
+        ei_bool_t resized = (extent[axis] != master -> extent[axis]) ? EI_TRUE : EI_FALSE;
+        master -> extent[axis] = extent[axis];
+        master_solve_axis(master, axis, extent[axis], resized);
+    }
+    master -> stamp ++;
+    for (int axis = 0; axis < 2; axis++) {
+        master_move_axis(master, axis);
+    }
+    if (changed != NULL) {
+        slave_visit(changed);
+    }
+}
+
+void ei_grid(struct ei_widget_t* widget, int* row, int* column, int* row_span,
+    int* column_span, ei_anchor_t* anchor, ei_bool_t* fill){
+    ei_grid_slave_t* slave = slave_find(widget);
+    if (slave == NULL) {
+        if (widget -> placer_params != NULL) {
+            ei_placer_forget(widget);
+        }
+        ei_place(widget, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+        ei_placer_params_t* params = widget -> placer_params;
+        params -> x = &(params -> x_data);
+        params -> y = &(params -> y_data);
+        params -> w = &(params -> w_data);
+        params -> h = &(params -> h_data);
+        // Pas encore de cellule : le premier placement deplace le widget
+        params -> w_data = -1;
+        slave = calloc(1, sizeof(ei_grid_slave_t));
+        slave -> widget = widget;
+        slave -> master = master_get(widget -> parent);
+        slave -> span[COLUMNS] = 1;
+        slave -> span[ROWS] = 1;
+        slave -> anchor = ei_anc_center;
+        slave -> fill = EI_FALSE;
+        slave -> hash_next = SLAVES[bucket_of(widget)];
+        SLAVES[bucket_of(widget)] = slave;
+        STATS.slaves ++;
+    } else {
+        slave_unlink(slave);
+    }
+    if (row != NULL) {
+        slave -> start[ROWS] = max(0, *row);
+    }
+    if (column != NULL) {
+        slave -> start[COLUMNS] = max(0, *column);
+    }
+    if (row_span != NULL) {
+        slave -> span[ROWS] = max(1, *row_span);
+    }
+    if (column_span != NULL) {
+        slave -> span[COLUMNS] = max(1, *column_span);
+    }
+    if (anchor != NULL) {
+        slave -> anchor = *anchor;
+    }
+    if (fill != NULL) {
+        slave -> fill = *fill;
+    }
+    slave_link(slave);
+    master_layout(slave -> master, slave);
+}
+
+/**
+ * \brief	Configures a line of an axis of a grid, see \ref ei_grid_column_configure.
+ */
+static void line_configure(ei_widget_t* widget, int axis, int index, int* weight,
+    int* min_size){
+    ei_grid_master_t* master = master_get(widget);
+    master_grow(master, axis, index + 1);
+    ei_grid_line_t* line = &(master -> lines[axis][index]);
+    if (weight != NULL) {
+        line -> weight = max(0, *weight);
+    }
+    if (min_size != NULL) {
+        line -> min_size = max(0, *min_size);
+    }
+    master_dirty(master, axis, index);
+    master_layout(master, NULL);
+}
+
+void ei_grid_column_configure(struct ei_widget_t* master, int column, int* weight,
+    int* min_size){
+    line_configure(master, COLUMNS, max(0, column), weight, min_size);
+}
+
+void ei_grid_row_configure(struct ei_widget_t* master, int row, int* weight, int* min_size){
+    line_configure(master, ROWS, max(0, row), weight, min_size);
+}
+
+/**
+ * \brief	Removes a widget from the hash table of the widgets of the grids and frees it.
+ */
+static void slave_free(ei_grid_slave_t* slave){
+    ei_grid_slave_t** link = &SLAVES[bucket_of(slave -> widget)];
+    while (*link != slave) {
+        link = &((*link) -> hash_next);
+    }
+    *link = slave -> hash_next;
+    free(slave);
+    STATS.slaves --;
+}
+
+/**
+ * \brief	Frees a grid and the cells of its widgets, which are not placed again.
+ */
+static void master_free(ei_grid_master_t* master){
+    // Chaque widget est dans une seule liste de l'axe des colonnes
+    for (int i = -1; i < master -> count[COLUMNS]; i++) {
+        ei_grid_slave_t* slave = master -> spanning[COLUMNS];
+        if (i >= 0) {
+            slave = master -> lines[COLUMNS][i].slaves;
+        }
+        while (slave != NULL) {
+            ei_grid_slave_t* next = slave -> next[COLUMNS];
+            slave_free(slave);
+            slave = next;
+        }
+    }
+    for (int axis = 0; axis < 2; axis++) {
+        free(master -> lines[axis]);
+        free(master -> dirty[axis]);
+    }
+    ei_grid_master_t** link = &MASTERS[bucket_of(master -> widget)];
+    while (*link != master) {
+        link = &((*link) -> hash_next);
+    }
+    *link = master -> hash_next;
+    free(master);
+    STATS.masters --;
+}
+
+/**
+ * \brief	Removes a widget from its grid, and places the other widgets of its lines again.
+ */
+static void slave_remove(ei_grid_slave_t* slave){
+    ei_grid_master_t* master = slave -> master;
+    slave_unlink(slave);
+    slave_free(slave);
+    master_layout(master, NULL);
+}
+
+void ei_grid_forget(struct ei_widget_t* widget){
+    ei_grid_slave_t* slave = slave_find(widget);
+    if (slave == NULL) {
+        return;
+    }
+    ei_app_invalidate_rect(&(widget -> screen_location));
+    slave_remove(slave);
+    ei_placer_forget(widget);
+}
+
+ei_bool_t ei_grid_is_managed(struct ei_widget_t* widget){
+    return (slave_find(widget) != NULL) ? EI_TRUE : EI_FALSE;
+}
+
+void ei_grid_update(struct ei_widget_t* widget){
+    ei_grid_slave_t* slave = slave_find(widget);
+    if (slave == NULL) {
+        return;
+    }
+    for (int axis = 0; axis < 2; axis++) {
+        master_dirty(slave -> master, axis, slave -> start[axis]);
+    }
+    master_layout(slave -> master, slave);
+}
+
+void ei_grid_resized(struct ei_widget_t* master){
+    ei_grid_master_t* grid = master_find(master);
+    if (grid != NULL) {
+        master_layout(grid, NULL);
+    }
+}
+
+void ei_grid_release(struct ei_widget_t* widget){
+    ei_grid_master_t* master = master_find(widget);
+    if (master != NULL) {
+        master_free(master);
+    }
+    ei_grid_slave_t* slave = slave_find(widget);
+    if (slave != NULL) {
+        slave_remove(slave);
+    }
+}
+
+void ei_grid_get_stats(ei_grid_stats_t* stats){
+    *stats = STATS;
+}
+
+void ei_grid_free_all(){
+    for (int i = 0; i < BUCKETS; i++) {
+        while (MASTERS[i] != NULL) {
+            master_free(MASTERS[i]);
+        }
+    }
+    free(SIZES);
+    SIZES = NULL;
+    SIZES_CAPACITY = 0;
+}
@@ -0,0 +1,527 @@
+/**
+ *  @file	ei_image.c
+ *  @brief	Registry of the images loaded from files: an image is decoded once by
+ *		\ref hw_image_load and shared by all the widgets that display it. The images that
+ *		are no longer used are kept within a memory budget, and the least recently used
+ *		ones are freed first. The images can also be decoded by a loader thread, a
+ *		placeholder being displayed until they arrive.
+ *
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include "ei_image.h"
+#include "ei_application.h"
+#include "ei_all_widgets.h"
+#include "ei_scale.h"
+#include "ei_layer.h"
+
+/* Nombre de listes des tables, une puissance de 2 */
+#define BUCKETS		128
+
+/**
+ * \brief	An image of the registry. It is in the table of the paths and in the table
+ * of the surfaces. Without reference, it is also in the list of the unused images, the
+ * most recently used first. An image loaded by \ref ei_image_acquire_async also has a
+ * placeholder, in the table of the placeholders, and no surface until it is decoded: the
+ * widgets that display the placeholder are kept to be given the image then.
+ */
+typedef struct ei_image_t {
+    char*			filename;
+    uint32_t			hash;
+    ei_surface_t		surface;
+    ei_surface_t		placeholder;
+    size_t			bytes;
+    int				references;
+    /* Vrai tant que le thread de chargement n'a pas ete pris en compte */
+    ei_bool_t			loading;
+    /* Resultat du thread de chargement, protege par LOCK */
+    ei_surface_t		decoded;
+    ei_bool_t			decoded_done;
+    /* Widgets qui affichent le placeholder */
+    ei_widget_t**		holders;
+    int				holder_count;
+    int				holder_size;
+    struct ei_image_t*		next_path;
+    struct ei_image_t*		next_surface;
+    struct ei_image_t*		next_placeholder;
+    struct ei_image_t*		prev_unused;
+    struct ei_image_t*		next_unused;
+    struct ei_image_t*		next_loading;
+    struct ei_image_t*		next_queued;
+} ei_image_t;
+
+static ei_image_t* PATHS[BUCKETS];
+static ei_image_t* SURFACES[BUCKETS];
+static ei_image_t* PLACEHOLDERS[BUCKETS];
+/* Images en cours de chargement, vues par le thread principal */
+static ei_image_t* LOADING = NULL;
+/* Images sans reference, de la plus recente a la plus ancienne */
+static ei_image_t* UNUSED_HEAD = NULL;
+static ei_image_t* UNUSED_TAIL = NULL;
+static size_t BUDGET = EI_IMAGE_DEFAULT_BUDGET;
+static ei_image_stats_t STATS;
+
+/* File du thread de chargement */
+static pthread_mutex_t LOCK = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t WORK = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t DECODED = PTHREAD_COND_INITIALIZER;
+static ei_image_t* QUEUE_HEAD = NULL;
+static ei_image_t* QUEUE_TAIL = NULL;
+static pthread_t LOADER;
+static ei_bool_t LOADER_STARTED = EI_FALSE;
+static ei_bool_t QUIT = EI_FALSE;
+static ei_surface_t ROOT_SURFACE = NULL;
+
+static uint32_t path_hash(const char* filename){
+    uint32_t hash = 2166136261u;
+    for (const char* c = filename; *c != '\0'; c++) {
+        hash ^= (unsigned char) *c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t surface_hash(ei_surface_t surface){
+    uintptr_t address = (uintptr_t) surface;
+    return (uint32_t) ((address >> 4) ^ (address >> 12));
+}
+
+static ei_image_t* find_surface(ei_surface_t surface){
+    if (surface == NULL) {
+        return NULL;
+    }
+    ei_image_t* image = SURFACES[surface_hash(surface) & (BUCKETS - 1)];
+    while (image != NULL && image -> surface != surface) {
+        image = image -> next_surface;
+    }
+    if (image == NULL) {
+        image = PLACEHOLDERS[surface_hash(surface) & (BUCKETS - 1)];
+        while (image != NULL && image -> placeholder != surface) {
+            image = image -> next_placeholder;
+        }
+    }
+    return image;
+}
+
+static ei_image_t* find_path(const char* filename, uint32_t hash){
+    ei_image_t* image = PATHS[hash & (BUCKETS - 1)];
+    while (image != NULL
+        && (image -> hash != hash || strcmp(image -> filename, filename) != 0)) {
+        image = image -> next_path;
+    }
+    return image;
+}
+
+/**
+ * \brief	Creates an image without surface and adds it to the table of the paths.
+ */
+static ei_image_t* image_create(const char* filename, uint32_t hash){
+    ei_image_t* image = calloc(1, sizeof(ei_image_t));
+    image -> filename = malloc(strlen(filename) + 1);
+    strcpy(image -> filename, filename);
+    image -> hash = hash;
+    image -> next_path = PATHS[hash & (BUCKETS - 1)];
+    PATHS[hash & (BUCKETS - 1)] = image;
+    STATS.images ++;
+    return image;
+}
+
+static void image_set_surface(ei_image_t* image, ei_surface_t surface){
+    image -> surface = surface;
+    ei_size_t size = hw_surface_get_size(surface);
+    image -> bytes = (size_t) size.width * size.height * 4;
+    image -> next_surface = SURFACES[surface_hash(surface) & (BUCKETS - 1)];
+    SURFACES[surface_hash(surface) & (BUCKETS - 1)] = image;
+    STATS.bytes += image -> bytes;
+}
+
+static void unused_remove(ei_image_t* image){
+    if (image -> prev_unused != NULL) {
+        image -> prev_unused -> next_unused = image -> next_unused;
+    } else {
+        UNUSED_HEAD = image -> next_unused;
+    }
+    if (image -> next_unused != NULL) {
+        image -> next_unused -> prev_unused = image -> prev_unused;
+    } else {
+        UNUSED_TAIL = image -> prev_unused;
+    }
+    image -> prev_unused = NULL;
+    image -> next_unused = NULL;
+    STATS.unused --;
+    STATS.unused_bytes -= image -> bytes;
+}
+
+static void unused_push(ei_image_t* image){
+    image -> prev_unused = NULL;
+    image -> next_unused = UNUSED_HEAD;
+    if (UNUSED_HEAD != NULL) {
+        UNUSED_HEAD -> prev_unused = image;
+    } else {
+        UNUSED_TAIL = image;
+    }
+    UNUSED_HEAD = image;
+    STATS.unused ++;
+    STATS.unused_bytes += image -> bytes;
+}
+
+/**
+ * \brief	Removes an image from the registry and frees its surface.
+ */
+static void image_free(ei_image_t* image){
+    ei_image_t** link = &(PATHS[image -> hash & (BUCKETS - 1)]);
+    while (*link != image) {
+        link = &((*link) -> next_path);
+    }
+    *link = image -> next_path;
+    if (image -> surface != NULL) {
+        link = &(SURFACES[surface_hash(image -> surface) & (BUCKETS - 1)]);
+        while (*link != image) {
+            link = &((*link) -> next_surface);
+        }
+        *link = image -> next_surface;
+        ei_scale_forget(image -> surface);
+        ei_layer_set_premultiplied(image -> surface, EI_FALSE);
+        hw_surface_free(image -> surface);
+    }
+    if (image -> placeholder != NULL) {
+        link = &(PLACEHOLDERS[surface_hash(image -> placeholder) & (BUCKETS - 1)]);
+        while (*link != image) {
+            link = &((*link) -> next_placeholder);
+        }
+        *link = image -> next_placeholder;
+        hw_surface_free(image -> placeholder);
+    }
+    // Une image decodee apres l'arret de l'application n'a jamais ete prise en compte
+    if (image -> loading == EI_TRUE && image -> decoded != NULL) {
+        ei_layer_set_premultiplied(image -> decoded, EI_FALSE);
+        hw_surface_free(image -> decoded);
+    }
+    STATS.images --;
+    STATS.bytes -= image -> bytes;
+    free(image -> holders);
+    free(image -> filename);
+    free(image);
+}
+
+/**
+ * \brief	Frees the least recently used images until the unused ones fit in the budget.
+ */
+static void enforce_budget(){
+    while (UNUSED_TAIL != NULL && STATS.unused_bytes > BUDGET) {
+        ei_image_t* image = UNUSED_TAIL;
+        unused_remove(image);
+        image_free(image);
+        STATS.evictions ++;
+    }
+}
+
+/**
+ * \brief	Adds a widget to the ones that display the placeholder of an image.
+ */
+static void holder_add(ei_image_t* image, ei_widget_t* holder){
+    if (image -> holder_count == image -> holder_size) {
+        image -> holder_size = (image -> holder_size == 0) ? 4 : 2 * image -> holder_size;
+        image -> holders = realloc(image -> holders,
+            image -> holder_size * sizeof(ei_widget_t*));
+    }
+    image -> holders[image -> holder_count] = holder;
+    image -> holder_count ++;
+}
+
+static void holder_remove(ei_image_t* image, ei_widget_t* holder){
+    for (int i = 0; i < image -> holder_count; i++) {
+        if (image -> holders[i] == holder) {
+            image -> holder_count --;
+            image -> holders[i] = image -> holders[image -> holder_count];
+            return;
+        }
+    }
+}
+
+/**
+ * \brief	Gives to the widgets displaying the placeholder of an image the surface that
+ * replaces it. The configure functions update their size and redraw them.
+ */
+static void holders_replace(ei_image_t* image, ei_surface_t surface){
+    // Les configure rendent le placeholder : la liste est detachee avant
+    ei_widget_t** holders = image -> holders;
+    int count = image -> holder_count;
+    image -> holders = NULL;
+    image -> holder_count = 0;
+    image -> holder_size = 0;
+    for (int i = 0; i < count; i++) {
+        ei_widget_t* widget = holders[i];
+        if (ei_widget_is(widget, ei_class_frame) == EI_TRUE
+            && ((ei_frame_t*) widget) -> img == image -> placeholder) {
+            ei_frame_configure(widget, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                &surface, NULL, NULL);
+        } else if (ei_widget_is(widget, ei_class_button) == EI_TRUE
+            && ((ei_button_t*) widget) -> img == image -> placeholder) {
+            ei_button_configure(widget, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                NULL, &surface, NULL, NULL, NULL, NULL);
+        }
+    }
+    free(holders);
+}
+
+/**
+ * \brief	Takes into account an image decoded by the loader thread. Called by the main
+ * thread only.
+ */
+static void image_loaded(ei_image_t* image){
+    ei_image_t** link = &LOADING;
+    while (*link != image) {
+        link = &((*link) -> next_loading);
+    }
+    *link = image -> next_loading;
+    pthread_mutex_lock(&LOCK);
+    ei_surface_t surface = image -> decoded;
+    pthread_mutex_unlock(&LOCK);
+    image -> decoded = NULL;
+    image -> loading = EI_FALSE;
+    STATS.loading --;
+    if (surface != NULL) {
+        image_set_surface(image, surface);
+        holders_replace(image, surface);
+    }
+    if (image -> references == 0) {
+        unused_push(image);
+        enforce_budget();
+    }
+}
+
+/**
+ * \brief	Waits until the loader thread has decoded an image, then takes it into account.
+ */
+static void image_wait(ei_image_t* image){
+    pthread_mutex_lock(&LOCK);
+    while (image -> decoded_done == EI_FALSE) {
+        pthread_cond_wait(&DECODED, &LOCK);
+    }
+    pthread_mutex_unlock(&LOCK);
+    image_loaded(image);
+}
+
+/**
+ * \brief	Decodes the images of the queue, one after the other, and tells the main
+ * thread with an application event.
+ */
+static void* loader_main(void* param){
+    pthread_mutex_lock(&LOCK);
+    while (QUIT == EI_FALSE) {
+        if (QUEUE_HEAD == NULL) {
+            pthread_cond_wait(&WORK, &LOCK);
+            continue;
+        }
+        ei_image_t* image = QUEUE_HEAD;
+        QUEUE_HEAD = image -> next_queued;
+        if (QUEUE_HEAD == NULL) {
+            QUEUE_TAIL = NULL;
+        }
+        ei_surface_t root = ROOT_SURFACE;
+        pthread_mutex_unlock(&LOCK);
+        // Le nom n'est libere qu'apres l'arret de ce thread
+        ei_surface_t surface = hw_image_load(image -> filename, root);
+        // La conversion est faite ici aussi, hors du thread principal
+        ei_layer_premultiply(surface);
+        pthread_mutex_lock(&LOCK);
+        image -> decoded = surface;
+        image -> decoded_done = EI_TRUE;
+        pthread_cond_broadcast(&DECODED);
+        pthread_mutex_unlock(&LOCK);
+        // La file d'evenements peut etre pleine : on reessaie un peu plus tard
+        struct timespec delay = {0, 1000000};
+        while (hw_event_post_app(image) < 0 && QUIT == EI_FALSE) {
+            nanosleep(&delay, NULL);
+        }
+        pthread_mutex_lock(&LOCK);
+    }
+    pthread_mutex_unlock(&LOCK);
+    return NULL;
+}
+
+ei_surface_t ei_image_acquire(const char* filename){
+    uint32_t hash = path_hash(filename);
+    ei_image_t* image = find_path(filename, hash);
+    if (image != NULL) {
+        if (image -> loading == EI_TRUE) {
+            image_wait(image);
+        }
+        if (image -> surface == NULL) {
+            // Le chargement en arriere-plan a echoue
+            return NULL;
+        }
+        if (image -> references == 0) {
+            unused_remove(image);
+        }
+        image -> references ++;
+        STATS.hits ++;
+        return image -> surface;
+    }
+    ei_surface_t surface = hw_image_load(filename, ei_app_root_surface());
+    STATS.loads ++;
+    if (surface == NULL) {
+        return NULL;
+    }
+    ei_layer_premultiply(surface);
+    image = image_create(filename, hash);
+    image_set_surface(image, surface);
+    image -> references = 1;
+    return surface;
+}
+
+ei_surface_t ei_image_acquire_async(const char* filename){
+    uint32_t hash = path_hash(filename);
+    ei_image_t* image = find_path(filename, hash);
+    if (image != NULL) {
+        if (image -> references == 0 && image -> loading == EI_FALSE) {
+            unused_remove(image);
+        }
+        image -> references ++;
+        STATS.hits ++;
+        return (image -> surface != NULL) ? image -> surface : image -> placeholder;
+    }
+    image = image_create(filename, hash);
+    ei_size_t size = {1, 1};
+    image -> placeholder = hw_surface_create(ei_app_root_surface(), &size, EI_TRUE);
+    image -> next_placeholder = PLACEHOLDERS[surface_hash(image -> placeholder)
+        & (BUCKETS - 1)];
+    PLACEHOLDERS[surface_hash(image -> placeholder) & (BUCKETS - 1)] = image;
+    image -> references = 1;
+    image -> loading = EI_TRUE;
+    image -> next_loading = LOADING;
+    LOADING = image;
+    STATS.loads ++;
+    STATS.loading ++;
+    pthread_mutex_lock(&LOCK);
+    ROOT_SURFACE = ei_app_root_surface();
+    if (QUEUE_TAIL != NULL) {
+        QUEUE_TAIL -> next_queued = image;
+    } else {
+        QUEUE_HEAD = image;
+    }
+    QUEUE_TAIL = image;
+    QUIT = EI_FALSE;
+    if (LOADER_STARTED == EI_FALSE
+        && pthread_create(&LOADER, NULL, loader_main, NULL) == 0) {
+        LOADER_STARTED = EI_TRUE;
+    }
+    pthread_cond_signal(&WORK);
+    ei_bool_t started = LOADER_STARTED;
+    pthread_mutex_unlock(&LOCK);
+    if (started == EI_FALSE) {
+        // Sans thread, l'image est chargee tout de suite
+        pthread_mutex_lock(&LOCK);
+        QUEUE_HEAD = NULL;
+        QUEUE_TAIL = NULL;
+        image -> decoded = hw_image_load(filename, ei_app_root_surface());
+        ei_layer_premultiply(image -> decoded);
+        image -> decoded_done = EI_TRUE;
+        pthread_mutex_unlock(&LOCK);
+        image_loaded(image);
+        if (image -> surface != NULL) {
+            return image -> surface;
+        }
+    }
+    return image -> placeholder;
+}
+
+ei_bool_t ei_image_is_placeholder(ei_surface_t surface){
+    ei_image_t* image = find_surface(surface);
+    if (image == NULL || image -> placeholder != surface) {
+        return EI_FALSE;
+    }
+    return EI_TRUE;
+}
+
+ei_bool_t ei_image_handle_event(ei_event_t* event){
+    if (event -> type != ei_ev_app) {
+        return EI_FALSE;
+    }
+    ei_image_t* image = LOADING;
+    while (image != NULL && (void*) image != event -> param.application.user_param) {
+        image = image -> next_loading;
+    }
+    if (image == NULL) {
+        // Image deja prise en compte par ei_image_acquire, ou evenement d'un autre module
+        return EI_FALSE;
+    }
+    image_wait(image);
+    return EI_TRUE;
+}
+
+ei_bool_t ei_image_retain(ei_surface_t surface, ei_widget_t* holder){
+    ei_image_t* image = find_surface(surface);
+    if (image == NULL) {
+        return EI_FALSE;
+    }
+    if (image -> references == 0 && image -> loading == EI_FALSE) {
+        unused_remove(image);
+    }
+    image -> references ++;
+    if (holder != NULL && surface == image -> placeholder && image -> loading == EI_TRUE) {
+        holder_add(image, holder);
+    }
+    return EI_TRUE;
+}
+
+void ei_image_release_holder(ei_surface_t surface, ei_widget_t* holder){
+    ei_image_t* image = find_surface(surface);
+    if (image == NULL || image -> references == 0) {
+        return;
+    }
+    if (holder != NULL && surface == image -> placeholder) {
+        holder_remove(image, holder);
+    }
+    image -> references --;
+    if (image -> references == 0 && image -> loading == EI_FALSE) {
+        unused_push(image);
+        enforce_budget();
+    }
+}
+
+void ei_image_release(ei_surface_t surface){
+    ei_image_release_holder(surface, NULL);
+}
+
+void ei_image_set_budget(size_t bytes){
+    BUDGET = bytes;
+    enforce_budget();
+}
+
+void ei_image_get_stats(ei_image_stats_t* stats){
+    *stats = STATS;
+}
+
+void ei_image_free_all(){
+    if (LOADER_STARTED == EI_TRUE) {
+        pthread_mutex_lock(&LOCK);
+        QUIT = EI_TRUE;
+        pthread_cond_signal(&WORK);
+        pthread_mutex_unlock(&LOCK);
+        pthread_join(LOADER, NULL);
+        LOADER_STARTED = EI_FALSE;
+    }
+    QUEUE_HEAD = NULL;
+    QUEUE_TAIL = NULL;
+    LOADING = NULL;
+    for (int i = 0; i < BUCKETS; i++) {
+        while (PATHS[i] != NULL) {
+            ei_image_t* image = PATHS[i];
+            if (image -> references == 0 && image -> loading == EI_FALSE) {
+                unused_remove(image);
+            }
+            image_free(image);
+        }
+    }
+    UNUSED_HEAD = NULL;
+    UNUSED_TAIL = NULL;
+    STATS.loading = 0;
+}
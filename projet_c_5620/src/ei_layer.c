@@ -0,0 +1,191 @@
+/**
+ *  @file	ei_layer.c
+ *  @brief	Premultiplied alpha surfaces, and the layers where the translucent widgets are
+ *		drawn before being blended. The premultiplied surfaces are kept in a small hash
+ *		table, the free layers in a list: the tiles of the renderer take and give back
+ *		layers from several threads. The list keeps one layer per thread of the pool,
+ *		the others are freed when they are given back.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "ei_layer.h"
+#include "ei_draw.h"
+#include "ei_draw_extension.h"
+#include "ei_pool.h"
+
+#define BUCKETS		64
+
+/**
+ * \brief	A surface marked as premultiplied.
+ */
+typedef struct ei_marked_t {
+    ei_surface_t	surface;
+    struct ei_marked_t*	next;
+} ei_marked_t;
+
+/**
+ * \brief	A layer that is not in use.
+ */
+typedef struct ei_free_layer_t {
+    ei_surface_t		surface;
+    struct ei_free_layer_t*	next;
+} ei_free_layer_t;
+
+static ei_marked_t* MARKED[BUCKETS];
+static int MARKED_COUNT = 0;
+static ei_free_layer_t* FREE_LAYERS = NULL;
+static int FREE_COUNT = 0;
+static int LAYER_COUNT = 0;
+static unsigned long CREATED = 0;
+static unsigned long REUSED = 0;
+static pthread_mutex_t LOCK = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned int bucket_of(ei_surface_t surface){
+    uintptr_t key = (uintptr_t) surface;
+    return (unsigned int) ((key >> 4) ^ (key >> 12)) % BUCKETS;
+}
+
+void ei_layer_set_premultiplied(ei_surface_t surface, ei_bool_t premultiplied){
+    if (surface == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&LOCK);
+    ei_marked_t** link = &MARKED[bucket_of(surface)];
+    while (*link != NULL && (*link) -> surface != surface) {
+        link = &((*link) -> next);
+    }
+    if (premultiplied == EI_TRUE && *link == NULL) {
+        ei_marked_t* marked = malloc(sizeof(ei_marked_t));
+        marked -> surface = surface;
+        marked -> next = NULL;
+        *link = marked;
+        MARKED_COUNT ++;
+    } else if (premultiplied == EI_FALSE && *link != NULL) {
+        ei_marked_t* marked = *link;
+        *link = marked -> next;
+        free(marked);
+        MARKED_COUNT --;
+    }
+    pthread_mutex_unlock(&LOCK);
+}
+
+ei_bool_t ei_layer_is_premultiplied(ei_surface_t surface){
+    if (surface == NULL || hw_surface_has_alpha(surface) == EI_FALSE) {
+        return EI_FALSE;
+    }
+    ei_bool_t found = EI_FALSE;
+    pthread_mutex_lock(&LOCK);
+    for (ei_marked_t* marked = MARKED[bucket_of(surface)]; marked != NULL;
+        marked = marked -> next) {
+        if (marked -> surface == surface) {
+            found = EI_TRUE;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&LOCK);
+    return found;
+}
+
+void ei_layer_premultiply(ei_surface_t surface){
+    if (surface == NULL || hw_surface_has_alpha(surface) == EI_FALSE
+        || ei_layer_is_premultiplied(surface) == EI_TRUE) {
+        return;
+    }
+    int ir, ig, ib, ia;
+    hw_surface_get_channel_indices(surface, &ir, &ig, &ib, &ia);
+    ei_size_t size = hw_surface_get_size(surface);
+    hw_surface_lock(surface);
+    ei_premultiply_pixels((uint32_t*) hw_surface_get_buffer(surface),
+        (size_t) size.width * size.height, ia);
+    hw_surface_unlock(surface);
+    ei_layer_set_premultiplied(surface, EI_TRUE);
+}
+
+ei_surface_t ei_layer_begin(ei_surface_t surface, const ei_rect_t* clipper){
+    ei_size_t size = hw_surface_get_size(surface);
+    ei_surface_t layer = NULL;
+    pthread_mutex_lock(&LOCK);
+    ei_free_layer_t** link = &FREE_LAYERS;
+    while (*link != NULL) {
+        ei_size_t layer_size = hw_surface_get_size((*link) -> surface);
+        if (layer_size.width == size.width && layer_size.height == size.height) {
+            ei_free_layer_t* free_layer = *link;
+            *link = free_layer -> next;
+            layer = free_layer -> surface;
+            free(free_layer);
+            FREE_COUNT --;
+            REUSED ++;
+            break;
+        }
+        link = &((*link) -> next);
+    }
+    if (layer == NULL) {
+        CREATED ++;
+        LAYER_COUNT ++;
+    }
+    pthread_mutex_unlock(&LOCK);
+    if (layer == NULL) {
+        layer = hw_surface_create(surface, &size, EI_TRUE);
+        ei_layer_set_premultiplied(layer, EI_TRUE);
+    }
+    // Seule la zone dessinee doit etre transparente
+    ei_color_t transparent = {0, 0, 0, 0};
+    ei_fill(layer, &transparent, clipper);
+    return layer;
+}
+
+void ei_layer_end(ei_surface_t surface, ei_surface_t layer, const ei_rect_t* clipper){
+    ei_copy_surface(surface, clipper, layer, clipper, EI_TRUE);
+    // Chaque thread ne dessine qu'un calque a la fois : les calques en trop,
+    // crees par un pic ou avant que le pool ne perde des threads, sont liberes
+    int kept = ei_pool_get_threads();
+    pthread_mutex_lock(&LOCK);
+    if (FREE_COUNT < kept) {
+        ei_free_layer_t* free_layer = malloc(sizeof(ei_free_layer_t));
+        free_layer -> surface = layer;
+        free_layer -> next = FREE_LAYERS;
+        FREE_LAYERS = free_layer;
+        FREE_COUNT ++;
+        layer = NULL;
+    } else {
+        LAYER_COUNT --;
+    }
+    pthread_mutex_unlock(&LOCK);
+    if (layer != NULL) {
+        ei_layer_set_premultiplied(layer, EI_FALSE);
+        hw_surface_free(layer);
+    }
+}
+
+void ei_layer_get_stats(ei_layer_stats_t* stats){
+    pthread_mutex_lock(&LOCK);
+    stats -> premultiplied = MARKED_COUNT;
+    stats -> layers = LAYER_COUNT;
+    stats -> created = CREATED;
+    stats -> reused = REUSED;
+    pthread_mutex_unlock(&LOCK);
+}
+
+void ei_layer_free_all(){
+    pthread_mutex_lock(&LOCK);
+    while (FREE_LAYERS != NULL) {
+        ei_free_layer_t* next = FREE_LAYERS -> next;
+        hw_surface_free(FREE_LAYERS -> surface);
+        free(FREE_LAYERS);
+        FREE_LAYERS = next;
+    }
+    for (int i = 0; i < BUCKETS; i++) {
+        while (MARKED[i] != NULL) {
+            ei_marked_t* next = MARKED[i] -> next;
+            free(MARKED[i]);
+            MARKED[i] = next;
+        }
+    }
+    MARKED_COUNT = 0;
+    FREE_COUNT = 0;
+    LAYER_COUNT = 0;
+    pthread_mutex_unlock(&LOCK);
+}
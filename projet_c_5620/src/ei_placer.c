@@ -18,6 +18,9 @@
 #include "ei_widget_frame.h"
 #include "ei_widget_button.h"
 #include "ei_widget_toplevel.h"
+#include "ei_widget_scrollframe.h"
+#include "ei_grid.h"
+#include "ei_application.h"
 
 /**
  * \brief	Configures the geometry of a widget using the "placer" geometry manager.
@@ -51,6 +54,10 @@
 #define max(a,b) ((a) > (b) ? a : b)
 #define min(a,b) ((a) < (b) ? a : b)
 
+/* Vrai si un widget attend la passe de disposition */
+static ei_bool_t PENDING = EI_FALSE;
+static ei_placer_stats_t STATS;
+
 void			ei_place			(struct ei_widget_t*	widget,
         ei_anchor_t*		anchor,
         int*			x,
@@ -62,73 +69,141 @@ void			ei_place			(struct ei_widget_t*	widget,
         float*			rel_width,
         float*			rel_height)
 {
-    widget -> placer_params = calloc(1, sizeof(ei_placer_params_t));
-    if (anchor != NULL) {
-        widget -> placer_params -> anchor = anchor;
-        widget -> placer_params -> anchor_data = *anchor;
-    }
-    else{
-        widget -> placer_params -> anchor_data = ei_anc_none;
+    if (ei_grid_is_managed(widget) == EI_TRUE) {
+        ei_grid_forget(widget);
     }
-    if (x != NULL) {
-        widget -> placer_params -> x = x;
-        widget -> placer_params -> x_data = *x;
-    }
-    else{
-        widget -> placer_params -> x_data = 0;
+    // Les parametres sont alloues au premier placement seulement, puis mis a jour
+    ei_placer_params_t* params = widget -> placer_params;
+    if (params == NULL) {
+        params = calloc(1, sizeof(ei_placer_params_t));
+        params -> anchor_data = ei_anc_none;
+        // Un widget oublie a perdu la marque de ses descendants en attente : la passe
+        // descend une fois dans ses enfants, et efface les marques restees en dessous
+        params -> children_dirty = (widget -> children_head != NULL) ? EI_TRUE : EI_FALSE;
+        widget -> placer_params = params;
     }
-    if (y != NULL) {
-        widget -> placer_params -> y = y;
-        widget -> placer_params -> y_data = *y;
+    STATS.placements ++;
+    if (params -> dirty == EI_TRUE) {
+        STATS.coalesced ++;
     }
-    else{
-        widget -> placer_params -> y_data = 0;
+    if (anchor != NULL) {
+        params -> anchor = &(params -> anchor_data);
+        params -> anchor_data = *anchor;
     }
-    if (height != NULL) {
-        widget -> placer_params -> h = height;
-        widget -> placer_params -> h_data = *height;
+    if (x != NULL) {
+        params -> x = &(params -> x_data);
+        params -> x_data = *x;
     }
-    else{
-        widget -> placer_params -> h_data = (widget -> requested_size).height;
+    if (y != NULL) {
+        params -> y = &(params -> y_data);
+        params -> y_data = *y;
     }
     if (width != NULL) {
-        widget -> placer_params -> w = width;
-        widget -> placer_params -> w_data = *width;
+        params -> w = &(params -> w_data);
+        params -> w_data = *width;
+    } else if (params -> w == NULL) {
+        params -> w_data = (widget -> requested_size).width;
     }
-    else{
-        widget -> placer_params -> w_data = (widget -> requested_size).width;
+    if (height != NULL) {
+        params -> h = &(params -> h_data);
+        params -> h_data = *height;
+    } else if (params -> h == NULL) {
+        params -> h_data = (widget -> requested_size).height;
     }
     if (rel_x != NULL) {
-        widget -> placer_params -> rx = rel_x;
-        widget -> placer_params -> rx_data = *rel_x;
-    }
-    else{
-        widget -> placer_params -> rx_data = 0;
+        params -> rx = &(params -> rx_data);
+        params -> rx_data = *rel_x;
     }
     if (rel_y != NULL) {
-        widget -> placer_params -> ry = rel_y;
-        widget -> placer_params -> ry_data = *rel_y;
+        params -> ry = &(params -> ry_data);
+        params -> ry_data = *rel_y;
     }
-    else{
-        widget -> placer_params -> ry_data = 0;
+    if (rel_width != NULL) {
+        params -> rw = &(params -> rw_data);
+        params -> rw_data = *rel_width;
     }
     if (rel_height != NULL) {
-        widget -> placer_params -> rh = rel_height;
-        widget -> placer_params -> rh_data = *rel_height;
+        params -> rh = &(params -> rh_data);
+        params -> rh_data = *rel_height;
     }
-    else{
-        widget -> placer_params -> rh_data = 0;
+    // Le placement est applique par la passe de disposition de la prochaine frame
+    ei_placer_invalidate(widget);
+}
+
+void ei_placer_invalidate(struct ei_widget_t* widget){
+    if (widget -> placer_params == NULL) {
+        return;
     }
-    if (rel_width != NULL) {
-        widget -> placer_params -> rw = rel_width;
-        widget -> placer_params -> rw_data = *rel_width;
+    widget -> placer_params -> dirty = EI_TRUE;
+    // Les ancetres savent qu'un descendant est a replacer, la passe ne descend que la
+    for (ei_widget_t* parent = widget -> parent; parent != NULL
+        && parent -> placer_params != NULL
+        && parent -> placer_params -> children_dirty == EI_FALSE;
+        parent = parent -> parent) {
+        parent -> placer_params -> children_dirty = EI_TRUE;
+    }
+    PENDING = EI_TRUE;
+}
+
+/**
+ * \brief	Places the children of a widget that are marked, and goes down in the children
+ * that have a marked descendant. A widget that has moved is damaged.
+ */
+static void placer_layout(ei_widget_t* widget){
+    for (ei_widget_t* child = widget -> children_head; child != NULL;
+        child = child -> next_sibling) {
+        ei_placer_params_t* params = child -> placer_params;
+        if (params == NULL) {
+            continue;
+        }
+        if (params -> dirty == EI_TRUE) {
+            ei_rect_t old_location = child -> screen_location;
+            ei_placer_run(child);
+            if (ei_rect_equal(&old_location, &(child -> screen_location)) == EI_FALSE) {
+                ei_app_invalidate_rect(&old_location);
+                ei_app_invalidate_rect(&(child -> screen_location));
+            }
+        }
+        if (params -> children_dirty == EI_TRUE) {
+            params -> children_dirty = EI_FALSE;
+            placer_layout(child);
+        }
     }
-    else{
-        widget -> placer_params -> rw_data = 0;
+}
+
+void ei_placer_flush(){
+    if (PENDING == EI_FALSE) {
+        return;
     }
+    PENDING = EI_FALSE;
+    STATS.passes ++;
+    ei_widget_t* root = ei_app_root_widget();
+    root -> placer_params -> children_dirty = EI_FALSE;
+    placer_layout(root);
+}
+
+ei_bool_t ei_placer_pending(){
+    return PENDING;
+}
+
+void ei_placer_get_stats(ei_placer_stats_t* stats){
+    *stats = STATS;
 }
 
 
+/**
+ * \brief	Returns the rectangle in which the children of a widget are placed, before the
+ * title bar of a toplevel is taken into account.
+ */
+static ei_rect_t placer_content(ei_widget_t* widget){
+    // Dans un scrollframe, les enfants sont places dans le contenu, decale par le defilement
+    if (ei_widget_is(widget, ei_class_scrollframe) == EI_TRUE
+        || ei_widget_is(widget, ei_class_listbox) == EI_TRUE) {
+        return ei_scrollframe_content_area(widget);
+    }
+    return widget -> screen_location;
+}
+
 /**
  * \brief	Tells the placer to recompute the geometry of a widget.
  *		The widget must have been previsouly placed by a call to \ref ei_place.
@@ -148,29 +223,34 @@ void ei_placer_run(struct ei_widget_t* widget){
     float			rel_width = (widget -> placer_params) -> rw_data;
     float 		rel_height = (widget -> placer_params) -> rh_data;
     ei_rect_t* rect_widget = &(widget -> screen_location);
+    ei_rect_t old_location = *rect_widget;
+    (widget -> placer_params) -> dirty = EI_FALSE;
+    STATS.runs ++;
+    ei_rect_t parent_area = placer_content(widget -> parent);
+    (widget -> placer_params) -> origin = parent_area.top_left;
     //===============================Managing rect size========================
     if (width < 0 ) {
-      (rect_widget -> size).width = (((widget -> parent) -> screen_location).size.width) * (rel_width) + width;
+      (rect_widget -> size).width = (parent_area.size.width) * (rel_width) + width;
     } else {
-      (rect_widget -> size).width = max((((widget -> parent) -> screen_location).size.width) * (rel_width), width);
+      (rect_widget -> size).width = max((parent_area.size.width) * (rel_width), width);
     }
     if (height < 0) {
-      (rect_widget -> size).height = (((widget -> parent) -> screen_location).size.height) * (rel_height) + height;
+      (rect_widget -> size).height = (parent_area.size.height) * (rel_height) + height;
     } else {
-      (rect_widget -> size).height = max((((widget -> parent) -> screen_location).size.height) * (rel_height), height);
+      (rect_widget -> size).height = max((parent_area.size.height) * (rel_height), height);
     }
     //===============================Managing anchor========================
     ei_point_t point_ancre;
-    int parent_height = ((widget -> parent) -> screen_location).size.height;
-    if (strcmp(widget -> parent -> wclass -> name, "toplevel") == 0) {
+    int parent_height = parent_area.size.height;
+    if (ei_widget_is(widget -> parent, ei_class_toplevel) == EI_TRUE) {
         ei_toplevel_t* toplevel = (ei_toplevel_t*) widget -> parent;
         if (toplevel -> button_closable != widget) {
             y += 30;
             parent_height -= 30;
         }
     }
-    int parent_width = ((widget -> parent) -> screen_location).size.width;
-    ei_point_t parent_origin = ((widget -> parent) -> screen_location).top_left;
+    int parent_width = parent_area.size.width;
+    ei_point_t parent_origin = parent_area.top_left;
     point_ancre.x = parent_origin.x + parent_width * (rel_x) + x;
     point_ancre.y = parent_origin.y + parent_height * (rel_y) + y;
     switch (anchor) {
@@ -215,7 +295,38 @@ void ei_placer_run(struct ei_widget_t* widget){
         default:
             break;
     }
+    //===============================Picking offscreen========================
+    if (old_location.top_left.x != rect_widget -> top_left.x
+        || old_location.top_left.y != rect_widget -> top_left.y
+        || old_location.size.width != rect_widget -> size.width
+        || old_location.size.height != rect_widget -> size.height) {
+        ei_invalidate_pick_rect(&old_location);
+        ei_invalidate_pick_rect(rect_widget);
+        if (widget -> wclass -> geomnotifyfunc != NULL) {
+            (widget -> wclass -> geomnotifyfunc)(widget, *rect_widget);
+        }
+        // Les enfants suivent le widget : ils sont dans les zones qu'il endommage
+        for (ei_widget_t* child = widget -> children_head; child != NULL;
+            child = child -> next_sibling) {
+            if (child -> placer_params != NULL) {
+                ei_placer_run(child);
+            }
+        }
+        // Les enfants places par la grille se partagent la nouvelle taille
+        if (old_location.size.width != rect_widget -> size.width
+            || old_location.size.height != rect_widget -> size.height) {
+            ei_grid_resized(widget);
+        }
+    }
+}
 
+ei_rect_t ei_placer_area(struct ei_widget_t* widget){
+    ei_rect_t area = placer_content(widget);
+    if (ei_widget_is(widget, ei_class_toplevel) == EI_TRUE) {
+        area.top_left.y += 30;
+        area.size.height = max(0, area.size.height - 30);
+    }
+    return area;
 }
 
 /**
@@ -225,5 +336,11 @@ void ei_placer_run(struct ei_widget_t* widget){
  * @param	widget		The widget to remove from screen.
  */
 void ei_placer_forget(struct ei_widget_t* widget){
+    if (ei_grid_is_managed(widget) == EI_TRUE) {
+        ei_grid_forget(widget);
+        return;
+    }
+    ei_invalidate_pick_rect(&(widget -> screen_location));
     free(widget -> placer_params);
+    widget -> placer_params = NULL;
 }
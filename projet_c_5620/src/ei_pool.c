@@ -0,0 +1,254 @@
+/**
+ *  @file	ei_pool.c
+ *  @brief	Pool of worker threads used by the renderer and the drawing primitives. A run
+ *		splits a number of tasks between the workers and the calling thread; a worker
+ *		that has finished its share steals half of the remaining tasks of another one.
+ *
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "ei_pool.h"
+#include "ei_arena.h"
+
+#define max(a,b) ((a) > (b) ? a : b)
+#define min(a,b) ((a) < (b) ? a : b)
+
+#define MAX_THREADS	16
+
+/**
+ * \brief	The tasks left to a thread: the indices from begin to end - 1. The owner
+ * takes them from the beginning, the thieves from the end.
+ */
+typedef struct {
+    pthread_mutex_t	lock;
+    int			begin;
+    int			end;
+} ei_queue_t;
+
+static ei_queue_t QUEUES[MAX_THREADS];
+static pthread_t WORKERS[MAX_THREADS];
+/* Nombre de threads, celui qui lance les taches compris ; 0 tant qu'il n'est pas choisi */
+static int THREADS = 0;
+/* Nombre de workers lances */
+static int STARTED = 0;
+
+static pthread_mutex_t LOCK = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t START = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t DONE = PTHREAD_COND_INITIALIZER;
+static unsigned long GENERATION = 0;
+static ei_bool_t QUIT = EI_FALSE;
+static ei_pool_task_t TASK = NULL;
+static void* USER_PARAM = NULL;
+/* Taches pas encore terminees, et workers encore en train de chercher des taches */
+static int PENDING = 0;
+static int BUSY = 0;
+static ei_pool_stats_t STATS;
+
+/* Vrai dans les workers, et dans le thread appelant pendant un run */
+static __thread ei_bool_t IN_TASK = EI_FALSE;
+
+static ei_bool_t queue_pop(ei_queue_t* queue, int* index){
+    ei_bool_t found = EI_FALSE;
+    pthread_mutex_lock(&(queue -> lock));
+    if (queue -> begin < queue -> end) {
+        *index = queue -> begin;
+        queue -> begin ++;
+        found = EI_TRUE;
+    }
+    pthread_mutex_unlock(&(queue -> lock));
+    return found;
+}
+
+/**
+ * \brief	Moves the second half of the tasks left to another thread in the queue of
+ * the thread id.
+ */
+static ei_bool_t steal(int id){
+    for (int i = 1; i < THREADS; i++) {
+        ei_queue_t* victim = &(QUEUES[(id + i) % THREADS]);
+        int begin = 0;
+        int end = 0;
+        pthread_mutex_lock(&(victim -> lock));
+        if (victim -> begin < victim -> end) {
+            int left = victim -> end - victim -> begin;
+            begin = victim -> end - max(1, left / 2);
+            end = victim -> end;
+            victim -> end = begin;
+        }
+        pthread_mutex_unlock(&(victim -> lock));
+        if (begin < end) {
+            pthread_mutex_lock(&(QUEUES[id].lock));
+            QUEUES[id].begin = begin;
+            QUEUES[id].end = end;
+            pthread_mutex_unlock(&(QUEUES[id].lock));
+            pthread_mutex_lock(&LOCK);
+            STATS.steals ++;
+            pthread_mutex_unlock(&LOCK);
+            return EI_TRUE;
+        }
+    }
+    return EI_FALSE;
+}
+
+/**
+ * \brief	Executes the tasks of the thread id, then the tasks stolen from the others.
+ */
+static void work(int id, ei_pool_task_t task, void* user_param){
+    int index;
+    int done = 0;
+    do {
+        while (queue_pop(&(QUEUES[id]), &index) == EI_TRUE) {
+            // Les temporaires d'une tache sont liberes a la fin de la tache
+            ei_arena_mark_t mark = ei_arena_mark();
+            task(index, user_param);
+            ei_arena_rewind(mark);
+            done ++;
+        }
+    } while (steal(id) == EI_TRUE);
+    pthread_mutex_lock(&LOCK);
+    PENDING -= done;
+    pthread_mutex_unlock(&LOCK);
+}
+
+static void* worker_main(void* param){
+    int id = (int) (long) param;
+    IN_TASK = EI_TRUE;
+    pthread_mutex_lock(&LOCK);
+    unsigned long seen = GENERATION;
+    while (QUIT == EI_FALSE) {
+        if (GENERATION == seen) {
+            pthread_cond_wait(&START, &LOCK);
+            continue;
+        }
+        seen = GENERATION;
+        ei_pool_task_t task = TASK;
+        void* user_param = USER_PARAM;
+        BUSY ++;
+        pthread_mutex_unlock(&LOCK);
+        work(id, task, user_param);
+        pthread_mutex_lock(&LOCK);
+        BUSY --;
+        if (BUSY == 0 && PENDING == 0) {
+            pthread_cond_signal(&DONE);
+        }
+    }
+    pthread_mutex_unlock(&LOCK);
+    // Les temporaires du worker sont dans son arene
+    ei_arena_free();
+    return NULL;
+}
+
+/**
+ * \brief	Launches the workers that are missing.
+ */
+static void pool_start(){
+    static ei_bool_t queues_ready = EI_FALSE;
+    if (queues_ready == EI_FALSE) {
+        for (int i = 0; i < MAX_THREADS; i++) {
+            pthread_mutex_init(&(QUEUES[i].lock), NULL);
+        }
+        queues_ready = EI_TRUE;
+    }
+    QUIT = EI_FALSE;
+    while (STARTED < THREADS - 1) {
+        if (pthread_create(&(WORKERS[STARTED + 1]), NULL, worker_main,
+            (void*) (long) (STARTED + 1)) != 0) {
+            // Sans ce thread, on se contente de ceux qui tournent deja
+            THREADS = STARTED + 1;
+            break;
+        }
+        STARTED ++;
+    }
+}
+
+void ei_pool_run(int count, ei_pool_task_t task, void* user_param){
+    if (count <= 0) {
+        return;
+    }
+    int threads = ei_pool_get_threads();
+    if (count > 1 && threads > 1 && IN_TASK == EI_FALSE && STARTED < threads - 1) {
+        pool_start();
+    }
+    if (count == 1 || THREADS <= 1 || IN_TASK == EI_TRUE) {
+        for (int i = 0; i < count; i++) {
+            ei_arena_mark_t mark = ei_arena_mark();
+            task(i, user_param);
+            ei_arena_rewind(mark);
+        }
+        return;
+    }
+    pthread_mutex_lock(&LOCK);
+    // Un worker reveille en retard par le run precedent ne doit pas prendre ces taches
+    while (BUSY > 0) {
+        pthread_cond_wait(&DONE, &LOCK);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_mutex_lock(&(QUEUES[i].lock));
+        QUEUES[i].begin = (int) ((long) count * i / THREADS);
+        QUEUES[i].end = (int) ((long) count * (i + 1) / THREADS);
+        pthread_mutex_unlock(&(QUEUES[i].lock));
+    }
+    TASK = task;
+    USER_PARAM = user_param;
+    PENDING = count;
+    GENERATION ++;
+    STATS.runs ++;
+    STATS.tasks += count;
+    pthread_cond_broadcast(&START);
+    pthread_mutex_unlock(&LOCK);
+
+    IN_TASK = EI_TRUE;
+    work(0, task, user_param);
+    IN_TASK = EI_FALSE;
+
+    pthread_mutex_lock(&LOCK);
+    while (PENDING > 0 || BUSY > 0) {
+        pthread_cond_wait(&DONE, &LOCK);
+    }
+    pthread_mutex_unlock(&LOCK);
+}
+
+void ei_pool_set_threads(int threads){
+    threads = max(1, min(threads, MAX_THREADS));
+    if (threads != THREADS) {
+        ei_pool_free();
+        THREADS = threads;
+    }
+}
+
+int ei_pool_get_threads(){
+    if (THREADS == 0) {
+        long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        THREADS = (int) max(1, min(processors, MAX_THREADS));
+    }
+    return THREADS;
+}
+
+ei_bool_t ei_pool_in_task(){
+    return IN_TASK;
+}
+
+void ei_pool_get_stats(ei_pool_stats_t* stats){
+    pthread_mutex_lock(&LOCK);
+    *stats = STATS;
+    pthread_mutex_unlock(&LOCK);
+    stats -> threads = ei_pool_get_threads();
+}
+
+void ei_pool_free(){
+    if (STARTED == 0) {
+        return;
+    }
+    pthread_mutex_lock(&LOCK);
+    QUIT = EI_TRUE;
+    pthread_cond_broadcast(&START);
+    pthread_mutex_unlock(&LOCK);
+    for (int i = 1; i <= STARTED; i++) {
+        pthread_join(WORKERS[i], NULL);
+    }
+    STARTED = 0;
+}
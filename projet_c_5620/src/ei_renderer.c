@@ -0,0 +1,333 @@
+/**
+ *  @file	ei_renderer.c
+ *  @brief	Tiled renderer: the region to redraw is split into tiles, the visible widgets
+ *		are sorted into the tiles they overlap, and the tiles are drawn in parallel by the
+ *		threads of the pool (see \ref ei_pool_run), each one clipped to its tile. The
+ *		widgets hidden by opaque widgets in front of them are not drawn. A frame that
+ *		shows a widget of a class of the application is drawn by the main thread.
+ *
+ */
+
+#include <stdlib.h>
+#include "ei_renderer.h"
+#include "ei_all_widgets.h"
+#include "ei_placer.h"
+#include "ei_pool.h"
+
+#define max(a,b) ((a) > (b) ? a : b)
+#define min(a,b) ((a) < (b) ? a : b)
+
+/**
+ * \brief	A widget to draw, and its clipper.
+ */
+typedef struct {
+    ei_widget_t*	widget;
+    ei_rect_t		clipper;
+} ei_render_item_t;
+
+/**
+ * \brief	What the tasks of a frame need.
+ */
+typedef struct {
+    ei_rect_t		region;
+    int			columns;
+    ei_surface_t	surface;
+    ei_surface_t	pick_surface;
+} ei_render_frame_t;
+
+/* Les tableaux sont gardes d'une frame a l'autre */
+static ei_render_item_t* ITEMS = NULL;
+static int ITEM_COUNT = 0;
+static int ITEM_CAPACITY = 0;
+/* Debut de la liste de chaque tuile dans BINS, et position de remplissage */
+static int* BIN_START = NULL;
+static int* BIN_FILL = NULL;
+static int BIN_CAPACITY = 0;
+static int* BINS = NULL;
+static int BINS_CAPACITY = 0;
+static int TILE_SIZE = EI_RENDERER_DEFAULT_TILE_SIZE;
+static ei_bool_t CULLING = EI_TRUE;
+/* Un widget d'une classe de l'application est dans la frame : pas de workers */
+static ei_bool_t USER_ITEMS = EI_FALSE;
+static ei_renderer_stats_t STATS;
+
+/* Nombre maximal de rectangles opaques gardes pendant le parcours avant-arriere */
+#define OCCLUDER_MAX	16
+
+static void item_push(ei_widget_t* widget, ei_rect_t clipper){
+    if (ITEM_COUNT == ITEM_CAPACITY) {
+        ITEM_CAPACITY = max(64, 2 * ITEM_CAPACITY);
+        ITEMS = realloc(ITEMS, ITEM_CAPACITY * sizeof(ei_render_item_t));
+    }
+    ITEMS[ITEM_COUNT].widget = widget;
+    ITEMS[ITEM_COUNT].clipper = clipper;
+    ITEM_COUNT ++;
+    if (ei_widget_links(widget) -> class_id >= ei_class_first_user) {
+        USER_ITEMS = EI_TRUE;
+    }
+}
+
+/**
+ * \brief	Lists the visible descendants of a widget in drawing order, with their clipper.
+ *
+ * @param	parent		The widget whose children are listed.
+ * @param	clipper		The clipper of the parent.
+ */
+static void collect(ei_widget_t* parent, ei_rect_t clipper){
+    // Les enfants sont limites a la zone de contenu du parent, sauf ses decorations
+    ei_rect_t content = ei_rect_intersection(&clipper, parent -> content_rect);
+    ei_widget_t* widget = parent -> children_head;
+    while (widget != NULL){
+        // Un widget qui n'est pas gere par le placer n'est pas affiche
+        if (widget -> placer_params != NULL) {
+            ei_rect_t* area = &content;
+            if (ei_widget_is_decoration(widget) == EI_TRUE) {
+                area = &clipper;
+            }
+            ei_rect_t widget_clipper = ei_rect_intersection(area,
+                &(widget -> screen_location));
+            if (widget_clipper.size.width > 0 && widget_clipper.size.height > 0) {
+                item_push(widget, widget_clipper);
+            }
+            if (widget_clipper.size.width > 0 && widget_clipper.size.height > 0) {
+                collect(widget, widget_clipper);
+            }
+        }
+        widget = widget -> next_sibling;
+    }
+}
+
+/**
+ * \brief	Removes from a clipper the band covered by an occluder that spans its whole
+ * width or its whole height, so that what is left is still a rectangle.
+ *
+ * @return	EI_TRUE if nothing is left of the clipper.
+ */
+static ei_bool_t clipper_subtract(ei_rect_t* clipper, const ei_rect_t* occluder){
+    int cx0 = clipper -> top_left.x;
+    int cy0 = clipper -> top_left.y;
+    int cx1 = cx0 + clipper -> size.width;
+    int cy1 = cy0 + clipper -> size.height;
+    int ox0 = occluder -> top_left.x;
+    int oy0 = occluder -> top_left.y;
+    int ox1 = ox0 + occluder -> size.width;
+    int oy1 = oy0 + occluder -> size.height;
+    if (ox0 >= cx1 || ox1 <= cx0 || oy0 >= cy1 || oy1 <= cy0) {
+        return EI_FALSE;
+    }
+    if (ox0 <= cx0 && ox1 >= cx1) {
+        if (oy0 <= cy0 && oy1 >= cy1) {
+            return EI_TRUE;
+        }
+        if (oy0 <= cy0) {
+            cy0 = oy1;
+        } else if (oy1 >= cy1) {
+            cy1 = oy0;
+        }
+    } else if (oy0 <= cy0 && oy1 >= cy1) {
+        if (ox0 <= cx0) {
+            cx0 = ox1;
+        } else if (ox1 >= cx1) {
+            cx1 = ox0;
+        }
+    }
+    clipper -> top_left.x = cx0;
+    clipper -> top_left.y = cy0;
+    clipper -> size.width = cx1 - cx0;
+    clipper -> size.height = cy1 - cy0;
+    return EI_FALSE;
+}
+
+/**
+ * \brief	Goes through the items from front to back and removes the ones that are hidden
+ * by the opaque items in front of them; the clipper of an item partly hidden by a band is
+ * reduced. The largest opaque rectangles met so far are kept, at most OCCLUDER_MAX.
+ */
+static void cull_items(){
+    ei_rect_t occluders[OCCLUDER_MAX];
+    int occluder_count = 0;
+    STATS.culled = 0;
+    STATS.trimmed = 0;
+    for (int i = ITEM_COUNT - 1; i >= 0; i--) {
+        ei_render_item_t* item = &(ITEMS[i]);
+        ei_rect_t clipper = item -> clipper;
+        ei_bool_t hidden = EI_FALSE;
+        for (int k = 0; k < occluder_count && hidden == EI_FALSE; k++) {
+            hidden = clipper_subtract(&clipper, &(occluders[k]));
+        }
+        if (hidden == EI_TRUE) {
+            item -> widget = NULL;
+            STATS.culled ++;
+            continue;
+        }
+        ei_rect_t opaque;
+        if (ei_widget_opaque_rect(item -> widget, &opaque) == EI_TRUE) {
+            // Ce que le widget recouvre, dans la limite de ce qu'il dessine
+            opaque = ei_rect_intersection(&opaque, &(item -> clipper));
+            int area = opaque.size.width * opaque.size.height;
+            if (occluder_count < OCCLUDER_MAX) {
+                occluders[occluder_count] = opaque;
+                occluder_count ++;
+            } else {
+                int smallest = 0;
+                for (int k = 1; k < OCCLUDER_MAX; k++) {
+                    if (occluders[k].size.width * occluders[k].size.height
+                        < occluders[smallest].size.width * occluders[smallest].size.height) {
+                        smallest = k;
+                    }
+                }
+                if (occluders[smallest].size.width * occluders[smallest].size.height < area) {
+                    occluders[smallest] = opaque;
+                }
+            }
+        }
+        if (ei_rect_equal(&clipper, &(item -> clipper)) == EI_FALSE) {
+            item -> clipper = clipper;
+            STATS.trimmed ++;
+        }
+    }
+    // Les items caches sont retires, l'ordre de dessin est garde
+    int count = 0;
+    for (int i = 0; i < ITEM_COUNT; i++) {
+        if (ITEMS[i].widget != NULL) {
+            ITEMS[count] = ITEMS[i];
+            count ++;
+        }
+    }
+    ITEM_COUNT = count;
+}
+
+/**
+ * \brief	Sorts the items into the tiles they overlap, keeping the drawing order.
+ */
+static void bin_items(ei_rect_t region, int columns, int tiles){
+    if (tiles + 1 > BIN_CAPACITY) {
+        BIN_CAPACITY = tiles + 1;
+        BIN_START = realloc(BIN_START, BIN_CAPACITY * sizeof(int));
+        BIN_FILL = realloc(BIN_FILL, BIN_CAPACITY * sizeof(int));
+    }
+    for (int t = 0; t <= tiles; t++) {
+        BIN_START[t] = 0;
+    }
+    int total = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < ITEM_COUNT; i++) {
+            ei_rect_t* clipper = &(ITEMS[i].clipper);
+            int x0 = (clipper -> top_left.x - region.top_left.x) / TILE_SIZE;
+            int y0 = (clipper -> top_left.y - region.top_left.y) / TILE_SIZE;
+            int x1 = (clipper -> top_left.x + clipper -> size.width - 1
+                - region.top_left.x) / TILE_SIZE;
+            int y1 = (clipper -> top_left.y + clipper -> size.height - 1
+                - region.top_left.y) / TILE_SIZE;
+            for (int y = y0; y <= y1; y++) {
+                for (int x = x0; x <= x1; x++) {
+                    int t = y * columns + x;
+                    if (pass == 0) {
+                        BIN_START[t + 1] ++;
+                    } else {
+                        BINS[BIN_FILL[t]] = i;
+                        BIN_FILL[t] ++;
+                    }
+                }
+            }
+        }
+        if (pass == 0) {
+            for (int t = 0; t < tiles; t++) {
+                BIN_START[t + 1] += BIN_START[t];
+                BIN_FILL[t] = BIN_START[t];
+            }
+            total = BIN_START[tiles];
+            if (total > BINS_CAPACITY) {
+                BINS_CAPACITY = max(total, 2 * BINS_CAPACITY);
+                BINS = realloc(BINS, BINS_CAPACITY * sizeof(int));
+            }
+        }
+    }
+    STATS.binned = total;
+}
+
+/**
+ * \brief	Draws the items of a tile, clipped to the tile. Run by the threads of the pool.
+ */
+static void draw_tile(int index, void* user_param){
+    ei_render_frame_t* frame = (ei_render_frame_t*) user_param;
+    ei_rect_t tile;
+    tile.top_left.x = frame -> region.top_left.x + (index % frame -> columns) * TILE_SIZE;
+    tile.top_left.y = frame -> region.top_left.y + (index / frame -> columns) * TILE_SIZE;
+    tile.size.width = min(TILE_SIZE, frame -> region.top_left.x
+        + frame -> region.size.width - tile.top_left.x);
+    tile.size.height = min(TILE_SIZE, frame -> region.top_left.y
+        + frame -> region.size.height - tile.top_left.y);
+    for (int k = BIN_START[index]; k < BIN_START[index + 1]; k++) {
+        ei_render_item_t* item = &(ITEMS[BINS[k]]);
+        ei_rect_t clipper = ei_rect_intersection(&(item -> clipper), &tile);
+        if (clipper.size.width > 0 && clipper.size.height > 0) {
+            (item -> widget -> wclass -> drawfunc)(item -> widget, frame -> surface,
+                frame -> pick_surface, &clipper);
+        }
+    }
+}
+
+void ei_render(ei_widget_t* root, ei_linked_rect_t* region, ei_surface_t surface,
+	       ei_surface_t pick_surface){
+    STATS.frames ++;
+    ITEM_COUNT = 0;
+    USER_ITEMS = EI_FALSE;
+    ei_rect_t clipper = root -> screen_location;
+    if (region != NULL) {
+        clipper = ei_rect_intersection(&clipper, &(region -> rect));
+    }
+    // La disposition a ete calculee par la passe du placeur, avant le dessin
+    item_push(root, clipper);
+    collect(root, clipper);
+    if (CULLING == EI_TRUE) {
+        cull_items();
+    }
+    STATS.items = ITEM_COUNT;
+    if (clipper.size.width <= 0 || clipper.size.height <= 0) {
+        STATS.tiles = 0;
+        return;
+    }
+    int columns = (clipper.size.width + TILE_SIZE - 1) / TILE_SIZE;
+    int rows = (clipper.size.height + TILE_SIZE - 1) / TILE_SIZE;
+    STATS.tiles = columns * rows;
+    // Les drawfuncs de l'application ne sont appelees que depuis le thread principal
+    if (STATS.tiles == 1 || ei_pool_get_threads() == 1 || USER_ITEMS == EI_TRUE) {
+        for (int i = 0; i < ITEM_COUNT; i++) {
+            (ITEMS[i].widget -> wclass -> drawfunc)(ITEMS[i].widget, surface, pick_surface,
+                &(ITEMS[i].clipper));
+        }
+        return;
+    }
+    bin_items(clipper, columns, STATS.tiles);
+    ei_render_frame_t frame = {clipper, columns, surface, pick_surface};
+    STATS.parallel_frames ++;
+    ei_pool_run(STATS.tiles, draw_tile, &frame);
+}
+
+void ei_renderer_set_tile_size(int size){
+    TILE_SIZE = max(16, size);
+}
+
+void ei_renderer_set_culling(ei_bool_t enabled){
+    CULLING = enabled;
+}
+
+void ei_renderer_get_stats(ei_renderer_stats_t* stats){
+    *stats = STATS;
+}
+
+void ei_renderer_free(){
+    free(ITEMS);
+    free(BIN_START);
+    free(BIN_FILL);
+    free(BINS);
+    ITEMS = NULL;
+    BIN_START = NULL;
+    BIN_FILL = NULL;
+    BINS = NULL;
+    ITEM_COUNT = 0;
+    ITEM_CAPACITY = 0;
+    BIN_CAPACITY = 0;
+    BINS_CAPACITY = 0;
+}
@@ -0,0 +1,446 @@
+/**
+ *  @file	ei_scale.c
+ *  @brief	Scaled copies of the images displayed by the frames and the buttons. A scaled
+ *		copy is resampled once per size and kept in a cache; strong reductions start
+ *		from a chain of images halved with a box filter (mipmaps), then the last step
+ *		is bilinear.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <pthread.h>
+#include "ei_scale.h"
+#include "ei_all_widgets.h"
+#include "ei_application.h"
+#include "ei_arena.h"
+
+#define max(a,b) ((a) > (b) ? a : b)
+#define min(a,b) ((a) < (b) ? a : b)
+
+/* Nombre de listes des tables, une puissance de 2 */
+#define BUCKETS		128
+/* Nombre maximal de mipmaps d'une image */
+#define MAX_LEVELS	16
+
+/**
+ * \brief	A scaled copy of a part of an image. It is in the table of the keys, in the
+ * table of the copies, and in the list of all the copies, the most recently used first.
+ */
+typedef struct ei_scaled_t {
+    ei_surface_t		source;
+    ei_rect_t			rect;
+    ei_size_t			size;
+    uint32_t			hash;
+    ei_surface_t		surface;
+    size_t			bytes;
+    /* Nombre d'utilisateurs : une copie utilisee n'est pas liberee */
+    int				pins;
+    struct ei_scaled_t*		next_key;
+    struct ei_scaled_t*		next_surface;
+    struct ei_scaled_t*		prev_used;
+    struct ei_scaled_t*		next_used;
+} ei_scaled_t;
+
+/**
+ * \brief	The mipmaps of an image: level[i] is the image halved i + 1 times.
+ */
+typedef struct ei_mip_t {
+    ei_surface_t		source;
+    int				levels;
+    ei_surface_t		level[MAX_LEVELS];
+    struct ei_mip_t*		next;
+} ei_mip_t;
+
+static ei_scaled_t* KEYS[BUCKETS];
+static ei_scaled_t* COPIES[BUCKETS];
+static ei_scaled_t* USED_HEAD = NULL;
+static ei_scaled_t* USED_TAIL = NULL;
+static ei_mip_t* MIPS = NULL;
+static size_t BUDGET = EI_SCALE_DEFAULT_BUDGET;
+static ei_scale_stats_t STATS;
+/* Les tuiles du rendu redimensionnent en parallele */
+static pthread_mutex_t LOCK = PTHREAD_MUTEX_INITIALIZER;
+
+static uint32_t surface_hash(ei_surface_t surface){
+    uintptr_t address = (uintptr_t) surface;
+    return (uint32_t) ((address >> 4) ^ (address >> 12));
+}
+
+static uint32_t key_hash(ei_surface_t source, const ei_rect_t* rect, ei_size_t size){
+    int values[6] = {rect -> top_left.x, rect -> top_left.y, rect -> size.width,
+        rect -> size.height, size.width, size.height};
+    uint32_t hash = 2166136261u ^ surface_hash(source);
+    for (int i = 0; i < 6; i++) {
+        hash ^= (uint32_t) values[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static size_t surface_bytes(ei_surface_t surface){
+    ei_size_t size = hw_surface_get_size(surface);
+    return (size_t) size.width * size.height * 4;
+}
+
+static void used_remove(ei_scaled_t* scaled){
+    if (scaled -> prev_used != NULL) {
+        scaled -> prev_used -> next_used = scaled -> next_used;
+    } else {
+        USED_HEAD = scaled -> next_used;
+    }
+    if (scaled -> next_used != NULL) {
+        scaled -> next_used -> prev_used = scaled -> prev_used;
+    } else {
+        USED_TAIL = scaled -> prev_used;
+    }
+}
+
+static void used_push(ei_scaled_t* scaled){
+    scaled -> prev_used = NULL;
+    scaled -> next_used = USED_HEAD;
+    if (USED_HEAD != NULL) {
+        USED_HEAD -> prev_used = scaled;
+    } else {
+        USED_TAIL = scaled;
+    }
+    USED_HEAD = scaled;
+}
+
+/**
+ * \brief	Removes a copy from the cache and frees its surface.
+ */
+static void scaled_free(ei_scaled_t* scaled){
+    ei_scaled_t** link = &(KEYS[scaled -> hash & (BUCKETS - 1)]);
+    while (*link != scaled) {
+        link = &((*link) -> next_key);
+    }
+    *link = scaled -> next_key;
+    link = &(COPIES[surface_hash(scaled -> surface) & (BUCKETS - 1)]);
+    while (*link != scaled) {
+        link = &((*link) -> next_surface);
+    }
+    *link = scaled -> next_surface;
+    used_remove(scaled);
+    STATS.copies --;
+    STATS.bytes -= scaled -> bytes;
+    ei_layer_set_premultiplied(scaled -> surface, EI_FALSE);
+    hw_surface_free(scaled -> surface);
+    free(scaled);
+}
+
+/**
+ * \brief	Frees the least recently used copies that are not in use until the cache fits
+ * in the budget.
+ */
+static void enforce_budget(){
+    ei_scaled_t* scaled = USED_TAIL;
+    while (scaled != NULL && STATS.bytes > BUDGET) {
+        ei_scaled_t* prev = scaled -> prev_used;
+        if (scaled -> pins == 0) {
+            scaled_free(scaled);
+            STATS.evictions ++;
+        }
+        scaled = prev;
+    }
+}
+
+/**
+ * \brief	Halves an image with a 2x2 box filter. The channels are averaged one by one,
+ * whatever their order, in loops the compiler can vectorize.
+ */
+static void box_halve(const uint8_t* src, ei_size_t src_size, uint8_t* dst,
+        ei_size_t dst_size){
+    // Une image d'une seule colonne ou ligne est moyennee avec elle-meme
+    int next_column = (src_size.width > 1) ? 4 : 0;
+    for (int y = 0; y < dst_size.height; y++) {
+        const uint8_t* row0 = src + (size_t) min(2 * y, src_size.height - 1)
+            * src_size.width * 4;
+        const uint8_t* row1 = src + (size_t) min(2 * y + 1, src_size.height - 1)
+            * src_size.width * 4;
+        uint8_t* out = dst + (size_t) y * dst_size.width * 4;
+        for (int x = 0; x < dst_size.width; x++) {
+            for (int c = 0; c < 4; c++) {
+                out[4 * x + c] = (uint8_t) ((row0[8 * x + c] + row0[8 * x + next_column + c]
+                    + row1[8 * x + c] + row1[8 * x + next_column + c] + 2) >> 2);
+            }
+        }
+    }
+}
+
+/**
+ * \brief	Returns the level-th mipmap of an image (0 for the image itself), computing
+ * the missing ones.
+ */
+static ei_surface_t mip_level(ei_surface_t source, int level){
+    if (level == 0) {
+        return source;
+    }
+    ei_mip_t* mip = MIPS;
+    while (mip != NULL && mip -> source != source) {
+        mip = mip -> next;
+    }
+    if (mip == NULL) {
+        mip = calloc(1, sizeof(ei_mip_t));
+        mip -> source = source;
+        mip -> next = MIPS;
+        MIPS = mip;
+    }
+    while (mip -> levels < level) {
+        ei_surface_t parent = (mip -> levels == 0) ? source
+            : mip -> level[mip -> levels - 1];
+        ei_size_t parent_size = hw_surface_get_size(parent);
+        ei_size_t size = {max(1, parent_size.width / 2), max(1, parent_size.height / 2)};
+        ei_surface_t halved = hw_surface_create(source, &size, hw_surface_has_alpha(source));
+        box_halve(hw_surface_get_buffer(parent), parent_size, hw_surface_get_buffer(halved),
+            size);
+        // Moyenner des couleurs premultipliees donne encore des couleurs premultipliees
+        ei_layer_set_premultiplied(halved, ei_layer_is_premultiplied(source));
+        mip -> level[mip -> levels] = halved;
+        mip -> levels ++;
+        STATS.mip_levels ++;
+        STATS.bytes += surface_bytes(halved);
+    }
+    return mip -> level[level - 1];
+}
+
+/**
+ * \brief	The source pixels of a destination column or row: the bilinear weight of the
+ * second one, from 0 to 256.
+ */
+typedef struct {
+    int		first;
+    int		second;
+    int		weight;
+} ei_tap_t;
+
+/**
+ * \brief	Computes the taps of the count destination pixels sampling [origin, origin +
+ * length) of the source, without reading outside [low, high].
+ */
+static void taps_compute(ei_tap_t* taps, int count, double origin, double length,
+        int low, int high){
+    double step = length / count;
+    for (int i = 0; i < count; i++) {
+        double position = origin + (i + 0.5) * step - 0.5;
+        position = fmax(low, fmin(high, position));
+        int first = (int) floor(position);
+        taps[i].first = first;
+        taps[i].second = min(first + 1, high);
+        taps[i].weight = (int) lround((position - first) * 256);
+    }
+}
+
+/**
+ * \brief	Resamples a rectangle of an image with a bilinear filter, in two passes: the
+ * two source rows are blended in a row of 16 bits values, then the columns of this row.
+ * The first pass runs on contiguous bytes, and is vectorized by the compiler.
+ */
+static void bilinear(ei_surface_t source, double x, double y, double width, double height,
+        ei_surface_t destination){
+    ei_size_t src_size = hw_surface_get_size(source);
+    ei_size_t dst_size = hw_surface_get_size(destination);
+    const uint8_t* src = hw_surface_get_buffer(source);
+    uint8_t* dst = hw_surface_get_buffer(destination);
+    // Les pixels autour du rectangle ne debordent pas dans la copie
+    int low_x = max(0, (int) floor(x));
+    int high_x = min(src_size.width - 1, (int) ceil(x + width) - 1);
+    int low_y = max(0, (int) floor(y));
+    int high_y = min(src_size.height - 1, (int) ceil(y + height) - 1);
+    ei_arena_mark_t mark = ei_arena_mark();
+    ei_tap_t* columns = ei_arena_alloc(sizeof(ei_tap_t) * dst_size.width);
+    ei_tap_t* rows = ei_arena_alloc(sizeof(ei_tap_t) * dst_size.height);
+    int span = (high_x - low_x + 1) * 4;
+    uint16_t* blended = ei_arena_alloc(sizeof(uint16_t) * span);
+    taps_compute(columns, dst_size.width, x, width, low_x, high_x);
+    taps_compute(rows, dst_size.height, y, height, low_y, high_y);
+    for (int j = 0; j < dst_size.height; j++) {
+        const uint8_t* row0 = src + ((size_t) rows[j].first * src_size.width + low_x) * 4;
+        const uint8_t* row1 = src + ((size_t) rows[j].second * src_size.width + low_x) * 4;
+        int w1 = rows[j].weight;
+        int w0 = 256 - w1;
+        for (int i = 0; i < span; i++) {
+            blended[i] = (uint16_t) (row0[i] * w0 + row1[i] * w1);
+        }
+        uint8_t* out = dst + (size_t) j * dst_size.width * 4;
+        for (int i = 0; i < dst_size.width; i++) {
+            const uint16_t* first = blended + (columns[i].first - low_x) * 4;
+            const uint16_t* second = blended + (columns[i].second - low_x) * 4;
+            uint32_t v1 = columns[i].weight;
+            uint32_t v0 = 256 - v1;
+            for (int c = 0; c < 4; c++) {
+                out[4 * i + c] = (uint8_t) ((first[c] * v0 + second[c] * v1 + 32768) >> 16);
+            }
+        }
+    }
+    ei_arena_rewind(mark);
+}
+
+/**
+ * \brief	Computes a scaled copy: the mipmap just bigger than the copy is resampled.
+ */
+static ei_surface_t resample(ei_surface_t source, const ei_rect_t* rect, ei_size_t size){
+    int level = 0;
+    while (level < MAX_LEVELS && (rect -> size.width >> (level + 1)) >= size.width
+        && (rect -> size.height >> (level + 1)) >= size.height) {
+        level ++;
+    }
+    ei_surface_t from = mip_level(source, level);
+    ei_size_t source_size = hw_surface_get_size(source);
+    ei_size_t from_size = hw_surface_get_size(from);
+    double scale_x = (double) from_size.width / source_size.width;
+    double scale_y = (double) from_size.height / source_size.height;
+    ei_surface_t scaled = hw_surface_create(source, &size, hw_surface_has_alpha(source));
+    bilinear(from, rect -> top_left.x * scale_x, rect -> top_left.y * scale_y,
+        rect -> size.width * scale_x, rect -> size.height * scale_y, scaled);
+    ei_layer_set_premultiplied(scaled, ei_layer_is_premultiplied(source));
+    return scaled;
+}
+
+ei_surface_t ei_scale_acquire(ei_surface_t source, const ei_rect_t* rect, ei_size_t size){
+    if (source == NULL || size.width <= 0 || size.height <= 0) {
+        return NULL;
+    }
+    ei_rect_t area = hw_surface_get_rect(source);
+    if (rect != NULL) {
+        area = ei_rect_intersection(rect, &area);
+    }
+    if (area.size.width <= 0 || area.size.height <= 0) {
+        return NULL;
+    }
+    uint32_t hash = key_hash(source, &area, size);
+    pthread_mutex_lock(&LOCK);
+    ei_scaled_t* scaled = KEYS[hash & (BUCKETS - 1)];
+    while (scaled != NULL && (scaled -> source != source
+        || ei_rect_equal(&(scaled -> rect), &area) == EI_FALSE
+        || scaled -> size.width != size.width || scaled -> size.height != size.height)) {
+        scaled = scaled -> next_key;
+    }
+    if (scaled != NULL) {
+        used_remove(scaled);
+        STATS.hits ++;
+    } else {
+        scaled = calloc(1, sizeof(ei_scaled_t));
+        scaled -> source = source;
+        scaled -> rect = area;
+        scaled -> size = size;
+        scaled -> hash = hash;
+        scaled -> surface = resample(source, &area, size);
+        scaled -> bytes = surface_bytes(scaled -> surface);
+        scaled -> next_key = KEYS[hash & (BUCKETS - 1)];
+        KEYS[hash & (BUCKETS - 1)] = scaled;
+        uint32_t bucket = surface_hash(scaled -> surface) & (BUCKETS - 1);
+        scaled -> next_surface = COPIES[bucket];
+        COPIES[bucket] = scaled;
+        STATS.copies ++;
+        STATS.bytes += scaled -> bytes;
+        STATS.resamples ++;
+    }
+    used_push(scaled);
+    scaled -> pins ++;
+    enforce_budget();
+    pthread_mutex_unlock(&LOCK);
+    return scaled -> surface;
+}
+
+void ei_scale_release(ei_surface_t surface){
+    if (surface == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&LOCK);
+    ei_scaled_t* scaled = COPIES[surface_hash(surface) & (BUCKETS - 1)];
+    while (scaled != NULL && scaled -> surface != surface) {
+        scaled = scaled -> next_surface;
+    }
+    if (scaled != NULL && scaled -> pins > 0) {
+        scaled -> pins --;
+        if (scaled -> pins == 0) {
+            enforce_budget();
+        }
+    }
+    pthread_mutex_unlock(&LOCK);
+}
+
+void ei_scale_forget(ei_surface_t source){
+    pthread_mutex_lock(&LOCK);
+    ei_scaled_t* scaled = USED_HEAD;
+    while (scaled != NULL) {
+        ei_scaled_t* next = scaled -> next_used;
+        if (scaled -> source == source) {
+            scaled_free(scaled);
+        }
+        scaled = next;
+    }
+    ei_mip_t** link = &MIPS;
+    while (*link != NULL && (*link) -> source != source) {
+        link = &((*link) -> next);
+    }
+    if (*link != NULL) {
+        ei_mip_t* mip = *link;
+        *link = mip -> next;
+        for (int i = 0; i < mip -> levels; i++) {
+            STATS.bytes -= surface_bytes(mip -> level[i]);
+            ei_layer_set_premultiplied(mip -> level[i], EI_FALSE);
+            hw_surface_free(mip -> level[i]);
+        }
+        STATS.mip_levels -= mip -> levels;
+        free(mip);
+    }
+    pthread_mutex_unlock(&LOCK);
+}
+
+void ei_scale_set_budget(size_t bytes){
+    pthread_mutex_lock(&LOCK);
+    BUDGET = bytes;
+    enforce_budget();
+    pthread_mutex_unlock(&LOCK);
+}
+
+void ei_scale_get_stats(ei_scale_stats_t* stats){
+    pthread_mutex_lock(&LOCK);
+    *stats = STATS;
+    pthread_mutex_unlock(&LOCK);
+}
+
+void ei_scale_free_all(){
+    while (USED_HEAD != NULL) {
+        ei_scale_forget(USED_HEAD -> source);
+    }
+    while (MIPS != NULL) {
+        ei_scale_forget(MIPS -> source);
+    }
+}
+
+ei_size_t ei_scale_fit_size(ei_size_t image, ei_size_t area, ei_scaling_t scaling){
+    ei_size_t size = image;
+    if (scaling == ei_scale_stretch) {
+        size = area;
+    } else if (scaling == ei_scale_fit && image.width > 0 && image.height > 0) {
+        // Le rapport le plus petit fait tenir l'image dans la zone
+        if ((long) area.width * image.height <= (long) area.height * image.width) {
+            size.width = area.width;
+            size.height = (int) ((long) image.height * area.width / image.width);
+        } else {
+            size.height = area.height;
+            size.width = (int) ((long) image.width * area.height / image.height);
+        }
+    }
+    size.width = max(1, size.width);
+    size.height = max(1, size.height);
+    return size;
+}
+
+void ei_widget_set_img_scaling(ei_widget_t* widget, ei_scaling_t scaling){
+    ei_scaling_t* field = NULL;
+    if (ei_widget_is(widget, ei_class_frame) == EI_TRUE) {
+        field = &(((ei_frame_t*) widget) -> img_scaling);
+    } else if (ei_widget_is(widget, ei_class_button) == EI_TRUE) {
+        field = &(((ei_button_t*) widget) -> img_scaling);
+    }
+    if (field == NULL || *field == scaling) {
+        return;
+    }
+    *field = scaling;
+    ei_app_invalidate_rect(&(widget -> screen_location));
+}
@@ -0,0 +1,241 @@
+/**
+ *  @file	ei_slab.c
+ *  @brief	Slab allocator for the widget instances: the widgets of a class are allocated in
+ *		blocks of fixed-size slots instead of one malloc each, and a freed slot is reused
+ *		by the next widget of the same class.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "ei_slab.h"
+#include "ei_widget.h"
+
+#define max(a,b) ((a) > (b) ? a : b)
+
+/* Taille visee d'un slab, en octets */
+#define SLAB_BYTES	16384
+#define MIN_OBJECTS	8
+/* Alignement des objets, suffisant pour tous les types de base */
+#define ALIGNMENT	16
+
+struct ei_slab_t;
+
+/**
+ * \brief	The header stored before each slot: the slab of the slot, and the next
+ * free slot while the slot is free.
+ */
+typedef union ei_slot_t {
+    struct {
+        struct ei_slab_t*	slab;
+        union ei_slot_t*	next_free;
+    } header;
+    char			align[ALIGNMENT];
+} ei_slot_t;
+
+/**
+ * \brief	A block of memory holding objects_per_slab slots, allocated at once.
+ */
+typedef struct ei_slab_t {
+    struct ei_slab_cache_t*	cache;
+    struct ei_slab_t*		prev;
+    struct ei_slab_t*		next;
+    ei_slot_t*			free_slots;
+    int				live;
+    ei_slot_t*			slots;
+} ei_slab_t;
+
+struct ei_slab_cache_t {
+    size_t		object_size;
+    size_t		stride;
+    int			objects_per_slab;
+    /* Slabs avec au moins un slot libre */
+    ei_slab_t*		partial;
+    /* Slabs pleins */
+    ei_slab_t*		full;
+    /* Un slab vide garde en reserve */
+    ei_slab_t*		spare;
+    int			slabs;
+    int			live;
+    int			peak;
+    unsigned long	allocations;
+    unsigned long	releases;
+};
+
+/* Caches des classes, indexes par l'identifiant de la classe */
+static ei_slab_cache_t* CLASS_SLABS[EI_MAX_CLASSES];
+
+static void slab_unlink(ei_slab_t** list, ei_slab_t* slab){
+    if (slab -> prev != NULL) {
+        slab -> prev -> next = slab -> next;
+    } else {
+        *list = slab -> next;
+    }
+    if (slab -> next != NULL) {
+        slab -> next -> prev = slab -> prev;
+    }
+    slab -> prev = NULL;
+    slab -> next = NULL;
+}
+
+static void slab_push(ei_slab_t** list, ei_slab_t* slab){
+    slab -> prev = NULL;
+    slab -> next = *list;
+    if (*list != NULL) {
+        (*list) -> prev = slab;
+    }
+    *list = slab;
+}
+
+static ei_slot_t* slab_slot(ei_slab_t* slab, int index){
+    return (ei_slot_t*) ((char*) slab -> slots + index * slab -> cache -> stride);
+}
+
+/**
+ * \brief	Allocates a slab and chains all its slots in its free list.
+ */
+static ei_slab_t* slab_create(ei_slab_cache_t* cache){
+    ei_slab_t* slab = calloc(1, sizeof(ei_slab_t));
+    slab -> cache = cache;
+    slab -> slots = malloc(cache -> stride * cache -> objects_per_slab);
+    for (int i = cache -> objects_per_slab - 1; i >= 0; i--) {
+        ei_slot_t* slot = slab_slot(slab, i);
+        slot -> header.slab = slab;
+        slot -> header.next_free = slab -> free_slots;
+        slab -> free_slots = slot;
+    }
+    cache -> slabs ++;
+    return slab;
+}
+
+static void slab_destroy(ei_slab_t* slab){
+    slab -> cache -> slabs --;
+    free(slab -> slots);
+    free(slab);
+}
+
+ei_slab_cache_t* ei_slab_cache_create(size_t object_size){
+    ei_slab_cache_t* cache = calloc(1, sizeof(ei_slab_cache_t));
+    cache -> object_size = object_size;
+    cache -> stride = sizeof(ei_slot_t)
+        + (object_size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    cache -> objects_per_slab = max(MIN_OBJECTS, (int) (SLAB_BYTES / cache -> stride));
+    return cache;
+}
+
+static void slab_destroy_list(ei_slab_t* slab){
+    while (slab != NULL) {
+        ei_slab_t* next = slab -> next;
+        slab_destroy(slab);
+        slab = next;
+    }
+}
+
+void ei_slab_cache_destroy(ei_slab_cache_t* cache){
+    slab_destroy_list(cache -> partial);
+    slab_destroy_list(cache -> full);
+    slab_destroy_list(cache -> spare);
+    free(cache);
+}
+
+void* ei_slab_alloc(ei_slab_cache_t* cache){
+    ei_slab_t* slab = cache -> partial;
+    if (slab == NULL) {
+        if (cache -> spare != NULL) {
+            slab = cache -> spare;
+            cache -> spare = NULL;
+        } else {
+            slab = slab_create(cache);
+        }
+        slab_push(&(cache -> partial), slab);
+    }
+    ei_slot_t* slot = slab -> free_slots;
+    slab -> free_slots = slot -> header.next_free;
+    slab -> live ++;
+    if (slab -> free_slots == NULL) {
+        slab_unlink(&(cache -> partial), slab);
+        slab_push(&(cache -> full), slab);
+    }
+    cache -> live ++;
+    cache -> peak = max(cache -> peak, cache -> live);
+    cache -> allocations ++;
+    void* object = (void*) (slot + 1);
+    memset(object, 0, cache -> object_size);
+    return object;
+}
+
+void ei_slab_free(void* object){
+    if (object == NULL) {
+        return;
+    }
+    ei_slot_t* slot = ((ei_slot_t*) object) - 1;
+    ei_slab_t* slab = slot -> header.slab;
+    ei_slab_cache_t* cache = slab -> cache;
+    if (slab -> free_slots == NULL) {
+        slab_unlink(&(cache -> full), slab);
+        slab_push(&(cache -> partial), slab);
+    }
+    slot -> header.next_free = slab -> free_slots;
+    slab -> free_slots = slot;
+    slab -> live --;
+    cache -> live --;
+    cache -> releases ++;
+    if (slab -> live == 0) {
+        // Un seul slab vide est garde, les autres sont rendus au systeme
+        slab_unlink(&(cache -> partial), slab);
+        if (cache -> spare == NULL) {
+            cache -> spare = slab;
+        } else {
+            slab_destroy(slab);
+        }
+    }
+}
+
+void ei_slab_get_stats(ei_slab_cache_t* cache, ei_slab_stats_t* stats){
+    stats -> object_size = cache -> object_size;
+    stats -> objects_per_slab = cache -> objects_per_slab;
+    stats -> slabs = cache -> slabs;
+    stats -> live = cache -> live;
+    stats -> peak = cache -> peak;
+    stats -> allocations = cache -> allocations;
+    stats -> releases = cache -> releases;
+    if (cache -> slabs == 0) {
+        stats -> utilization = 0;
+    } else {
+        stats -> utilization = (float) cache -> live
+            / (cache -> slabs * cache -> objects_per_slab);
+    }
+}
+
+void ei_widgetclass_set_slab(ei_widgetclass_t* widgetclass, size_t widget_size){
+    ei_widgetclass_id_t id = ei_widgetclass_get_id(widgetclass);
+    if (id == ei_class_none || CLASS_SLABS[id] != NULL) {
+        return;
+    }
+    CLASS_SLABS[id] = ei_slab_cache_create(widget_size);
+}
+
+ei_slab_cache_t* ei_widgetclass_get_slab(ei_widgetclass_id_t id){
+    if (id >= EI_MAX_CLASSES) {
+        return NULL;
+    }
+    return CLASS_SLABS[id];
+}
+
+ei_bool_t ei_widgetclass_get_stats(ei_widgetclass_name_t name, ei_slab_stats_t* stats){
+    ei_slab_cache_t* cache = ei_widgetclass_get_slab(ei_widgetclass_lookup(name));
+    if (cache == NULL) {
+        return EI_FALSE;
+    }
+    ei_slab_get_stats(cache, stats);
+    return EI_TRUE;
+}
+
+void ei_widgetclass_free_slabs(){
+    for (int i = 0; i < EI_MAX_CLASSES; i++) {
+        if (CLASS_SLABS[i] != NULL) {
+            ei_slab_cache_destroy(CLASS_SLABS[i]);
+            CLASS_SLABS[i] = NULL;
+        }
+    }
+}
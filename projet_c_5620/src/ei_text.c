@@ -0,0 +1,133 @@
+/**
+ *  @file	ei_text.c
+ *  @brief	Measurement of texts: the size of a text in a font is computed once by
+ *		\ref hw_text_compute_size, without rendering it, and kept in a cache.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "ei_text.h"
+#include "hw_interface.h"
+
+/* Nombre de listes de la table, une puissance de 2 */
+#define BUCKETS		256
+/* Au dela, le cache est vide avant d'ajouter une taille */
+#define MAX_ENTRIES	4096
+
+/**
+ * \brief	A size in the cache, for a text in a font.
+ */
+typedef struct ei_text_entry_t {
+    char*			text;
+    ei_font_t			font;
+    uint32_t			hash;
+    ei_size_t			size;
+    struct ei_text_entry_t*	next;
+} ei_text_entry_t;
+
+static ei_text_entry_t* TABLE[BUCKETS];
+static int ENTRIES = 0;
+static unsigned long HITS = 0;
+static unsigned long MISSES = 0;
+/* Les drawfuncs mesurent leur texte depuis les workers du rendu */
+static pthread_mutex_t LOCK = PTHREAD_MUTEX_INITIALIZER;
+/* La bibliotheque de polices n'est pas reentrante : un seul appel a la fois */
+static pthread_mutex_t FONT_LOCK = PTHREAD_MUTEX_INITIALIZER;
+
+static void cache_clear();
+
+/**
+ * \brief	FNV-1a hash of the text, mixed with the address of the font.
+ */
+static uint32_t text_hash(const char* text, ei_font_t font){
+    uint32_t hash = 2166136261u;
+    for (const char* c = text; *c != '\0'; c++) {
+        hash ^= (unsigned char) *c;
+        hash *= 16777619u;
+    }
+    uintptr_t address = (uintptr_t) font;
+    hash ^= (uint32_t) (address ^ (address >> 16));
+    hash *= 16777619u;
+    return hash;
+}
+
+ei_size_t ei_text_measure(const char* text, ei_font_t font){
+    ei_size_t size = {0, 0};
+    if (text == NULL) {
+        return size;
+    }
+    if (font == NULL) {
+        font = ei_default_font;
+    }
+    uint32_t hash = text_hash(text, font);
+    pthread_mutex_lock(&LOCK);
+    ei_text_entry_t* entry = TABLE[hash & (BUCKETS - 1)];
+    while (entry != NULL) {
+        if (entry -> hash == hash && entry -> font == font
+            && strcmp(entry -> text, text) == 0) {
+            HITS ++;
+            size = entry -> size;
+            pthread_mutex_unlock(&LOCK);
+            return size;
+        }
+        entry = entry -> next;
+    }
+    MISSES ++;
+    ei_text_lock_fonts();
+    hw_text_compute_size(text, font, &(size.width), &(size.height));
+    ei_text_unlock_fonts();
+    if (ENTRIES == MAX_ENTRIES) {
+        cache_clear();
+    }
+    entry = malloc(sizeof(ei_text_entry_t));
+    entry -> text = malloc(strlen(text) + 1);
+    strcpy(entry -> text, text);
+    entry -> font = font;
+    entry -> hash = hash;
+    entry -> size = size;
+    entry -> next = TABLE[hash & (BUCKETS - 1)];
+    TABLE[hash & (BUCKETS - 1)] = entry;
+    ENTRIES ++;
+    pthread_mutex_unlock(&LOCK);
+    return size;
+}
+
+void ei_text_lock_fonts(){
+    pthread_mutex_lock(&FONT_LOCK);
+}
+
+void ei_text_unlock_fonts(){
+    pthread_mutex_unlock(&FONT_LOCK);
+}
+
+void ei_text_get_stats(ei_text_stats_t* stats){
+    pthread_mutex_lock(&LOCK);
+    stats -> hits = HITS;
+    stats -> misses = MISSES;
+    stats -> entries = ENTRIES;
+    pthread_mutex_unlock(&LOCK);
+}
+
+void ei_text_free_cache(){
+    pthread_mutex_lock(&LOCK);
+    cache_clear();
+    pthread_mutex_unlock(&LOCK);
+}
+
+/**
+ * \brief	Frees all the entries. Called with the lock held.
+ */
+static void cache_clear(){
+    for (int i = 0; i < BUCKETS; i++) {
+        while (TABLE[i] != NULL) {
+            ei_text_entry_t* next = TABLE[i] -> next;
+            free(TABLE[i] -> text);
+            free(TABLE[i]);
+            TABLE[i] = next;
+        }
+    }
+    ENTRIES = 0;
+}
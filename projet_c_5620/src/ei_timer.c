@@ -0,0 +1,273 @@
+/**
+ *  @file	ei_timer.c
+ *  @brief	Timers multiplexed on a single application event (see \ref hw_event_schedule_app)
+ *		with a hierarchical timing wheel: adding, cancelling and firing a timer do not
+ *		depend on the number of timers.
+ *
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include "ei_timer.h"
+#include "hw_interface.h"
+
+#define max(a,b) ((a) > (b) ? a : b)
+#define min(a,b) ((a) < (b) ? a : b)
+
+/* Roue de niveau 0 : une case par milliseconde, 256 cases */
+#define LEVEL0_BITS	8
+/* Roues superieures : 64 cases, chacune couvre une roue entiere du niveau inferieur */
+#define LEVELN_BITS	6
+#define LEVELS		4
+#define LEVEL0_SIZE	(1 << LEVEL0_BITS)
+#define LEVELN_SIZE	(1 << LEVELN_BITS)
+/* Au dela (environ 18 heures), le timer est range dans la derniere case et re-range */
+#define MAX_RANGE	(1LL << (LEVEL0_BITS + (LEVELS - 1) * LEVELN_BITS))
+/* Nombre maximal de reveils programmes en meme temps aupres de hw */
+#define WAKES		8
+
+struct ei_timer_t {
+    long long		expires;
+    ei_timer_callback_t	callback;
+    void*		user_param;
+    struct ei_timer_t**	list;
+    struct ei_timer_t*	prev;
+    struct ei_timer_t*	next;
+};
+
+/**
+ * \brief	A wake up scheduled with \ref hw_event_schedule_app. Its address is
+ * the user_param of the event.
+ */
+typedef struct ei_timer_wake_t {
+    ei_bool_t		pending;
+    long long		tick;
+} ei_timer_wake_t;
+
+static ei_timer_t* LEVEL0[LEVEL0_SIZE];
+static ei_timer_t* LEVELN[LEVELS - 1][LEVELN_SIZE];
+/* Timers expires en cours d'appel : ils peuvent encore etre annules */
+static ei_timer_t* EXPIRED = NULL;
+/* Toutes les echeances <= CURRENT ont ete traitees */
+static long long CURRENT = 0;
+static int COUNT = 0;
+static ei_bool_t ADVANCING = EI_FALSE;
+static ei_timer_wake_t WAKE[WAKES];
+
+static long long now_tick(){
+    return (long long) floor(hw_now() * 1000);
+}
+
+/**
+ * \brief	Returns the shift of the ticks covered by one slot of a level.
+ */
+static int level_shift(int level){
+    return LEVEL0_BITS + (level - 1) * LEVELN_BITS;
+}
+
+static void list_push(ei_timer_t** list, ei_timer_t* timer){
+    timer -> list = list;
+    timer -> prev = NULL;
+    timer -> next = *list;
+    if (*list != NULL) {
+        (*list) -> prev = timer;
+    }
+    *list = timer;
+}
+
+static void list_remove(ei_timer_t* timer){
+    if (timer -> prev != NULL) {
+        timer -> prev -> next = timer -> next;
+    } else {
+        *(timer -> list) = timer -> next;
+    }
+    if (timer -> next != NULL) {
+        timer -> next -> prev = timer -> prev;
+    }
+    timer -> list = NULL;
+}
+
+/**
+ * \brief	Puts a timer in the slot matching its expiration, relatively to
+ * \ref CURRENT.
+ */
+static void wheel_insert(ei_timer_t* timer){
+    long long expires = min(timer -> expires, CURRENT + MAX_RANGE - 1);
+    long long delta = expires - CURRENT;
+    if (delta < LEVEL0_SIZE) {
+        list_push(&LEVEL0[expires & (LEVEL0_SIZE - 1)], timer);
+        return;
+    }
+    for (int level = 1; level < LEVELS; level++) {
+        int shift = level_shift(level);
+        if (level == LEVELS - 1 || delta < (1LL << (shift + LEVELN_BITS))) {
+            list_push(&LEVELN[level - 1][(expires >> shift) & (LEVELN_SIZE - 1)], timer);
+            return;
+        }
+    }
+}
+
+/**
+ * \brief	Moves the timers of a slot of an upper level to the lower levels.
+ */
+static void cascade(ei_timer_t** slot){
+    ei_timer_t* timer = *slot;
+    *slot = NULL;
+    while (timer != NULL) {
+        ei_timer_t* next = timer -> next;
+        wheel_insert(timer);
+        timer = next;
+    }
+}
+
+/**
+ * \brief	Processes one more tick: cascades the upper levels when the level 0
+ * wraps, then calls the timers of the slot.
+ */
+static void wheel_step(){
+    CURRENT ++;
+    int index = CURRENT & (LEVEL0_SIZE - 1);
+    for (int level = 1; index == 0 && level < LEVELS; level++) {
+        index = (CURRENT >> level_shift(level)) & (LEVELN_SIZE - 1);
+        cascade(&LEVELN[level - 1][index]);
+    }
+    ei_timer_t** slot = &LEVEL0[CURRENT & (LEVEL0_SIZE - 1)];
+    while (*slot != NULL) {
+        ei_timer_t* timer = *slot;
+        list_remove(timer);
+        if (timer -> expires > CURRENT) {
+            // Timer au dela de MAX_RANGE : pas encore expire
+            wheel_insert(timer);
+        } else {
+            list_push(&EXPIRED, timer);
+        }
+    }
+    while (EXPIRED != NULL) {
+        ei_timer_t* timer = EXPIRED;
+        list_remove(timer);
+        COUNT --;
+        (timer -> callback)(timer -> user_param);
+        free(timer);
+    }
+}
+
+/**
+ * \brief	Returns the first tick at which the wheel has something to do (call a
+ * timer or cascade a non empty slot), or -1 if there is no timer.
+ */
+static long long wheel_next_tick(){
+    if (COUNT == 0) {
+        return -1;
+    }
+    for (int k = 1; k <= LEVEL0_SIZE; k++) {
+        if (LEVEL0[(CURRENT + k) & (LEVEL0_SIZE - 1)] != NULL) {
+            return CURRENT + k;
+        }
+    }
+    long long next = -1;
+    for (int level = 1; level < LEVELS; level++) {
+        int shift = level_shift(level);
+        for (int k = 1; k <= LEVELN_SIZE; k++) {
+            long long boundary = ((CURRENT >> shift) + k) << shift;
+            if (LEVELN[level - 1][(boundary >> shift) & (LEVELN_SIZE - 1)] != NULL) {
+                if (next < 0 || boundary < next) {
+                    next = boundary;
+                }
+                break;
+            }
+        }
+    }
+    return next;
+}
+
+/**
+ * \brief	Makes sure that a wake up is scheduled no later than the next tick
+ * of the wheel. A single wake up is pending most of the time: another one is
+ * only scheduled when a new timer expires before it.
+ */
+static void wheel_schedule(){
+    long long next = wheel_next_tick();
+    if (next < 0) {
+        return;
+    }
+    ei_timer_wake_t* free_wake = NULL;
+    for (int i = 0; i < WAKES; i++) {
+        if (WAKE[i].pending == EI_FALSE) {
+            free_wake = &WAKE[i];
+        } else if (WAKE[i].tick <= next) {
+            return;
+        }
+    }
+    if (free_wake != NULL) {
+        free_wake -> pending = EI_TRUE;
+        free_wake -> tick = next;
+        hw_event_schedule_app(max(1, (int) (next - now_tick())), free_wake);
+    }
+}
+
+ei_timer_t* ei_timer_add(int ms_delay, ei_timer_callback_t callback, void* user_param){
+    long long now = now_tick();
+    if (COUNT == 0 && ADVANCING == EI_FALSE) {
+        CURRENT = now;
+    }
+    ei_timer_t* timer = calloc(1, sizeof(ei_timer_t));
+    timer -> expires = max(CURRENT + 1, now + max(0, ms_delay));
+    timer -> callback = callback;
+    timer -> user_param = user_param;
+    wheel_insert(timer);
+    COUNT ++;
+    if (ADVANCING == EI_FALSE) {
+        wheel_schedule();
+    }
+    return timer;
+}
+
+void ei_timer_cancel(ei_timer_t* timer){
+    if (timer == NULL || timer -> list == NULL) {
+        return;
+    }
+    list_remove(timer);
+    COUNT --;
+    free(timer);
+}
+
+ei_bool_t ei_timer_handle_event(ei_event_t* event){
+    if (event -> type != ei_ev_app) {
+        return EI_FALSE;
+    }
+    ei_timer_wake_t* wake = (ei_timer_wake_t*) event -> param.application.user_param;
+    if (wake < &WAKE[0] || wake >= &WAKE[WAKES]) {
+        return EI_FALSE;
+    }
+    wake -> pending = EI_FALSE;
+    long long now = now_tick();
+    ADVANCING = EI_TRUE;
+    if (COUNT == 0) {
+        CURRENT = max(CURRENT, now);
+    }
+    while (CURRENT < now && COUNT > 0) {
+        wheel_step();
+    }
+    ADVANCING = EI_FALSE;
+    wheel_schedule();
+    return EI_TRUE;
+}
+
+int ei_timer_pending(){
+    return COUNT;
+}
+
+void ei_timer_free_all(){
+    for (int i = 0; i < LEVEL0_SIZE; i++) {
+        while (LEVEL0[i] != NULL) {
+            ei_timer_cancel(LEVEL0[i]);
+        }
+    }
+    for (int level = 1; level < LEVELS; level++) {
+        for (int i = 0; i < LEVELN_SIZE; i++) {
+            while (LEVELN[level - 1][i] != NULL) {
+                ei_timer_cancel(LEVELN[level - 1][i]);
+            }
+        }
+    }
+}
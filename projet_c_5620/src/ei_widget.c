@@ -15,6 +15,10 @@
 #include "ei_draw_extension.h"
 #include "ei_application.h"
 #include "ei_event.h"
+#include "ei_animation.h"
+#include "ei_slab.h"
+#include "ei_arena.h"
+#include "ei_grid.h"
 
 /**
  * @brief	Creates a new instance of a widget of some particular class, as a descendant of
@@ -29,35 +33,157 @@
  * @return			The newly created widget, or NULL if there was an error.
  */
 uint32_t COLOR_ID = 1;
+/* Nombre de widgets vivants dont la classe n'est pas une classe de la bibliotheque */
+static int USER_WIDGETS = 0;
 #define max(a,b) ((a) > (b) ? a : b)
 #define min(a,b) ((a) < (b) ? a : b)
 
+/* Registre des classes : table de hachage des noms, indexee ensuite par identifiant */
+#define REGISTRY_SLOTS	128
+
+/**
+ * \brief	A class name of the registry, and the class registered with this name.
+ */
+typedef struct {
+    ei_widgetclass_name_t	name;
+    ei_widgetclass_id_t		id;
+    ei_widgetclass_t*		widgetclass;
+} ei_class_entry_t;
+
+/* CLASSES[id], l'entree 0 (ei_class_none) n'est pas utilisee */
+static ei_class_entry_t CLASSES[EI_MAX_CLASSES];
+static int CLASS_COUNT = 0;
+/* Identifiants ranges par hachage du nom, 0 pour une case vide */
+static ei_widgetclass_id_t REGISTRY[REGISTRY_SLOTS];
+
+static uint32_t registry_hash(const char* name){
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < (int) sizeof(ei_widgetclass_name_t) && name[i] != '\0'; i++) {
+        hash ^= (unsigned char) name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static ei_class_entry_t* registry_find(const char* name, ei_bool_t create);
+
+/**
+ * \brief	Interns the names of the classes of the library first, so that they get the
+ * identifiers of \ref ei_widgetclass_builtin_t.
+ */
+static void registry_init(){
+    if (CLASS_COUNT == 0) {
+        CLASS_COUNT = ei_class_frame;
+        registry_find("frame", EI_TRUE);
+        registry_find("button", EI_TRUE);
+        registry_find("toplevel", EI_TRUE);
+        registry_find("scrollframe", EI_TRUE);
+        registry_find("listbox", EI_TRUE);
+    }
+}
+
+/**
+ * \brief	Finds the entry of a class name, by open addressing.
+ *
+ * @param	name		The name of the class.
+ * @param	create		If EI_TRUE, the entry is added when the name is unknown.
+ *
+ * @return			The entry, or NULL.
+ */
+static ei_class_entry_t* registry_find(const char* name, ei_bool_t create){
+    registry_init();
+    uint32_t slot = registry_hash(name) % REGISTRY_SLOTS;
+    while (REGISTRY[slot] != ei_class_none) {
+        ei_class_entry_t* entry = &CLASSES[REGISTRY[slot]];
+        if (strncmp(entry -> name, name, sizeof(ei_widgetclass_name_t)) == 0) {
+            return entry;
+        }
+        slot = (slot + 1) % REGISTRY_SLOTS;
+    }
+    if (create == EI_FALSE || CLASS_COUNT == EI_MAX_CLASSES) {
+        return NULL;
+    }
+    ei_class_entry_t* entry = &CLASSES[CLASS_COUNT];
+    strncpy(entry -> name, name, sizeof(ei_widgetclass_name_t) - 1);
+    entry -> name[sizeof(ei_widgetclass_name_t) - 1] = '\0';
+    entry -> id = CLASS_COUNT;
+    entry -> widgetclass = NULL;
+    REGISTRY[slot] = entry -> id;
+    CLASS_COUNT ++;
+    return entry;
+}
+
 
 
 
 
 ei_widget_t*		ei_widget_create		(ei_widgetclass_name_t	class_name,
         ei_widget_t*		parent){
-    ei_widgetclass_t *class = ei_widgetclass_from_name(class_name);
-    ei_widget_t *widget = (*(class -> allocfunc))();
-    widget -> wclass = class;
-    widget -> parent = parent;
-    if ( (parent -> children_head) == NULL){
-        parent -> children_head = widget;
-        parent -> children_tail = widget;
-    } else {
-        ei_widget_t* child = parent -> children_tail;
-        child -> next_sibling = widget;
-        parent -> children_tail = widget;
+    // L'entree du registre donne la classe et son identifiant en une recherche
+    ei_class_entry_t* entry = registry_find(class_name, EI_FALSE);
+    if (entry == NULL || entry -> widgetclass == NULL) {
+        return NULL;
     }
-    (widget -> wclass -> setdefaultsfunc)(widget);
+    ei_widget_t *widget = ei_widget_alloc(entry -> widgetclass, entry -> id);
     widget -> pick_id = COLOR_ID;
     widget -> pick_color = convert_pick_id_to_pick_color(COLOR_ID);
+    ei_widget_links(widget) -> class_id = entry -> id;
     COLOR_ID ++;
+    ei_widget_append(parent, widget);
+    if (ei_widget_links(widget) -> class_id >= ei_class_first_user) {
+        USER_WIDGETS ++;
+    }
+    (widget -> wclass -> setdefaultsfunc)(widget);
     return widget;
 
 }
 
+/**
+ * @brief	Allocates a widget of a class: from the slab cache of the class if it has one,
+ *		with its allocfunc otherwise.
+ *
+ * @param	class		The class of the widget.
+ * @param	id		The identifier of the class.
+ *
+ * @return			The widget, with all bytes set to 0 except its class.
+ */
+ei_widget_t* ei_widget_alloc(ei_widgetclass_t* class, ei_widgetclass_id_t id){
+    ei_widget_t* widget;
+    ei_slab_cache_t* cache = ei_widgetclass_get_slab(id);
+    if (cache != NULL) {
+        widget = ei_slab_alloc(cache);
+    } else {
+        widget = (*(class -> allocfunc))();
+    }
+    widget -> wclass = class;
+    widget -> content_rect = &(widget -> screen_location);
+    return widget;
+}
+
+/**
+ * @brief	Releases a widget allocated by \ref ei_widget_alloc: calls the releasefunc of its
+ *		class, then frees its placer parameters, its pick color and its structure.
+ *
+ * @param	widget		The widget, already unlinked from its parent.
+ */
+void ei_widget_release(ei_widget_t* widget){
+    // L'identifiant est range avec la couleur de picking, liberee avant le widget
+    ei_widgetclass_id_t id = ei_widget_links(widget) -> class_id;
+    if (id >= ei_class_first_user) {
+        USER_WIDGETS --;
+    }
+    if (widget -> wclass -> releasefunc != NULL) {
+        (widget -> wclass -> releasefunc)(widget);
+    }
+    free(widget -> placer_params);
+    free(widget -> pick_color);
+    if (ei_widgetclass_get_slab(id) != NULL) {
+        ei_slab_free(widget);
+    } else {
+        free(widget);
+    }
+}
+
 /**
  * @brief	Converts pick_id to pick_color.
  *
@@ -67,11 +193,25 @@ ei_widget_t*		ei_widget_create		(ei_widgetclass_name_t	class_name,
  * @return			Returns the pick color.
  */
 ei_color_t* convert_pick_id_to_pick_color(uint32_t id){
-    ei_color_t* pick = calloc(1, sizeof(ei_color_t));
-    pick -> red = (char) (id << 24);
-    pick -> green = (char) (id << 16);
-    pick -> blue = (char) (id << 8);
-    pick -> alpha = (char) id;
+    // Le chainage arriere des freres est range avec la couleur, hors de ei_widget_t
+    ei_widget_links_t* links = calloc(1, sizeof(ei_widget_links_t));
+    links -> pick_color = ei_pick_id_to_color(id);
+    return &(links -> pick_color);
+}
+
+/**
+ * @brief	Converts pick_id to pick_color, by value.
+ *
+ * @param	id      The pick_id.
+ *
+ * @return			Returns the pick color.
+ */
+ei_color_t ei_pick_id_to_color(uint32_t id){
+    ei_color_t pick;
+    pick.red = (char) (id << 24);
+    pick.green = (char) (id << 16);
+    pick.blue = (char) (id << 8);
+    pick.alpha = (char) id;
     return pick;
 }
 
@@ -84,12 +224,11 @@ ei_color_t* convert_pick_id_to_pick_color(uint32_t id){
  * @return			The structure describing the class.
  */
 ei_widgetclass_t*	ei_widgetclass_from_name	(ei_widgetclass_name_t name){
-    ei_widgetclass_t *current = LIB;
-    while (strncmp(current -> name, name, strlen(name)) != 0) {
-        current = current -> next;
+    ei_class_entry_t* entry = registry_find(name, EI_FALSE);
+    if (entry == NULL) {
+        return NULL;
     }
-    return current;
-
+    return entry -> widgetclass;
 }
 /**
  * @brief	Destroys a widget. Removes it from screen if it is managed by a geometry manager.
@@ -102,40 +241,66 @@ void			ei_widget_destroy		(ei_widget_t*		widget){
     if (widget_destroy -> callback != NULL) {
         (widget_destroy -> callback)(widget, NULL, widget_destroy -> user_param);
     }
-    free_widgets(widget -> children_tail);
-    ei_widget_t* parent = (widget -> parent);
-    ei_widget_t* previous = ei_widget_previous(widget);
-    if (previous == NULL){
-        parent -> children_head = widget -> next_sibling;
-    } else if ( widget == parent -> children_tail) {
-        parent -> children_tail = previous;
-        previous -> next_sibling = NULL;
-    } else {
-        previous -> next_sibling = widget -> next_sibling;
-    }
-    (widget -> wclass -> releasefunc)(widget);
+    ei_invalidate_pick_rect(&(widget -> screen_location));
+    ei_animation_cancel_widget(widget);
+    ei_event_forget_widget(widget);
+    // Sa grille est oubliee avant ses enfants, sa cellule libere la place des autres
+    ei_grid_release(widget);
+    free_widgets(widget -> children_head);
+    widget -> children_head = NULL;
+    widget -> children_tail = NULL;
+    ei_widget_unlink(widget);
+    ei_widget_release(widget);
     ei_event_set_active_widget(NULL);
 }
 
+int ei_widget_user_class_count(){
+    return USER_WIDGETS;
+}
+
 ei_widget_t*    ei_widget_previous (ei_widget_t* widget){
-    ei_widget_t* prev = (widget -> parent) -> children_head;
-    ei_widget_t* parent = (widget -> parent);
-    if (widget == parent -> children_head){
-        return NULL;
+    return ei_widget_links(widget) -> prev_sibling;
+}
+
+/**
+ * @brief	Adds a widget at the end of the children of a parent, ie. on top of its siblings.
+ *
+ * @param	parent		The new parent of the widget.
+ * @param	widget		The widget, not linked to any parent.
+ */
+void ei_widget_append(ei_widget_t* parent, ei_widget_t* widget){
+    widget -> parent = parent;
+    widget -> next_sibling = NULL;
+    ei_widget_links(widget) -> prev_sibling = parent -> children_tail;
+    if (parent -> children_tail == NULL) {
+        parent -> children_head = widget;
+    } else {
+        parent -> children_tail -> next_sibling = widget;
     }
-    while (((prev -> next_sibling) != widget) && (prev -> next_sibling)
-    != (parent -> children_tail) && (prev -> next_sibling) != NULL){
-        prev = prev -> next_sibling;
+    parent -> children_tail = widget;
+}
+
+/**
+ * @brief	Removes a widget from the children of its parent. The widget keeps its parent
+ *		pointer.
+ *
+ * @param	widget		The widget.
+ */
+void ei_widget_unlink(ei_widget_t* widget){
+    ei_widget_t* parent = widget -> parent;
+    ei_widget_links_t* links = ei_widget_links(widget);
+    if (links -> prev_sibling == NULL) {
+        parent -> children_head = widget -> next_sibling;
+    } else {
+        links -> prev_sibling -> next_sibling = widget -> next_sibling;
     }
-    if (prev -> next_sibling != parent -> children_tail){
-        return prev;
+    if (widget -> next_sibling == NULL) {
+        parent -> children_tail = links -> prev_sibling;
     } else {
-        if (widget == parent -> children_tail) {
-            return prev;
-        } else {
-            return NULL;
-        }
+        ei_widget_links(widget -> next_sibling) -> prev_sibling = links -> prev_sibling;
     }
+    widget -> next_sibling = NULL;
+    links -> prev_sibling = NULL;
 }
 
 
@@ -148,6 +313,8 @@ ei_widget_t*    ei_widget_previous (ei_widget_t* widget){
  *				at this location (except for the root widget).
  */
 ei_widget_t*		ei_widget_pick			(ei_point_t*		where){
+    // La pick_surface n'est redessinee que si la geometrie a change
+    draw_pick();
     // Recuperer l'ID du widget qu'on cherche sur la pick_surface
     ei_surface_t pick_surface = SURFACE_PICK;
     uint32_t *pixel_ptr = (uint32_t*)hw_surface_get_buffer(pick_surface);
@@ -155,15 +322,15 @@ ei_widget_t*		ei_widget_pick			(ei_point_t*		where){
     pixel_ptr += where -> x + where -> y * surface_size.width;
     int ir, ig, ib, ia;
     hw_surface_get_channel_indices(pick_surface, &ir, &ig, &ib, &ia);
-    ei_color_t* color = calloc(1, sizeof(ei_color_t));
-    color -> red = (unsigned char)((*pixel_ptr <<((3-ir)*8)) >> 24);
-    color -> green = (unsigned char)((*pixel_ptr <<((3-ig)*8)) >> 24);
-    color -> blue = (unsigned char)((*pixel_ptr <<((3-ib)*8)) >> 24);
-    color -> alpha = (unsigned char)((*pixel_ptr <<((3-ia)*8)) >> 24);
-    uint32_t pick_id = color -> red << 24;
-    pick_id += color -> green << 16;
-    pick_id += color -> blue << 8;
-    pick_id += color -> alpha;
+    ei_color_t color;
+    color.red = (unsigned char)((*pixel_ptr <<((3-ir)*8)) >> 24);
+    color.green = (unsigned char)((*pixel_ptr <<((3-ig)*8)) >> 24);
+    color.blue = (unsigned char)((*pixel_ptr <<((3-ib)*8)) >> 24);
+    color.alpha = (unsigned char)((*pixel_ptr <<((3-ia)*8)) >> 24);
+    uint32_t pick_id = color.red << 24;
+    pick_id += color.green << 16;
+    pick_id += color.blue << 8;
+    pick_id += color.alpha;
     // Parcours de tous les widgets
     ei_widget_t* current = ei_app_root_widget();
     return ei_find_pick_color(current, pick_id);
@@ -204,54 +371,54 @@ ei_widget_t* ei_find_pick_color(ei_widget_t* widget, uint32_t pick_id) {
  *
  * @return  The top_left point to start drawing
  */
-ei_point_t* ei_get_where(ei_rect_t rectangle, ei_anchor_t* anchor,
+ei_point_t ei_anchor_point(ei_rect_t rectangle, ei_anchor_t* anchor,
     int border_width, ei_size_t size) {
-    ei_point_t* where = calloc(1, sizeof(ei_point_t));
+    ei_point_t where = {0, 0};
     ei_point_t point_ancre = {rectangle.top_left.x + rectangle.size.width/2,
         rectangle.top_left.y + rectangle.size.height/2};
     switch (*anchor) {
         case ei_anc_none:
         case ei_anc_center:
-            where -> x = point_ancre.x - 0.5 * size.width;
-            where -> y = point_ancre.y - 0.5 * size.height;
+            where.x = point_ancre.x - 0.5 * size.width;
+            where.y = point_ancre.y - 0.5 * size.height;
             break;
         case ei_anc_northwest:
-            where -> x = point_ancre.x - ((rectangle.size.width)/2) + border_width;
-            where -> y = point_ancre.y - ((rectangle.size.height)/2) + border_width;
+            where.x = point_ancre.x - ((rectangle.size.width)/2) + border_width;
+            where.y = point_ancre.y - ((rectangle.size.height)/2) + border_width;
             break;
         case ei_anc_west:
-            where -> x = point_ancre.x - ((rectangle.size.width)/2) + border_width;
-            where -> y = point_ancre.y - 0.5 * size.height;
+            where.x = point_ancre.x - ((rectangle.size.width)/2) + border_width;
+            where.y = point_ancre.y - 0.5 * size.height;
             break;
         case ei_anc_southwest:
-            where -> x = point_ancre.x - (rectangle.size.width/2) + border_width;
-            where -> y = point_ancre.y + (rectangle.size.height/2) -
+            where.x = point_ancre.x - (rectangle.size.width/2) + border_width;
+            where.y = point_ancre.y + (rectangle.size.height/2) -
             size.height - border_width;
             break;
         case ei_anc_south:
-            where -> x = point_ancre.x - 0.5 * size.width;
-            where -> y = point_ancre.y + (rectangle.size.height/2) -
+            where.x = point_ancre.x - 0.5 * size.width;
+            where.y = point_ancre.y + (rectangle.size.height/2) -
             size.height - border_width;
             break;
         case ei_anc_southeast:
-            where -> x = point_ancre.x + (rectangle.size.width/2) -
+            where.x = point_ancre.x + (rectangle.size.width/2) -
             size.width - border_width;
-            where -> y = point_ancre.y + (rectangle.size.height/2) -
+            where.y = point_ancre.y + (rectangle.size.height/2) -
              size.height - border_width;
             break;
         case ei_anc_east:
-            where -> x = point_ancre.x + (rectangle.size.width/2) -
+            where.x = point_ancre.x + (rectangle.size.width/2) -
             size.width - border_width;
-            where -> y = point_ancre.y - 0.5 * size.height;
+            where.y = point_ancre.y - 0.5 * size.height;
             break;
         case ei_anc_northeast:
-            where -> x = point_ancre.x + (rectangle.size.width/2) -
+            where.x = point_ancre.x + (rectangle.size.width/2) -
             size.width - 2*border_width;
-            where -> y = point_ancre.y - ((rectangle.size.height)/2) + border_width;
+            where.y = point_ancre.y - ((rectangle.size.height)/2) + border_width;
             break;
         case ei_anc_north:
-            where -> x = point_ancre.x - 0.5 * (size.width);
-            where -> y = point_ancre.y - ((rectangle.size.height)/2) + border_width;
+            where.x = point_ancre.x - 0.5 * (size.width);
+            where.y = point_ancre.y - ((rectangle.size.height)/2) + border_width;
             break;
         default:
             break;
@@ -259,21 +426,112 @@ ei_point_t* ei_get_where(ei_rect_t rectangle, ei_anchor_t* anchor,
     return where;
 }
 
-ei_rect_t* ei_union(ei_rect_t* rect1, ei_rect_t* rect2) {
+ei_point_t* ei_get_where(ei_rect_t rectangle, ei_anchor_t* anchor,
+    int border_width, ei_size_t size) {
+    ei_point_t* where = ei_arena_alloc(sizeof(ei_point_t));
+    *where = ei_anchor_point(rectangle, anchor, border_width, size);
+    return where;
+}
+
+ei_rect_t ei_rect_union(const ei_rect_t* rect1, const ei_rect_t* rect2) {
     ei_point_t point1 = rect1 -> top_left;
     ei_point_t point2 = rect2 -> top_left;
-    ei_size_t size1 = rect1 -> size;
-    ei_size_t size2 = rect2 -> size;
-    ei_rect_t* intersection = malloc(sizeof(ei_rect_t));
-    intersection -> top_left.x = min(point1.x, point2.x);
-    intersection -> top_left.y = min(point1.y, point2.y);
-    intersection -> size.width = max(size1.width, size2.width) +
-    abs(point1.x - point2.x);
-    intersection -> size.height = max(size1.height, size2.height) +
-    abs(point1.y - point2.y);
-    return intersection;
+    ei_rect_t bounds;
+    bounds.top_left.x = min(point1.x, point2.x);
+    bounds.top_left.y = min(point1.y, point2.y);
+    bounds.size.width = max(point1.x + rect1 -> size.width,
+        point2.x + rect2 -> size.width) - bounds.top_left.x;
+    bounds.size.height = max(point1.y + rect1 -> size.height,
+        point2.y + rect2 -> size.height) - bounds.top_left.y;
+    return bounds;
+}
+
+ei_rect_t* ei_union(ei_rect_t* rect1, ei_rect_t* rect2) {
+    ei_rect_t* bounds = ei_arena_alloc(sizeof(ei_rect_t));
+    *bounds = ei_rect_union(rect1, rect2);
+    return bounds;
+}
+
+
+void ei_widget_configured(ei_widget_t* widget, ei_attr_mask_t changed) {
+    if ((changed & EI_ATTR_LAYOUT) && widget -> placer_params != NULL) {
+        // L'ancienne position est effacee, la nouvelle est dessinee plus bas
+        ei_app_invalidate_rect(&(widget -> screen_location));
+        if (ei_grid_is_managed(widget) == EI_TRUE) {
+            // La grille recalcule la ligne et la colonne du widget
+            ei_grid_update(widget);
+        } else {
+            ei_placer_params_t* params = widget -> placer_params;
+            if (params -> w == NULL) {
+                params -> w_data = (widget -> requested_size).width;
+            }
+            if (params -> h == NULL) {
+                params -> h_data = (widget -> requested_size).height;
+            }
+            // La nouvelle position est calculee par la passe du placeur, qui l'invalide
+            ei_placer_invalidate(widget);
+        }
+    }
+    if (changed & EI_ATTR_VISIBLE) {
+        ei_app_invalidate_rect(&(widget -> screen_location));
+    }
+}
+
+ei_bool_t ei_color_equal(ei_color_t color1, ei_color_t color2) {
+    if (color1.red == color2.red && color1.green == color2.green
+        && color1.blue == color2.blue && color1.alpha == color2.alpha) {
+        return EI_TRUE;
+    }
+    return EI_FALSE;
+}
+
+ei_bool_t ei_rect_equal(const ei_rect_t* rect1, const ei_rect_t* rect2) {
+    if (rect1 -> top_left.x == rect2 -> top_left.x
+        && rect1 -> top_left.y == rect2 -> top_left.y
+        && rect1 -> size.width == rect2 -> size.width
+        && rect1 -> size.height == rect2 -> size.height) {
+        return EI_TRUE;
+    }
+    return EI_FALSE;
+}
+
+ei_bool_t ei_string_equal(const char* string1, const char* string2) {
+    if (string1 == NULL || string2 == NULL) {
+        return (string1 == string2) ? EI_TRUE : EI_FALSE;
+    }
+    return (strcmp(string1, string2) == 0) ? EI_TRUE : EI_FALSE;
+}
+
+ei_bool_t ei_widget_is_decoration(ei_widget_t* widget) {
+    if (widget -> parent == NULL
+        || ei_widget_is(widget -> parent, ei_class_toplevel) == EI_FALSE) {
+        return EI_FALSE;
+    }
+    ei_toplevel_t* toplevel = (ei_toplevel_t*) widget -> parent;
+    return (toplevel -> button_closable == widget) ? EI_TRUE : EI_FALSE;
 }
 
+ei_bool_t ei_widget_opaque_rect(ei_widget_t* widget, ei_rect_t* rect) {
+    *rect = widget -> screen_location;
+    if (ei_widget_is(widget, ei_class_frame) == EI_TRUE) {
+        return (((ei_frame_t*) widget) -> color.alpha == 255) ? EI_TRUE : EI_FALSE;
+    }
+    if (ei_widget_is(widget, ei_class_button) == EI_TRUE) {
+        ei_button_t* button = (ei_button_t*) widget;
+        return (button -> color.alpha == 255 && button -> corner_radius == 0)
+            ? EI_TRUE : EI_FALSE;
+    }
+    if (ei_widget_is(widget, ei_class_toplevel) == EI_TRUE) {
+        // Sous les coins arrondis de la banniere, la fenetre est rectangulaire
+        if (((ei_toplevel_t*) widget) -> color.alpha != 255) {
+            return EI_FALSE;
+        }
+        rect -> top_left.y += 10;
+        rect -> size.height -= 10;
+        return (rect -> size.height > 0) ? EI_TRUE : EI_FALSE;
+    }
+    return EI_FALSE;
+}
 
 ei_bool_t is_on_the_banner(ei_widget_t* widget, ei_event_t* event) {
     ei_toplevel_t* toplevel = (ei_toplevel_t*) widget;
@@ -282,7 +540,7 @@ ei_bool_t is_on_the_banner(ei_widget_t* widget, ei_event_t* event) {
     x_min = widget -> screen_location.top_left.x;
     y_min = widget -> screen_location.top_left.y;
     x_max = widget -> screen_location.top_left.x + widget -> screen_location.size.width;
-    y_max = y_min + 30 + *(toplevel -> border_width);
+    y_max = y_min + 30 + toplevel -> border_width;
     if (x_min <= where.x && x_max >= where.x && y_min <= where.y
         && y_max >= where.y) {
         return EI_TRUE;
@@ -295,11 +553,11 @@ ei_bool_t is_on_the_square(ei_widget_t* widget, ei_event_t* event) {
     ei_point_t where = event -> param.mouse.where;
     int x_min, x_max, y_min, y_max;
     x_min = widget -> screen_location.top_left.x + widget -> screen_location.size.width
-     - 10 - *(toplevel -> border_width);
+     - 10 - toplevel -> border_width;
     y_min = widget -> screen_location.top_left.y + widget -> screen_location.size.height
-     - 10 - *(toplevel -> border_width);
-    x_max = x_min + 10 + *(toplevel -> border_width);
-    y_max = y_min + 10 + *(toplevel -> border_width);
+     - 10 - toplevel -> border_width;
+    x_max = x_min + 10 + toplevel -> border_width;
+    y_max = y_min + 10 + toplevel -> border_width;
     if (x_min <= where.x && x_max >= where.x && y_min <= where.y && y_max >= where.y) {
         return EI_TRUE;
     }
@@ -321,4 +579,56 @@ void			ei_widgetclass_register		(ei_widgetclass_t* widgetclass){
         current = current -> next;
     }
     current -> next = widgetclass;
+    ei_class_entry_t* entry = registry_find(widgetclass -> name, EI_TRUE);
+    if (entry != NULL) {
+        entry -> widgetclass = widgetclass;
+    }
+}
+
+ei_widgetclass_id_t	ei_widgetclass_intern		(const char* name){
+    ei_class_entry_t* entry = registry_find(name, EI_TRUE);
+    if (entry == NULL) {
+        return ei_class_none;
+    }
+    return entry -> id;
+}
+
+ei_widgetclass_id_t	ei_widgetclass_lookup		(const char* name){
+    ei_class_entry_t* entry = registry_find(name, EI_FALSE);
+    if (entry == NULL) {
+        return ei_class_none;
+    }
+    return entry -> id;
+}
+
+ei_widgetclass_id_t	ei_widgetclass_get_id		(ei_widgetclass_t* widgetclass){
+    ei_class_entry_t* entry = registry_find(widgetclass -> name, EI_FALSE);
+    if (entry == NULL || entry -> widgetclass != widgetclass) {
+        return ei_class_none;
+    }
+    return entry -> id;
+}
+
+ei_widgetclass_t*	ei_widgetclass_from_id		(ei_widgetclass_id_t id){
+    if (id == ei_class_none || id >= (ei_widgetclass_id_t) CLASS_COUNT) {
+        return NULL;
+    }
+    return CLASSES[id].widgetclass;
+}
+
+ei_bool_t		ei_widget_is			(ei_widget_t* widget,
+							 ei_widgetclass_id_t id){
+    if (id == ei_class_none || id >= (ei_widgetclass_id_t) CLASS_COUNT
+        || CLASSES[id].widgetclass == NULL) {
+        return EI_FALSE;
+    }
+    return widget -> wclass == CLASSES[id].widgetclass;
+}
+
+/**
+ * \brief	Empties the registry of the class names. Called by \ref free_class.
+ */
+void ei_widgetclass_free_registry(){
+    memset(REGISTRY, 0, sizeof(REGISTRY));
+    CLASS_COUNT = 0;
 }
@@ -10,6 +10,9 @@
 #include "ei_widget_frame.h"
 #include "ei_widget_button.h"
 #include "ei_widget_toplevel.h"
+#include "ei_slab.h"
+#include "ei_text.h"
+#include "ei_image.h"
 
 #define max(a,b) ((a) > (b) ? a : b)
 #define min(a,b) ((a) < (b) ? a : b)
@@ -21,10 +24,7 @@
  */
 void button_closable(ei_widget_t* widget, ei_event_t* event, void* user_param)
 {
-    if (DRAW_RECT == NULL){
-        DRAW_RECT = calloc(1, sizeof(ei_linked_rect_t));
-    }
-    DRAW_RECT -> rect = widget -> parent -> screen_location;
+    ei_app_invalidate_rect(&(widget -> parent -> screen_location));
     ei_widget_destroy(widget -> parent);
 }
 
@@ -61,76 +61,130 @@ void			ei_button_configure		(ei_widget_t*		widget,
         void**			user_param){
 
     ei_button_t* button = (ei_button_t*) widget;
+    // Attributs dont la valeur change vraiment
+    ei_attr_mask_t changed = 0;
 
     if (relief != NULL) {
-        *(button -> relief) = *relief;
+        if (button -> relief != *relief) {
+            button -> relief = *relief;
+            changed |= ei_attr_relief;
+        }
+        button -> set |= ei_attr_relief;
     }
     if (border_width != NULL) {
-        *(button -> border_width) = *border_width;
+        if (button -> border_width != *border_width) {
+            button -> border_width = *border_width;
+            changed |= ei_attr_border_width;
+        }
+        button -> set |= ei_attr_border_width;
     }
     if (corner_radius != NULL) {
-        *(button -> corner_radius) = *corner_radius;
+        if (button -> corner_radius != *corner_radius) {
+            button -> corner_radius = *corner_radius;
+            changed |= ei_attr_corner_radius;
+        }
+        button -> set |= ei_attr_corner_radius;
     }
     if (callback != NULL) {
-        button -> callback = malloc(sizeof(ei_callback_t));
-        *(button -> callback) = *callback;
+        button -> callback = *callback;
+        button -> set |= ei_attr_callback;
     }
     if (user_param != NULL){
-        *(button -> user_param) = *user_param;
+        button -> user_param = *user_param;
+        button -> set |= ei_attr_user_param;
+    }
+    if (img != NULL){
+        if (button -> img != *img) {
+            // Une image du registre est partagee : le widget en garde une reference
+            ei_image_retain(*img, widget);
+            ei_image_release_holder(button -> img, widget);
+            button -> img = *img;
+            changed |= ei_attr_img;
+        }
+        button -> set |= ei_attr_img;
     }
-    if (img_rect != NULL){
-        button -> img_rect = calloc(1, sizeof(ei_rect_t*));
-        *(button -> img_rect) = calloc(1, sizeof(ei_rect_t));
-        **(button -> img_rect) = **img_rect;
+    ei_rect_t new_img_rect = button -> img_rect;
+    if (img_rect != NULL && *img_rect != NULL){
+        new_img_rect = **img_rect;
+        button -> set |= ei_attr_img_rect;
+    } else if (img != NULL && !(button -> set & ei_attr_img_rect)) {
+        // Sans rectangle, toute l'image est affichee
+        new_img_rect = hw_surface_get_rect(button -> img);
     }
-    if (img_anchor != NULL){
-        button -> img_anchor = calloc(1,sizeof(ei_anchor_t));
-        *(button -> img_anchor) = *img_anchor;
+    if (ei_rect_equal(&(button -> img_rect), &new_img_rect) == EI_FALSE) {
+        button -> img_rect = new_img_rect;
+        changed |= ei_attr_img_rect;
     }
-    if (img != NULL){
-        button -> img = calloc(1, sizeof(ei_rect_t));
-        *(button -> img) = *img;
+    if (img_anchor != NULL){
+        if (button -> img_anchor != *img_anchor) {
+            button -> img_anchor = *img_anchor;
+            changed |= ei_attr_img_anchor;
+        }
+        button -> set |= ei_attr_img_anchor;
     }
     if (text_anchor != NULL){
-        //button -> text_anchor = calloc(1, sizeof(ei_rect_t));
-        *(button -> text_anchor) = *text_anchor;
+        if (button -> text_anchor != *text_anchor) {
+            button -> text_anchor = *text_anchor;
+            changed |= ei_attr_text_anchor;
+        }
+        button -> set |= ei_attr_text_anchor;
     }
     if (text_color != NULL){
-        *(button -> text_color) = *text_color;
+        if (ei_color_equal(button -> text_color, *text_color) == EI_FALSE) {
+            button -> text_color = *text_color;
+            changed |= ei_attr_text_color;
+        }
+        button -> set |= ei_attr_text_color;
     }
     if (text_font != NULL){
-        *(button -> text_font) = *text_font;
+        if (button -> text_font != *text_font) {
+            button -> text_font = *text_font;
+            changed |= ei_attr_text_font;
+        }
+        button -> set |= ei_attr_text_font;
     }
     if (text != NULL) {
-        button -> text = calloc(1, sizeof(char*));
-        *(button -> text) = calloc(strlen(*text), sizeof(char));
-        strncpy(*(button -> text), *text, strlen(*text));
-        //*(button -> text) = *text;
+        if (ei_string_equal(button -> text, *text) == EI_FALSE) {
+            free(button -> text);
+            button -> text = NULL;
+            if (*text != NULL) {
+                button -> text = malloc(strlen(*text) + 1);
+                strcpy(button -> text, *text);
+            }
+            changed |= ei_attr_text;
+        }
+        button -> set |= ei_attr_text;
     }
     if (color != NULL) {
-        //button -> color = calloc(1, sizeof(ei_color_t));
-        *(button -> color) = *color;
+        if (ei_color_equal(button -> color, *color) == EI_FALSE) {
+            button -> color = *color;
+            changed |= ei_attr_color;
+        }
+        button -> set |= ei_attr_color;
     }
+    ei_size_t size = widget -> requested_size;
     if (requested_size != NULL){
-        widget -> requested_size = *requested_size;
-    } else {
-        if (text != NULL){
-            ei_surface_t text_surface = hw_text_create_surface(*(button -> text),
-             *(button -> text_font), (button -> text_color));
-            ei_size_t text_size = hw_surface_get_size(text_surface);
-            (widget -> requested_size).width = text_size.width +
-            *(button -> border_width)*2;
-            (widget -> requested_size).height = text_size.height +
-            *(button -> border_width)*2;
+        size = *requested_size;
+        button -> set |= ei_attr_requested_size;
+    } else if (!(button -> set & ei_attr_requested_size)
+        && (changed & (ei_attr_text | ei_attr_text_font | ei_attr_border_width
+        | ei_attr_img | ei_attr_img_rect))) {
+        // Une taille donnee par l'appelant n'est pas recalculee
+        if (text != NULL && button -> text != NULL){
+            ei_size_t text_size = ei_text_measure(button -> text, button -> text_font);
+            size.width = text_size.width + button -> border_width*2;
+            size.height = text_size.height + button -> border_width*2;
         } else if (img != NULL) {
-            ei_size_t size = (**(button -> img_rect)).size;
-            (widget -> requested_size).width = size.width +
-            *(button -> border_width)*2;
-            (widget -> requested_size).height = size.height +
-            *(button -> border_width)*2;
+            size.width = button -> img_rect.size.width + button -> border_width*2;
+            size.height = button -> img_rect.size.height + button -> border_width*2;
         }
-
     }
+    if (size.width != (widget -> requested_size).width
+        || size.height != (widget -> requested_size).height) {
+        widget -> requested_size = size;
+        changed |= ei_attr_requested_size;
+    }
+    ei_widget_configured(widget, changed);
 }
 
 
@@ -150,6 +204,7 @@ void			ei_button_register_class 	(){
     button -> setdefaultsfunc = &ei_button_setdefaultsfunc_t;
     strncpy(button -> name, "button", 20);
     ei_widgetclass_register(button);
+    ei_widgetclass_set_slab(button, sizeof(ei_button_t));
 }
 
 /**
@@ -175,31 +230,8 @@ void*	ei_button_allocfunc_t		(){
 
 void	ei_button_releasefunc_t	(struct ei_widget_t*	widget){
     ei_button_t* button = (ei_button_t*) widget;
-    free(button -> color);
-    free(button -> user_param);
-    free(button -> border_width);
-    free(button -> relief);
-    free(button -> text_font);
-    free(button -> text_color);
-    free(button -> text_anchor);
-    free(button -> img_anchor);
-    free(button -> corner_radius);
-    if (button -> callback != NULL){
-        free(button -> callback);
-    }
-    if (button -> img_rect != NULL){
-        free(*(button -> img_rect));
-        free(button -> img_rect);
-    }
-    if (button -> img != NULL){
-        free(button -> img);
-    }
-    if (button -> text != NULL) {
-        free(*(button -> text));
-        free(button -> text);
-    }
-
-    free(button);
+    free(button -> text);
+    ei_image_release_holder(button -> img, widget);
 }
 
 
@@ -221,80 +253,93 @@ void	ei_button_drawfunc_t		(struct ei_widget_t*	widget,
         ei_rect_t*		clipper){
     ei_button_t* button = (ei_button_t*) widget;
     ei_rect_t rectangle = widget -> screen_location;
-    ei_color_t color = *(button -> color);
+    ei_color_t color = button -> color;
     ei_color_t pick_color = *(widget -> pick_color);
-    int border_width = *(button -> border_width);
-    ei_relief_t relief = *(button -> relief);
-    char** text = button -> text;
-    ei_surface_t* img = button -> img;
-    ei_rect_t** img_rect = calloc(1, sizeof(ei_rect_t*));
-    ei_font_t* text_font = calloc(1, sizeof(ei_font_t));
-    ei_color_t* text_color = calloc(1, sizeof(ei_color_t));
-    ei_anchor_t *anchor = calloc(1, sizeof(ei_anchor_t));
-    ei_point_t* where = calloc(1, sizeof(ei_point_t));
-    if (img != NULL) {
-        img_rect = button -> img_rect;
-        anchor = button -> img_anchor;
-        where = ei_get_where(rectangle, anchor, border_width, (**img_rect).size);
-    } else if (text != NULL) {
-        text_font = button -> text_font;
-        text_color = button -> text_color;
-        anchor = button -> text_anchor;
-        ei_surface_t text_surface = hw_text_create_surface(*text, *text_font, &color);
-        ei_size_t text_size = hw_surface_get_size(text_surface);
-        where = ei_get_where(rectangle, anchor, border_width, text_size);
-    }
-    ei_size_t surface_size = hw_surface_get_size(surface);
-    if (color.alpha != 255){
-        ei_surface_t alpha_surface = hw_surface_create(surface, &surface_size, EI_TRUE);
-        ei_draw_button(alpha_surface, rectangle, color, *(button -> corner_radius),
-         border_width, relief, text, *text_font, text_color, img, *img_rect,
-          *where, clipper);
-        ei_copy_surface(surface,clipper, alpha_surface,clipper, EI_TRUE);
-    } else {
-        ei_draw_button(surface, rectangle, color, *(button -> corner_radius),
-         border_width, relief, text, *text_font, text_color, img, *img_rect,
-          *where, clipper);
-    }
+    if (surface != NULL) {
+        int border_width = button -> border_width;
+        ei_relief_t relief = button -> relief;
+        char* text = button -> text;
+        ei_surface_t img = button -> img;
+        ei_rect_t img_rect = button -> img_rect;
+        ei_surface_t scaled = NULL;
+        if (img != NULL && button -> img_scaling != ei_scale_none
+            && ei_image_is_placeholder(img) == EI_FALSE) {
+            // La copie redimensionnee est gardee en cache, elle n'est calculee qu'une fois
+            ei_size_t inside = {rectangle.size.width - 2*border_width,
+                rectangle.size.height - 2*border_width};
+            scaled = ei_scale_acquire(img, &img_rect,
+                ei_scale_fit_size(img_rect.size, inside, button -> img_scaling));
+            if (scaled != NULL) {
+                img = scaled;
+                img_rect = hw_surface_get_rect(scaled);
+            }
+        }
+        ei_point_t where = {0, 0};
+        if (img != NULL) {
+            where = ei_anchor_point(rectangle, &(button -> img_anchor), border_width,
+                img_rect.size);
+        } else if (text != NULL) {
+            ei_size_t text_size = ei_text_measure(text, button -> text_font);
+            where = ei_anchor_point(rectangle, &(button -> text_anchor), border_width,
+                text_size);
+        }
+        if (color.alpha != 255){
+            ei_surface_t layer = ei_layer_begin(surface, clipper);
+            ei_draw_button(layer, rectangle, color, button -> corner_radius,
+             border_width, relief, &(button -> text), button -> text_font,
+              &(button -> text_color), &(button -> img), &(button -> img_rect),
+              where, clipper);
+            ei_layer_end(surface, layer, clipper);
+        } else {
+            ei_draw_button(surface, rectangle, color, button -> corner_radius,
+             border_width, relief, &(button -> text), button -> text_font,
+              &(button -> text_color), &(button -> img), &(button -> img_rect),
+              where, clipper);
+        }
 
-    if (text != NULL) {
-        if (*text != NULL) {
+        if (text != NULL) {
             if (relief == ei_relief_sunken) {
-                where->x += 3;
-                where->y += 3;
+                where.x += 3;
+                where.y += 3;
             }
             rectangle.size.width -= 2*border_width;
             rectangle.size.height -= 2*border_width;
             rectangle.top_left.x += border_width;
             rectangle.top_left.y += border_width;
-            rectangle = *ei_intersection(&rectangle, clipper);
-            ei_draw_text(surface, where, *text, *text_font, text_color, &rectangle);
-        }
-    } else if (img != NULL) {
-        // on utilise copy
-        ei_rect_t rect = {*where, (*img_rect)->size};
-        ei_rect_t image = **img_rect;
-        ei_rect_t* intersects = ei_intersection(&rect, clipper);
-        if (clipper != NULL) {
-            if (clipper->size.width != 0 && clipper->size.height != 0) {
-                image.top_left.x += max(0,intersects ->top_left.x - where->x);
-                image.top_left.y += max(0,intersects ->top_left.y - where->y);
-                image.size = intersects -> size;
+            rectangle = ei_rect_intersection(&rectangle, clipper);
+            ei_draw_text(surface, &where, text, button -> text_font,
+                &(button -> text_color), &rectangle);
+        } else if (img != NULL && ei_image_is_placeholder(img) == EI_FALSE) {
+            // on utilise copy
+            ei_rect_t rect = {where, img_rect.size};
+            ei_rect_t image = img_rect;
+            ei_rect_t intersection = ei_rect_intersection(&rect, clipper);
+            ei_rect_t* intersects = &intersection;
+            if (clipper != NULL) {
+                if (clipper->size.width != 0 && clipper->size.height != 0) {
+                    image.top_left.x += max(0,intersects ->top_left.x - where.x);
+                    image.top_left.y += max(0,intersects ->top_left.y - where.y);
+                    image.size = intersects -> size;
+                }
             }
-        }
-        if (image.size.width != 0 && image.size.height != 0) {
-            ei_size_t surface_size = hw_surface_get_size(surface);
-            if (intersects -> top_left.x >= 0 && intersects -> top_left.y >= 0
-                 && intersects -> top_left.x <= surface_size.width
-                  && intersects -> top_left.y <= surface_size.height) {
-                    ei_copy_surface(surface, intersects, *img, &image,
-                        hw_surface_has_alpha(surface));
+            if (image.size.width != 0 && image.size.height != 0) {
+                ei_size_t surface_size = hw_surface_get_size(surface);
+                if (intersects -> top_left.x >= 0 && intersects -> top_left.y >= 0
+                     && intersects -> top_left.x <= surface_size.width
+                      && intersects -> top_left.y <= surface_size.height) {
+                        ei_copy_surface(surface, intersects, img, &image,
+                            hw_surface_has_alpha(surface));
+                }
             }
         }
+        ei_scale_release(scaled);
+    }
+    if (pick_surface != NULL) {
+        ei_point_t where = widget -> screen_location.top_left;
+        ei_draw_button(pick_surface, widget -> screen_location, pick_color,
+         button -> corner_radius, 0, ei_relief_none, NULL, ei_default_font,
+          &color, NULL, &(widget -> screen_location), where, clipper);
     }
-    ei_draw_button(pick_surface, rectangle, pick_color, *(button -> corner_radius),
-     0, ei_relief_none, NULL, ei_default_font, &color, NULL, &rectangle, *where,
-      clipper);
 }
 
 
@@ -305,30 +350,17 @@ void	ei_button_drawfunc_t		(struct ei_widget_t*	widget,
  */
 void	ei_button_setdefaultsfunc_t	(struct ei_widget_t*	widget){
     ei_button_t* button = (ei_button_t *) widget;
-    ei_color_t* color = malloc(sizeof(ei_color_t));
-    *color = ei_default_background_color;
-    button -> color = color;
-    button -> user_param = calloc(1, sizeof(void *));
-    int* border_width = calloc(1, sizeof(int));
-    button -> border_width = border_width;
-    ei_relief_t *relief = malloc(sizeof(ei_relief_t));
-    *relief = ei_relief_raised;
-    button -> relief = relief;
-    ei_font_t* text_font = malloc(sizeof(ei_font_t));
-    *text_font = ei_default_font;
-    button -> text_font = text_font;
-    ei_color_t* text_color = malloc(sizeof(ei_color_t));
-    *text_color = ei_font_default_color;
-    button -> text_color = text_color;
-    ei_anchor_t* center_text = malloc(sizeof(ei_anchor_t));
-    *center_text = ei_anc_center;
-    ei_anchor_t* center_img = malloc(sizeof(ei_anchor_t));
-    *center_img = ei_anc_center;
-    button -> text_anchor = center_text;
-    button -> img_anchor = center_img;
-    int* corner = malloc(sizeof(int));
-    *corner = k_default_button_corner_radius;
-    button -> corner_radius = corner;
+    button -> set = 0;
+    button -> color = ei_default_background_color;
+    button -> user_param = NULL;
+    button -> border_width = 0;
+    button -> relief = ei_relief_raised;
+    button -> text_font = ei_default_font;
+    button -> text_color = ei_font_default_color;
+    button -> text_anchor = ei_anc_center;
+    button -> img_anchor = ei_anc_center;
+    button -> img_scaling = ei_scale_none;
+    button -> corner_radius = k_default_button_corner_radius;
 }
 /**
  * \brief 	A function that is called to notify the widget that its geometry has been modified
@@ -361,63 +393,46 @@ void	ei_button_geomnotifyfunc_t	(struct ei_widget_t*	widget,
 ei_bool_t ei_button_handlefunc_t (struct ei_widget_t*	widget,
         struct ei_event_t*	event){
     ei_button_t* button = (ei_button_t*) widget;
-    ei_relief_t* relief = button -> relief;
+    ei_relief_t relief;
     if (event -> type == ei_ev_mouse_buttondown) {
-        *relief = ei_relief_sunken;
-        ei_change_relief_button(relief, widget);
-        if (DRAW_RECT == NULL){
-            DRAW_RECT = calloc(1, sizeof(ei_linked_rect_t));
-        }
-        DRAW_RECT -> rect = widget -> screen_location;
+        relief = ei_relief_sunken;
+        ei_change_relief_button(&relief, widget);
         ei_event_set_active_widget(widget);
         if (button -> callback != NULL){
-            (*(button -> callback))(widget, event, *(button -> user_param));
+            (button -> callback)(widget, event, button -> user_param);
         }
     }
     else if (event -> type == ei_ev_mouse_buttonup) {
-        *relief = ei_relief_raised;
-        ei_change_relief_button(relief, widget);
-        if (DRAW_RECT == NULL){
-            DRAW_RECT = calloc(1, sizeof(ei_linked_rect_t));
-        }
-        DRAW_RECT -> rect = widget -> screen_location;
+        relief = ei_relief_raised;
+        ei_change_relief_button(&relief, widget);
         ei_event_set_active_widget(NULL);
     }
     else if (event -> type == ei_ev_mouse_move) {
         ei_point_t where = event -> param.mouse.where;
         ei_widget_t* compare = ei_widget_pick(&where);
+        // Le bouton n'est redessine que si son relief change
         if (compare == NULL || compare -> pick_id != widget -> pick_id) {
-            if (*relief != ei_relief_raised) {
-                *relief = ei_relief_raised;
-                ei_change_relief_button(relief, widget);
-                if (DRAW_RECT == NULL){
-                    DRAW_RECT = calloc(1, sizeof(ei_linked_rect_t));
-                }
-                DRAW_RECT -> rect = widget -> screen_location;
-            }
-        }
-        else {
-            if (*relief != ei_relief_sunken) {
-                *relief = ei_relief_sunken;
-                ei_change_relief_button(relief, widget);
-                if (DRAW_RECT == NULL){
-                    DRAW_RECT = calloc(1, sizeof(ei_linked_rect_t));
-                }
-                DRAW_RECT -> rect = widget -> screen_location;
-            }
+            relief = ei_relief_raised;
+        } else {
+            relief = ei_relief_sunken;
         }
+        ei_change_relief_button(&relief, widget);
     }
     return EI_TRUE;
 }
 
 /**
- * @brief	Changes the relief of a button
+ * @brief	Changes the relief of a button, and damages it if the relief has changed
  *
  * @param	relief	The relief that we change to
  * @param   widget the current widget
  */
 void ei_change_relief_button(ei_relief_t* relief, ei_widget_t* widget) {
-    ei_button_configure(widget, NULL, NULL,NULL,NULL, relief, NULL,NULL,NULL,
-        NULL,NULL, NULL,NULL,NULL,NULL);
-    ei_placer_run(widget);
+    ei_button_t* button = (ei_button_t*) widget;
+    if (button -> relief == *relief) {
+        return;
+    }
+    button -> relief = *relief;
+    button -> set |= ei_attr_relief;
+    ei_widget_configured(widget, ei_attr_relief);
 }
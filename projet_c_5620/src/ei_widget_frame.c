@@ -10,6 +10,9 @@
 #include "ei_widget_frame.h"
 #include "ei_widget_button.h"
 #include "ei_widget_toplevel.h"
+#include "ei_slab.h"
+#include "ei_text.h"
+#include "ei_image.h"
 
 #define max(a,b) ((a) > (b) ? a : b)
 #define min(a,b) ((a) < (b) ? a : b)
@@ -65,58 +68,114 @@ void			ei_frame_configure		(ei_widget_t*		widget,
         ei_rect_t**		img_rect,
         ei_anchor_t*		img_anchor){
     ei_frame_t* frame = (ei_frame_t*) widget;
+    // Attributs dont la valeur change vraiment
+    ei_attr_mask_t changed = 0;
     if (color != NULL){
-        *(frame -> color) = *color;
+        if (ei_color_equal(frame -> color, *color) == EI_FALSE) {
+            frame -> color = *color;
+            changed |= ei_attr_color;
+        }
+        frame -> set |= ei_attr_color;
     }
     if (border_width != NULL){
-        *(frame -> border_width) = *border_width;
+        if (frame -> border_width != *border_width) {
+            frame -> border_width = *border_width;
+            changed |= ei_attr_border_width;
+        }
+        frame -> set |= ei_attr_border_width;
     }
     if (relief != NULL){
-        *(frame -> relief) = *relief;
+        if (frame -> relief != *relief) {
+            frame -> relief = *relief;
+            changed |= ei_attr_relief;
+        }
+        frame -> set |= ei_attr_relief;
     }
     if (text != NULL){
-        frame -> text = calloc(1, sizeof(char*));
-        *(frame -> text) = calloc(strlen(*text), sizeof(char));
-        strncpy(*(frame -> text), *text, strlen(*text));
+        if (ei_string_equal(frame -> text, *text) == EI_FALSE) {
+            free(frame -> text);
+            frame -> text = NULL;
+            if (*text != NULL) {
+                frame -> text = malloc(strlen(*text) + 1);
+                strcpy(frame -> text, *text);
+            }
+            changed |= ei_attr_text;
+        }
+        frame -> set |= ei_attr_text;
     }
     if (text_font != NULL){
-        *(frame -> text_font) = *text_font;
+        if (frame -> text_font != *text_font) {
+            frame -> text_font = *text_font;
+            changed |= ei_attr_text_font;
+        }
+        frame -> set |= ei_attr_text_font;
     }
     if (text_color != NULL){
-        *(frame -> text_color) = *text_color;
+        if (ei_color_equal(frame -> text_color, *text_color) == EI_FALSE) {
+            frame -> text_color = *text_color;
+            changed |= ei_attr_text_color;
+        }
+        frame -> set |= ei_attr_text_color;
+    }
+    if (text_anchor != NULL){
+        if (frame -> text_anchor != *text_anchor) {
+            frame -> text_anchor = *text_anchor;
+            changed |= ei_attr_text_anchor;
+        }
+        frame -> set |= ei_attr_text_anchor;
     }
     if (img != NULL){
-        frame -> img = malloc(sizeof(ei_surface_t));
-        *(frame -> img) = *img;
+        if (frame -> img != *img) {
+            // Une image du registre est partagee : le widget en garde une reference
+            ei_image_retain(*img, widget);
+            ei_image_release_holder(frame -> img, widget);
+            frame -> img = *img;
+            changed |= ei_attr_img;
+        }
+        frame -> set |= ei_attr_img;
     }
-    if (img_rect != NULL){
-        frame -> img_rect = calloc(1, sizeof(ei_rect_t*));
-        *(frame -> img_rect) = calloc(1, sizeof(ei_rect_t));
-        **(frame -> img_rect) = **img_rect;
+    ei_rect_t new_img_rect = frame -> img_rect;
+    if (img_rect != NULL && *img_rect != NULL){
+        new_img_rect = **img_rect;
+        frame -> set |= ei_attr_img_rect;
+    } else if (img != NULL && !(frame -> set & ei_attr_img_rect)) {
+        // Sans rectangle, toute l'image est affichee
+        new_img_rect = hw_surface_get_rect(frame -> img);
+    }
+    if (ei_rect_equal(&(frame -> img_rect), &new_img_rect) == EI_FALSE) {
+        frame -> img_rect = new_img_rect;
+        changed |= ei_attr_img_rect;
     }
     if (img_anchor != NULL){
-        frame -> img_anchor = malloc(sizeof(ei_anchor_t));
-        *(frame -> img_anchor) = *img_anchor;
+        if (frame -> img_anchor != *img_anchor) {
+            frame -> img_anchor = *img_anchor;
+            changed |= ei_attr_img_anchor;
+        }
+        frame -> set |= ei_attr_img_anchor;
     }
+    ei_size_t size = widget -> requested_size;
     if (requested_size != NULL){
-        widget -> requested_size = *requested_size;
-    } else {
-        if (text != NULL){
-            ei_surface_t text_surface = hw_text_create_surface(*(frame -> text),
-             *(frame -> text_font), (frame -> text_color));
-            ei_size_t text_size = hw_surface_get_size(text_surface);
-            (widget -> requested_size).width = text_size.width +
-            *(frame -> border_width)*2 + 5;
-            (widget -> requested_size).height = text_size.height +
-            *(frame -> border_width)*2 + 5;
+        size = *requested_size;
+        frame -> set |= ei_attr_requested_size;
+    } else if (!(frame -> set & ei_attr_requested_size)
+        && (changed & (ei_attr_text | ei_attr_text_font | ei_attr_border_width
+        | ei_attr_img | ei_attr_img_rect))) {
+        // Une taille donnee par l'appelant n'est pas recalculee
+        if (text != NULL && frame -> text != NULL){
+            ei_size_t text_size = ei_text_measure(frame -> text, frame -> text_font);
+            size.width = text_size.width + frame -> border_width*2 + 5;
+            size.height = text_size.height + frame -> border_width*2 + 5;
         } else if (img != NULL) {
-            ei_size_t size = (**(frame -> img_rect)).size;
-            (widget -> requested_size).width = size.width +
-            *(frame -> border_width)*2 + 5;
-            (widget -> requested_size).height = size.height +
-            *(frame -> border_width)*2 + 5;
+            size.width = frame -> img_rect.size.width + frame -> border_width*2 + 5;
+            size.height = frame -> img_rect.size.height + frame -> border_width*2 + 5;
         }
     }
+    if (size.width != (widget -> requested_size).width
+        || size.height != (widget -> requested_size).height) {
+        widget -> requested_size = size;
+        changed |= ei_attr_requested_size;
+    }
+    ei_widget_configured(widget, changed);
 }
 
 
@@ -135,6 +194,7 @@ void			ei_frame_register_class 	(){
     frame -> setdefaultsfunc = &ei_frame_setdefaultsfunc_t;
     strncpy(frame -> name, "frame", 20);
     ei_widgetclass_register(frame);
+    ei_widgetclass_set_slab(frame, sizeof(ei_frame_t));
 }
 
 
@@ -160,25 +220,8 @@ void*	ei_frame_allocfunc_t		(){
 
 void	ei_frame_releasefunc_t	(struct ei_widget_t*	widget){
     ei_frame_t* frame = (ei_frame_t*) widget;
-    free(frame -> color);
-    free(frame -> relief);
-    free(frame -> text_font);
-    free(frame -> text_color);
-    free(frame -> text_anchor);
-    free(frame -> img_anchor);
-    if (frame -> text != NULL){
-        free(*(frame -> text));
-        free(frame -> text);
-    }
-    if (frame -> img != NULL){
-        free(frame -> img);
-    }
-    if (frame -> img_rect != NULL){
-        free(*(frame -> img_rect));
-        free(frame -> img_rect);
-    }
-
-    free(frame);
+    free(frame -> text);
+    ei_image_release_holder(frame -> img, widget);
 }
 
 /**
@@ -196,80 +239,93 @@ void	ei_frame_drawfunc_t		(struct ei_widget_t*	widget,
         ei_rect_t*		clipper){
     ei_frame_t* frame = (ei_frame_t*) widget;
     ei_rect_t rectangle = widget -> screen_location;
-    ei_color_t color = *(frame -> color);
+    ei_color_t color = frame -> color;
     ei_color_t pick_color = *(widget -> pick_color);
-    int border_width = *(frame -> border_width);
-    ei_relief_t relief = *(frame -> relief);
-    char** text = frame -> text;
-    ei_surface_t* img = frame -> img;
-    ei_rect_t** img_rect = calloc(1, sizeof(ei_rect_t));
-    ei_font_t* text_font = calloc(1, sizeof(ei_font_t));
-    ei_color_t* text_color = calloc(1, sizeof(ei_color_t));
-    ei_anchor_t *anchor = calloc(1, sizeof(ei_anchor_t));
-    ei_point_t* where = calloc(1, sizeof(ei_point_t));
-    if (img != NULL) {
-        img_rect = frame -> img_rect;
-        anchor = frame -> img_anchor;
-        where = ei_get_where(rectangle, anchor, border_width, (**img_rect).size);
-    } else if (text != NULL) {
-        text_font = frame -> text_font;
-        text_color = (ei_color_t*) frame -> text_color;
-        anchor = frame -> text_anchor;
-        ei_surface_t text_surface = hw_text_create_surface(*text, *text_font, &color);
-        ei_size_t text_size = hw_surface_get_size(text_surface);
-        where = ei_get_where(rectangle, anchor, border_width, text_size);
-    }
-    ei_size_t surface_size = hw_surface_get_size(surface);
-    if (color.alpha != 255){
-        ei_surface_t alpha_surface = hw_surface_create(surface, &surface_size,
-            EI_TRUE);
-        ei_draw_button(alpha_surface, rectangle, color, 0, border_width, relief,
-             text, *text_font, text_color, img, *img_rect, *where, clipper);
-        ei_copy_surface(surface,clipper, alpha_surface,clipper, EI_TRUE);
-    } else {
-        ei_draw_button(surface, rectangle, color, 0, border_width, relief, text,
-             *text_font, text_color, img, *img_rect, *where, clipper);
-    }
+    ei_rect_t* pick_clipper = clipper;
+    if (surface != NULL) {
+        int border_width = frame -> border_width;
+        ei_relief_t relief = frame -> relief;
+        char* text = frame -> text;
+        ei_surface_t img = frame -> img;
+        ei_rect_t img_rect = frame -> img_rect;
+        ei_surface_t scaled = NULL;
+        if (img != NULL && frame -> img_scaling != ei_scale_none
+            && ei_image_is_placeholder(img) == EI_FALSE) {
+            // La copie redimensionnee est gardee en cache, elle n'est calculee qu'une fois
+            ei_size_t inside = {rectangle.size.width - 2*border_width,
+                rectangle.size.height - 2*border_width};
+            scaled = ei_scale_acquire(img, &img_rect,
+                ei_scale_fit_size(img_rect.size, inside, frame -> img_scaling));
+            if (scaled != NULL) {
+                img = scaled;
+                img_rect = hw_surface_get_rect(scaled);
+            }
+        }
+        ei_point_t where = {0, 0};
+        if (img != NULL) {
+            where = ei_anchor_point(rectangle, &(frame -> img_anchor), border_width,
+                img_rect.size);
+        } else if (text != NULL) {
+            ei_size_t text_size = ei_text_measure(text, frame -> text_font);
+            where = ei_anchor_point(rectangle, &(frame -> text_anchor), border_width,
+                text_size);
+        }
+        if (color.alpha != 255){
+            ei_surface_t layer = ei_layer_begin(surface, clipper);
+            ei_draw_button(layer, rectangle, color, 0, border_width, relief,
+                 &(frame -> text), frame -> text_font, &(frame -> text_color),
+                 &(frame -> img), &(frame -> img_rect), where, clipper);
+            ei_layer_end(surface, layer, clipper);
+        } else {
+            ei_draw_button(surface, rectangle, color, 0, border_width, relief,
+                 &(frame -> text), frame -> text_font, &(frame -> text_color),
+                 &(frame -> img), &(frame -> img_rect), where, clipper);
+        }
 
-    if (text != NULL) {
-        if (*text != NULL) {
+        if (text != NULL) {
             rectangle.size.width -= 2*border_width;
             rectangle.size.height -= 2*border_width;
             rectangle.top_left.x += border_width;
             rectangle.top_left.y += border_width;
-            rectangle = *ei_intersection(&rectangle, clipper);
-            ei_draw_text(surface, where, *text, *text_font, text_color, &rectangle);
-        }
-    } else if (img != NULL) {
-        // on utilise copy
-        ei_rect_t rect = {*where, (*img_rect)->size};
-        ei_rect_t image = **img_rect;
-        ei_rect_t* intersects = &rect;
-        rectangle.size.width -= 2*border_width;
-        rectangle.size.height -= 2*border_width;
-        rectangle.top_left.x += border_width;
-        rectangle.top_left.y += border_width;
-        clipper = ei_intersection(&rectangle, clipper);
-        if (clipper != NULL) {
-            if (clipper->size.width != 0 && clipper->size.height != 0) {
-                intersects = ei_intersection(&rect, clipper);
-                image.top_left.x += max(0,intersects ->top_left.x - where->x);
-                image.top_left.y += max(0,intersects ->top_left.y - where->y);
+            rectangle = ei_rect_intersection(&rectangle, clipper);
+            ei_draw_text(surface, &where, text, frame -> text_font, &(frame -> text_color),
+                &rectangle);
+        } else if (img != NULL && ei_image_is_placeholder(img) == EI_FALSE) {
+            // on utilise copy
+            ei_rect_t rect = {where, img_rect.size};
+            ei_rect_t image = img_rect;
+            ei_rect_t intersection;
+            ei_rect_t* intersects = &rect;
+            rectangle.size.width -= 2*border_width;
+            rectangle.size.height -= 2*border_width;
+            rectangle.top_left.x += border_width;
+            rectangle.top_left.y += border_width;
+            ei_rect_t inner_clipper = ei_rect_intersection(&rectangle, clipper);
+            if (inner_clipper.size.width != 0 && inner_clipper.size.height != 0) {
+                intersection = ei_rect_intersection(&rect, &inner_clipper);
+                intersects = &intersection;
+                image.top_left.x += max(0,intersects ->top_left.x - where.x);
+                image.top_left.y += max(0,intersects ->top_left.y - where.y);
                 image.size = intersects -> size;
             }
-        }
-        if (image.size.width != 0 && image.size.height != 0) {
-            ei_size_t surface_size = hw_surface_get_size(surface);
-            if (intersects -> top_left.x >= 0 && intersects -> top_left.y >= 0
-                && intersects -> top_left.x <= surface_size.width
-                && intersects -> top_left.y <= surface_size.height) {
-                ei_copy_surface(surface, intersects, *img, &image,
-                     hw_surface_has_alpha(surface));
+            if (image.size.width != 0 && image.size.height != 0) {
+                ei_size_t surface_size = hw_surface_get_size(surface);
+                if (intersects -> top_left.x >= 0 && intersects -> top_left.y >= 0
+                    && intersects -> top_left.x <= surface_size.width
+                    && intersects -> top_left.y <= surface_size.height) {
+                    ei_copy_surface(surface, intersects, img, &image,
+                         hw_surface_has_alpha(surface));
+                }
             }
         }
+        ei_scale_release(scaled);
+    }
+    if (pick_surface != NULL) {
+        ei_point_t where = widget -> screen_location.top_left;
+        ei_draw_button(pick_surface, widget -> screen_location, pick_color, 0, 0,
+            ei_relief_none, NULL, ei_default_font, &color, NULL,
+            &(widget -> screen_location), where, pick_clipper);
     }
-    ei_draw_button(pick_surface, rectangle, pick_color, 0, 0, ei_relief_none,
-        NULL, ei_default_font, &color, NULL, &rectangle, *where, clipper);
 }
 
 
@@ -282,26 +338,15 @@ void	ei_frame_setdefaultsfunc_t	(struct ei_widget_t*	widget){
     (widget -> requested_size).width = 100;
     (widget -> requested_size).height = 100;
     ei_frame_t* frame = (ei_frame_t *) widget;
-    ei_color_t* color = malloc(sizeof(ei_color_t));
-    *color = ei_default_background_color;
-    frame -> color = color;
-    int* border_width = calloc(1, sizeof(int));
-    frame -> border_width = border_width;
-    ei_relief_t *relief = malloc(sizeof(ei_relief_t));
-    *relief = ei_relief_none;
-    frame -> relief = relief;
-    ei_font_t* text_font = malloc(sizeof(ei_font_t));
-    *text_font = ei_default_font;
-    frame -> text_font = text_font;
-    ei_color_t* text_color = malloc(sizeof(ei_color_t));
-    *text_color = ei_font_default_color;
-    frame -> text_color = text_color;
-    ei_anchor_t* center_text = malloc(sizeof(ei_anchor_t));
-    *center_text = ei_anc_center;
-    ei_anchor_t* center_img = malloc(sizeof(ei_anchor_t));
-    *center_img = ei_anc_center;
-    frame -> text_anchor = center_text;
-    frame -> img_anchor = center_img;
+    frame -> set = 0;
+    frame -> color = ei_default_background_color;
+    frame -> border_width = 0;
+    frame -> relief = ei_relief_none;
+    frame -> text_font = ei_default_font;
+    frame -> text_color = ei_font_default_color;
+    frame -> text_anchor = ei_anc_center;
+    frame -> img_anchor = ei_anc_center;
+    frame -> img_scaling = ei_scale_none;
 }
 
 /**
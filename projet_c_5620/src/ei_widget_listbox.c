@@ -0,0 +1,311 @@
+/**
+ *  @file	ei_widget_listbox.c
+ *  @brief	The "listbox" class: a scrollframe whose content is a list of rows. Only the
+ *		rows that can be seen in the viewport exist as widgets: the memory and the cost
+ *		of a frame depend on the height of the viewport, not on the number of items.
+ *		When the list scrolls, the rows that leave the viewport are placed where the
+ *		new items appear and given their data by the row function.
+ *
+ */
+
+#include "ei_all_widgets.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "ei_application.h"
+#include "ei_widget.h"
+#include "ei_widget_scrollframe.h"
+#include "ei_widget_listbox.h"
+#include "ei_text.h"
+#include "ei_slab.h"
+
+#define max(a,b) ((a) > (b) ? a : b)
+#define min(a,b) ((a) < (b) ? a : b)
+
+static ei_listbox_stats_t STATS;
+
+/**
+ * \brief	Damages the part of a row that is in the viewport of its listbox.
+ */
+static void listbox_invalidate_row(ei_listbox_t* listbox, ei_widget_t* row){
+    ei_rect_t rect = ei_rect_intersection(&(row -> screen_location),
+        &(listbox -> scrollframe.viewport));
+    ei_app_invalidate_rect(&rect);
+}
+
+/**
+ * \brief	Gives an item to the row of a slot: places it at the position of the item and
+ * calls the row function. With an index of -1, the row is removed from screen.
+ */
+static void listbox_bind(ei_listbox_t* listbox, int slot, int index){
+    ei_widget_t* row = listbox -> rows[slot];
+    listbox -> items[slot] = index;
+    if (index < 0) {
+        if (row -> placer_params != NULL) {
+            listbox_invalidate_row(listbox, row);
+            ei_placer_forget(row);
+            STATS.hidden ++;
+        }
+        return;
+    }
+    int y = index * listbox -> row_height;
+    if (row -> placer_params == NULL) {
+        int x = 0;
+        int width = 0;
+        float rel_width = 1.0;
+        ei_place(row, NULL, &x, &y, &width, &(listbox -> row_height), NULL, NULL,
+            &rel_width, NULL);
+    } else {
+        row -> placer_params -> y_data = y;
+        row -> placer_params -> h_data = listbox -> row_height;
+    }
+    // La position est a jour avant que la fonction de l'utilisateur configure la ligne
+    ei_placer_run(row);
+    listbox_invalidate_row(listbox, row);
+    STATS.binds ++;
+    if (listbox -> rowfunc != NULL) {
+        (listbox -> rowfunc)(row, index, listbox -> user_param);
+    }
+}
+
+/**
+ * \brief	Bound to the mouse events of each row: dragging a row drags the list, like its
+ * background. The row still receives the event.
+ */
+static ei_bool_t listbox_row_event(ei_widget_t* row, ei_event_t* event, void* user_param){
+    ei_listbox_t* listbox = (ei_listbox_t*) user_param;
+    ei_scrollframe_t* scrollframe = &(listbox -> scrollframe);
+    ei_point_t where = event -> param.mouse.where;
+    if (event -> type == ei_ev_mouse_buttondown) {
+        scrollframe -> dragging = EI_TRUE;
+        scrollframe -> drag_from = where;
+    }
+    else if (event -> type == ei_ev_mouse_buttonup) {
+        scrollframe -> dragging = EI_FALSE;
+    }
+    // Si la ligne est le widget actif, le traitant du listbox ne voit pas la souris
+    else if (event -> type == ei_ev_mouse_move && scrollframe -> dragging == EI_TRUE) {
+        ei_point_t offset = scrollframe -> offset;
+        offset.x -= where.x - scrollframe -> drag_from.x;
+        offset.y -= where.y - scrollframe -> drag_from.y;
+        scrollframe -> drag_from = where;
+        ei_scrollframe_scroll_to((ei_widget_t*) listbox, offset);
+    }
+    return EI_FALSE;
+}
+
+/**
+ * \brief	Makes the pool of rows match the viewport and the offset: creates the missing
+ * rows, and gives the items that have become visible to the rows that no longer are.
+ *
+ * @param	rebind		If EI_TRUE, all the rows are given their item again.
+ */
+static void listbox_sync(ei_listbox_t* listbox, ei_bool_t rebind){
+    ei_scrollframe_t* scrollframe = &(listbox -> scrollframe);
+    int row_height = listbox -> row_height;
+    // Le contenu suit la largeur du viewport
+    scrollframe -> content_size.width = scrollframe -> viewport.size.width;
+    scrollframe -> content_size.height = listbox -> item_count * row_height;
+    // Assez de lignes pour un viewport qui commence au milieu d'une ligne, plus une
+    int count = 0;
+    if (scrollframe -> viewport.size.height > 0) {
+        count = min(listbox -> item_count,
+            scrollframe -> viewport.size.height / row_height + 2);
+    }
+    if (count > listbox -> row_capacity) {
+        listbox -> rows = realloc(listbox -> rows, count * sizeof(ei_widget_t*));
+        listbox -> items = realloc(listbox -> items, count * sizeof(int));
+        for (int slot = listbox -> row_capacity; slot < count; slot++) {
+            ei_widget_t* row = ei_widget_create(listbox -> row_class, (ei_widget_t*) listbox);
+            ei_bind(ei_ev_mouse_buttondown, row, NULL, listbox_row_event, listbox);
+            ei_bind(ei_ev_mouse_move, row, NULL, listbox_row_event, listbox);
+            ei_bind(ei_ev_mouse_buttonup, row, NULL, listbox_row_event, listbox);
+            listbox -> rows[slot] = row;
+            listbox -> items[slot] = -1;
+            STATS.rows ++;
+        }
+        listbox -> row_capacity = count;
+    }
+    // Un autre nombre de lignes change la ligne de chaque item
+    if (count != listbox -> row_count) {
+        listbox -> row_count = count;
+        rebind = EI_TRUE;
+    }
+    int first = scrollframe -> offset.y / row_height;
+    for (int slot = 0; slot < listbox -> row_capacity; slot++) {
+        int index = -1;
+        if (slot < count) {
+            index = first + ((slot - first % count) + count) % count;
+            if (index >= listbox -> item_count) {
+                index = -1;
+            }
+        }
+        if (index != listbox -> items[slot] || (rebind == EI_TRUE && index >= 0)) {
+            listbox_bind(listbox, slot, index);
+        }
+    }
+}
+
+/**
+ * \brief	The viewfunc of the listboxes: called by the scrollframe after a scroll or a
+ * change of its viewport.
+ */
+static void listbox_view(ei_widget_t* widget){
+    listbox_sync((ei_listbox_t*) widget, EI_FALSE);
+}
+
+/**
+ * \brief	Destroys the rows of the pool of a listbox.
+ */
+static void listbox_clear(ei_listbox_t* listbox){
+    for (int slot = 0; slot < listbox -> row_capacity; slot++) {
+        ei_widget_t* row = listbox -> rows[slot];
+        if (row -> placer_params != NULL) {
+            listbox_invalidate_row(listbox, row);
+        }
+        ei_widget_destroy(row);
+    }
+    free(listbox -> rows);
+    free(listbox -> items);
+    listbox -> rows = NULL;
+    listbox -> items = NULL;
+    listbox -> row_capacity = 0;
+    listbox -> row_count = 0;
+}
+
+void ei_listbox_scroll_to_item(ei_widget_t* widget, int index){
+    ei_listbox_t* listbox = (ei_listbox_t*) widget;
+    ei_point_t offset = listbox -> scrollframe.offset;
+    offset.y = index * listbox -> row_height;
+    ei_scrollframe_scroll_to(widget, offset);
+}
+
+void ei_listbox_refresh(ei_widget_t* widget, int first, int count){
+    ei_listbox_t* listbox = (ei_listbox_t*) widget;
+    for (int slot = 0; slot < listbox -> row_count; slot++) {
+        int index = listbox -> items[slot];
+        if (index >= first && index < first + count) {
+            listbox_bind(listbox, slot, index);
+        }
+    }
+}
+
+int ei_listbox_row_item(ei_widget_t* widget, ei_widget_t* row){
+    ei_listbox_t* listbox = (ei_listbox_t*) widget;
+    for (int slot = 0; slot < listbox -> row_capacity; slot++) {
+        if (listbox -> rows[slot] == row) {
+            return listbox -> items[slot];
+        }
+    }
+    return -1;
+}
+
+void ei_listbox_get_stats(ei_listbox_stats_t* stats){
+    *stats = STATS;
+}
+
+void			ei_listbox_configure		(ei_widget_t*		widget,
+        ei_size_t*		requested_size,
+        const ei_color_t*	color,
+        int*			border_width,
+        ei_relief_t*		relief,
+        int*			item_count,
+        int*			row_height,
+        char**			row_class,
+        ei_listbox_rowfunc_t*	rowfunc,
+        void**			user_param){
+    ei_listbox_t* listbox = (ei_listbox_t*) widget;
+    // Les lignes recoivent de nouveau leur item si ce qui les dessine a change
+    ei_bool_t rebind = EI_FALSE;
+    // Une classe inconnue est ignoree : les lignes ne pourraient pas etre creees
+    if (row_class != NULL && strncmp(listbox -> row_class, *row_class,
+        sizeof(ei_widgetclass_name_t)) != 0 && ei_widgetclass_from_name(*row_class) != NULL) {
+        listbox_clear(listbox);
+        strncpy(listbox -> row_class, *row_class, sizeof(ei_widgetclass_name_t) - 1);
+        listbox -> row_class[sizeof(ei_widgetclass_name_t) - 1] = '\0';
+    }
+    if (row_height != NULL && *row_height != listbox -> row_height) {
+        listbox -> row_height = max(1, *row_height);
+        rebind = EI_TRUE;
+    }
+    if (item_count != NULL && *item_count != listbox -> item_count) {
+        listbox -> item_count = max(0, *item_count);
+    }
+    if (rowfunc != NULL && *rowfunc != listbox -> rowfunc) {
+        listbox -> rowfunc = *rowfunc;
+        rebind = EI_TRUE;
+    }
+    if (user_param != NULL && *user_param != listbox -> user_param) {
+        listbox -> user_param = *user_param;
+        rebind = EI_TRUE;
+    }
+    // Le scrollframe limite le defilement a la nouvelle hauteur du contenu
+    ei_size_t content_size = {listbox -> scrollframe.viewport.size.width,
+        listbox -> item_count * listbox -> row_height};
+    listbox -> scrollframe.viewfunc = NULL;
+    ei_scrollframe_configure(widget, requested_size, color, border_width, relief,
+        &content_size);
+    listbox -> scrollframe.viewfunc = &listbox_view;
+    listbox_sync(listbox, rebind);
+}
+
+/**
+ * \brief	Registers the "listbox" widget class in the program. This must be called
+ *		only once before widgets of the class "listbox" can be created and
+ *		configured with \ref ei_listbox_configure.
+ */
+void			ei_listbox_register_class	(){
+    ei_widgetclass_t* listbox = calloc(1, sizeof(ei_widgetclass_t));
+    listbox -> drawfunc = &ei_scrollframe_drawfunc_t;
+    listbox -> handlefunc = &ei_scrollframe_handlefunc_t;
+    listbox -> geomnotifyfunc = &ei_scrollframe_geomnotifyfunc_t;
+    listbox -> releasefunc = &ei_listbox_releasefunc_t;
+    listbox -> allocfunc = &ei_listbox_allocfunc_t;
+    listbox -> setdefaultsfunc = &ei_listbox_setdefaultsfunc_t;
+    strncpy(listbox -> name, "listbox", 20);
+    ei_widgetclass_register(listbox);
+    ei_widgetclass_set_slab(listbox, sizeof(ei_listbox_t));
+}
+
+/**
+ * \brief	A function that allocates a block of memory that is big enough to store the
+ *		attributes of a listbox. After allocation, the function *must* initialize
+ *		the memory to 0.
+ *
+ * @return		A block of memory with all bytes set to 0.
+ */
+void*	ei_listbox_allocfunc_t		(){
+    return calloc(1, sizeof(ei_listbox_t));
+}
+
+/**
+ * \brief	A function that releases the memory used by a listbox before it is destroyed:
+ *		the pool of rows. The rows themselves are destroyed as its children.
+ *
+ * @param	widget		The widget which resources are to be freed.
+ */
+void	ei_listbox_releasefunc_t	(struct ei_widget_t*	widget){
+    ei_listbox_t* listbox = (ei_listbox_t*) widget;
+    free(listbox -> rows);
+    free(listbox -> items);
+}
+
+/**
+ * \brief	A function that sets the default values for a listbox.
+ *
+ * @param	widget		A pointer to the widget instance to intialize.
+ */
+void	ei_listbox_setdefaultsfunc_t	(struct ei_widget_t*	widget){
+    ei_listbox_t* listbox = (ei_listbox_t*) widget;
+    ei_scrollframe_setdefaultsfunc_t(widget);
+    listbox -> item_count = 0;
+    listbox -> row_height = ei_text_measure("Ag", NULL).height + 4;
+    strncpy(listbox -> row_class, "frame", sizeof(ei_widgetclass_name_t));
+    listbox -> rowfunc = NULL;
+    listbox -> user_param = NULL;
+    listbox -> scrollframe.viewfunc = &listbox_view;
+    // La taille ne suit pas le contenu, qui peut faire des millions de pixels
+    widget -> requested_size.width = 200;
+    widget -> requested_size.height = 10 * listbox -> row_height;
+    listbox -> scrollframe.set |= ei_attr_requested_size;
+}
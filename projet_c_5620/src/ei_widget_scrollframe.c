@@ -0,0 +1,461 @@
+/**
+ *  @file	ei_widget_scrollframe.c
+ *  @brief	The "scrollframe" class: a frame whose children are placed in a content larger
+ *		than its viewport. Scrolling moves the pixels of the viewport that stay visible
+ *		with \ref ei_scroll_pixels, and only the strip that is uncovered is redrawn: the
+ *		cost of a scroll is proportional to the uncovered area, not to the content.
+ *
+ */
+
+#include "ei_all_widgets.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "ei_draw_widgets.h"
+#include "ei_draw_extension.h"
+#include "ei_application.h"
+#include "ei_event.h"
+#include "ei_widget.h"
+#include "ei_widget_scrollframe.h"
+#include "ei_slab.h"
+
+#define max(a,b) ((a) > (b) ? a : b)
+#define min(a,b) ((a) < (b) ? a : b)
+
+static ei_scrollframe_stats_t STATS;
+
+/**
+ * \brief	Computes the viewport of a scrollframe: its screen location without the border.
+ */
+static void scrollframe_update_viewport(ei_scrollframe_t* scrollframe){
+    ei_rect_t rect = ((ei_widget_t*) scrollframe) -> screen_location;
+    int border_width = scrollframe -> border_width;
+    scrollframe -> viewport.top_left.x = rect.top_left.x + border_width;
+    scrollframe -> viewport.top_left.y = rect.top_left.y + border_width;
+    scrollframe -> viewport.size.width = max(0, rect.size.width - 2 * border_width);
+    scrollframe -> viewport.size.height = max(0, rect.size.height - 2 * border_width);
+}
+
+/**
+ * \brief	Keeps an offset between (0, 0) and the size of the content minus the size of
+ * the viewport.
+ */
+static ei_point_t scrollframe_clamp(ei_scrollframe_t* scrollframe, ei_point_t offset){
+    int max_x = max(0, scrollframe -> content_size.width - scrollframe -> viewport.size.width);
+    int max_y = max(0, scrollframe -> content_size.height
+        - scrollframe -> viewport.size.height);
+    offset.x = max(0, min(offset.x, max_x));
+    offset.y = max(0, min(offset.y, max_y));
+    return offset;
+}
+
+/**
+ * \brief	Computes the part of the viewport that is on screen, as the renderer clips it:
+ * by the content_rect of each ancestor.
+ *
+ * @return	The visible part, empty if the scrollframe or an ancestor is not displayed.
+ */
+static ei_rect_t scrollframe_visible(ei_scrollframe_t* scrollframe){
+    ei_widget_t* widget = (ei_widget_t*) scrollframe;
+    ei_rect_t visible = scrollframe -> viewport;
+    ei_rect_t empty = {{0, 0}, {0, 0}};
+    for (ei_widget_t* child = widget; child -> parent != NULL; child = child -> parent) {
+        if (child -> placer_params == NULL) {
+            return empty;
+        }
+        ei_widget_t* parent = child -> parent;
+        ei_rect_t* area = parent -> content_rect;
+        if (ei_widget_is_decoration(child) == EI_TRUE) {
+            area = &(parent -> screen_location);
+        }
+        visible = ei_rect_intersection(&visible, area);
+        visible = ei_rect_intersection(&visible, &(parent -> screen_location));
+    }
+    return visible;
+}
+
+/**
+ * \brief	Tells if a widget drawn after the scrollframe covers a part of a rectangle: its
+ * pixels would be moved with the content.
+ */
+static ei_bool_t scrollframe_is_covered(ei_scrollframe_t* scrollframe, const ei_rect_t* rect){
+    for (ei_widget_t* widget = (ei_widget_t*) scrollframe; widget -> parent != NULL;
+        widget = widget -> parent) {
+        for (ei_widget_t* sibling = widget -> next_sibling; sibling != NULL;
+            sibling = sibling -> next_sibling) {
+            if (sibling -> placer_params == NULL) {
+                continue;
+            }
+            ei_rect_t covered = ei_rect_intersection(rect, &(sibling -> screen_location));
+            if (covered.size.width > 0 && covered.size.height > 0) {
+                return EI_TRUE;
+            }
+        }
+    }
+    return EI_FALSE;
+}
+
+/**
+ * \brief	Moves the pixels of the visible part of the viewport, and damages the strips
+ * that are uncovered.
+ *
+ * @param	visible		The visible part of the viewport.
+ * @param	dx		The horizontal move of the content on screen.
+ * @param	dy		The vertical move of the content on screen.
+ */
+static void scrollframe_blit(ei_rect_t visible, int dx, int dy){
+    // Les zones deja endommagees suivent le contenu, leurs pixels ne sont pas a jour
+    if (DRAW_RECT != NULL) {
+        ei_rect_t damage = ei_rect_intersection(&(DRAW_RECT -> rect), &visible);
+        if (damage.size.width > 0 && damage.size.height > 0) {
+            damage.top_left.x += dx;
+            damage.top_left.y += dy;
+            damage = ei_rect_intersection(&damage, &visible);
+            ei_app_invalidate_rect(&damage);
+        }
+    }
+    hw_surface_lock(ei_app_root_surface());
+    ei_scroll_pixels(ei_app_root_surface(), &visible, dx, dy);
+    hw_surface_unlock(ei_app_root_surface());
+    ei_app_present_rect(&visible);
+    STATS.blits ++;
+    STATS.moved_pixels += (unsigned long) (visible.size.width - abs(dx))
+        * (visible.size.height - abs(dy));
+    ei_rect_t strip = visible;
+    if (dx != 0) {
+        strip.size.width = abs(dx);
+        if (dx < 0) {
+            strip.top_left.x += visible.size.width + dx;
+        }
+        ei_app_invalidate_rect(&strip);
+        STATS.exposed_pixels += (unsigned long) strip.size.width * strip.size.height;
+    }
+    strip = visible;
+    if (dy != 0) {
+        strip.size.height = abs(dy);
+        if (dy < 0) {
+            strip.top_left.y += visible.size.height + dy;
+        }
+        ei_app_invalidate_rect(&strip);
+        STATS.exposed_pixels += (unsigned long) strip.size.width * strip.size.height;
+    }
+}
+
+/**
+ * \brief	Tells if a rectangle has a part in the viewport of a scrollframe.
+ */
+static ei_bool_t scrollframe_shows(ei_scrollframe_t* scrollframe, const ei_rect_t* rect){
+    ei_rect_t shown = ei_rect_intersection(rect, &(scrollframe -> viewport));
+    return shown.size.width > 0 && shown.size.height > 0;
+}
+
+/**
+ * \brief	Places again the children that are in the viewport, or that were in it, after
+ * the content area has moved. The others are only tested: out of view, they keep their
+ * screen location until a scroll brings them into the viewport.
+ */
+static void scrollframe_place_children(ei_widget_t* widget){
+    ei_scrollframe_t* scrollframe = (ei_scrollframe_t*) widget;
+    ei_point_t origin = ei_scrollframe_content_area(widget).top_left;
+    for (ei_widget_t* child = widget -> children_head; child != NULL;
+        child = child -> next_sibling) {
+        ei_placer_params_t* params = child -> placer_params;
+        if (params == NULL) {
+            continue;
+        }
+        // Le placement suit le contenu : il est decale comme lui depuis le dernier calcul
+        ei_rect_t moved = child -> screen_location;
+        moved.top_left.x += origin.x - params -> origin.x;
+        moved.top_left.y += origin.y - params -> origin.y;
+        if (moved.top_left.x == child -> screen_location.top_left.x
+            && moved.top_left.y == child -> screen_location.top_left.y) {
+            continue;
+        }
+        if (scrollframe_shows(scrollframe, &(child -> screen_location)) == EI_TRUE
+            || scrollframe_shows(scrollframe, &moved) == EI_TRUE) {
+            ei_placer_run(child);
+            STATS.placed_children ++;
+        }
+    }
+}
+
+/**
+ * \brief	Places all the children again through the layout pass, after their area has
+ * changed size.
+ */
+static void scrollframe_invalidate_children(ei_widget_t* widget){
+    for (ei_widget_t* child = widget -> children_head; child != NULL;
+        child = child -> next_sibling) {
+        ei_placer_invalidate(child);
+    }
+}
+
+void ei_scrollframe_scroll_to(ei_widget_t* widget, ei_point_t offset){
+    ei_scrollframe_t* scrollframe = (ei_scrollframe_t*) widget;
+    offset = scrollframe_clamp(scrollframe, offset);
+    int dx = scrollframe -> offset.x - offset.x;
+    int dy = scrollframe -> offset.y - offset.y;
+    if (dx == 0 && dy == 0) {
+        return;
+    }
+    scrollframe -> offset = offset;
+    STATS.scrolls ++;
+    // Les pixels des enfants sont deplaces avec le contenu, seul le picking est invalide :
+    // ceux du viewport sont places tout de suite, la passe de disposition les endommagerait
+    scrollframe_place_children(widget);
+    ei_rect_t visible = scrollframe_visible(scrollframe);
+    if (visible.size.width > 0 && visible.size.height > 0) {
+        if (abs(dx) >= visible.size.width || abs(dy) >= visible.size.height
+            || scrollframe_is_covered(scrollframe, &visible) == EI_TRUE) {
+            ei_app_invalidate_rect(&visible);
+            STATS.repaints ++;
+            STATS.exposed_pixels += (unsigned long) visible.size.width
+                * visible.size.height;
+        } else {
+            scrollframe_blit(visible, dx, dy);
+        }
+    }
+    // Apres le deplacement : les zones endommagees par la sous-classe sont a jour
+    if (scrollframe -> viewfunc != NULL) {
+        (scrollframe -> viewfunc)(widget);
+    }
+}
+
+ei_point_t ei_scrollframe_get_offset(ei_widget_t* widget){
+    return ((ei_scrollframe_t*) widget) -> offset;
+}
+
+ei_rect_t ei_scrollframe_content_area(ei_widget_t* widget){
+    ei_scrollframe_t* scrollframe = (ei_scrollframe_t*) widget;
+    ei_rect_t area;
+    area.top_left.x = scrollframe -> viewport.top_left.x - scrollframe -> offset.x;
+    area.top_left.y = scrollframe -> viewport.top_left.y - scrollframe -> offset.y;
+    area.size = scrollframe -> content_size;
+    return area;
+}
+
+void ei_scrollframe_get_stats(ei_scrollframe_stats_t* stats){
+    *stats = STATS;
+}
+
+void			ei_scrollframe_configure	(ei_widget_t*		widget,
+        ei_size_t*		requested_size,
+        const ei_color_t*	color,
+        int*			border_width,
+        ei_relief_t*		relief,
+        ei_size_t*		content_size){
+    ei_scrollframe_t* scrollframe = (ei_scrollframe_t*) widget;
+    // Attributs dont la valeur change vraiment
+    ei_attr_mask_t changed = 0;
+    if (color != NULL){
+        if (ei_color_equal(scrollframe -> color, *color) == EI_FALSE) {
+            scrollframe -> color = *color;
+            changed |= ei_attr_color;
+        }
+        scrollframe -> set |= ei_attr_color;
+    }
+    if (border_width != NULL){
+        if (scrollframe -> border_width != *border_width) {
+            scrollframe -> border_width = *border_width;
+            scrollframe_update_viewport(scrollframe);
+            changed |= ei_attr_border_width;
+        }
+        scrollframe -> set |= ei_attr_border_width;
+    }
+    if (relief != NULL){
+        if (scrollframe -> relief != *relief) {
+            scrollframe -> relief = *relief;
+            changed |= ei_attr_relief;
+        }
+        scrollframe -> set |= ei_attr_relief;
+    }
+    if (content_size != NULL){
+        if (scrollframe -> content_size.width != content_size -> width
+            || scrollframe -> content_size.height != content_size -> height) {
+            scrollframe -> content_size = *content_size;
+            changed |= ei_attr_content_size;
+        }
+        scrollframe -> set |= ei_attr_content_size;
+    }
+    // Le contenu ou le viewport ont pu retrecir
+    ei_point_t offset = scrollframe_clamp(scrollframe, scrollframe -> offset);
+    ei_bool_t clamped = offset.x != scrollframe -> offset.x || offset.y != scrollframe -> offset.y;
+    if (clamped == EI_TRUE) {
+        scrollframe -> offset = offset;
+        ei_rect_t visible = scrollframe_visible(scrollframe);
+        ei_app_invalidate_rect(&visible);
+    }
+    // Les tailles relatives des enfants dependent de la taille du contenu
+    if (changed & ei_attr_content_size) {
+        scrollframe_invalidate_children(widget);
+    } else if (clamped == EI_TRUE || (changed & ei_attr_border_width)) {
+        scrollframe_place_children(widget);
+    }
+    ei_size_t size = widget -> requested_size;
+    if (requested_size != NULL){
+        size = *requested_size;
+        scrollframe -> set |= ei_attr_requested_size;
+    } else if (!(scrollframe -> set & ei_attr_requested_size)
+        && (changed & (ei_attr_content_size | ei_attr_border_width))) {
+        size.width = scrollframe -> content_size.width + scrollframe -> border_width*2;
+        size.height = scrollframe -> content_size.height + scrollframe -> border_width*2;
+    }
+    if (size.width != (widget -> requested_size).width
+        || size.height != (widget -> requested_size).height) {
+        widget -> requested_size = size;
+        changed |= ei_attr_requested_size;
+    }
+    ei_widget_configured(widget, changed);
+    if (scrollframe -> viewfunc != NULL) {
+        (scrollframe -> viewfunc)(widget);
+    }
+}
+
+/**
+ * \brief	Registers the "scrollframe" widget class in the program. This must be called
+ *		only once before widgets of the class "scrollframe" can be created and
+ *		configured with \ref ei_scrollframe_configure.
+ */
+void			ei_scrollframe_register_class	(){
+    ei_widgetclass_t* scrollframe = calloc(1, sizeof(ei_widgetclass_t));
+    scrollframe -> drawfunc = &ei_scrollframe_drawfunc_t;
+    scrollframe -> handlefunc = &ei_scrollframe_handlefunc_t;
+    scrollframe -> geomnotifyfunc = &ei_scrollframe_geomnotifyfunc_t;
+    scrollframe -> releasefunc = &ei_scrollframe_releasefunc_t;
+    scrollframe -> allocfunc = &ei_scrollframe_allocfunc_t;
+    scrollframe -> setdefaultsfunc = &ei_scrollframe_setdefaultsfunc_t;
+    strncpy(scrollframe -> name, "scrollframe", 20);
+    ei_widgetclass_register(scrollframe);
+    ei_widgetclass_set_slab(scrollframe, sizeof(ei_scrollframe_t));
+}
+
+/**
+ * \brief	A function that allocates a block of memory that is big enough to store the
+ *		attributes of a scrollframe. After allocation, the function *must* initialize
+ *		the memory to 0.
+ *
+ * @return		A block of memory with all bytes set to 0.
+ */
+void*	ei_scrollframe_allocfunc_t		(){
+    return calloc(1, sizeof(ei_scrollframe_t));
+}
+
+/**
+ * \brief	A function that releases the memory used by a scrollframe before it is
+ *		destroyed. A scrollframe has no memory of its own.
+ *
+ * @param	widget		The widget which resources are to be freed.
+ */
+void	ei_scrollframe_releasefunc_t	(struct ei_widget_t*	widget){
+}
+
+/**
+ * \brief	A function that draws a scrollframe: its border and the background of the
+ *		viewport. The children are drawn by the renderer, clipped to the viewport.
+ *
+ * @param	widget		A pointer to the widget instance to draw.
+ * @param	surface		Where to draw the widget, or NULL.
+ * @param	pick_surface	Where to draw the pick color of the widget, or NULL.
+ * @param	clipper		If not NULL, the drawing is restricted within this rectangle
+ *				(expressed in the surface reference frame).
+ */
+void	ei_scrollframe_drawfunc_t	(struct ei_widget_t*	widget,
+        ei_surface_t		surface,
+        ei_surface_t		pick_surface,
+        ei_rect_t*		clipper){
+    ei_scrollframe_t* scrollframe = (ei_scrollframe_t*) widget;
+    ei_rect_t rectangle = widget -> screen_location;
+    ei_point_t where = rectangle.top_left;
+    if (surface != NULL) {
+        ei_color_t color = scrollframe -> color;
+        ei_surface_t target = surface;
+        if (color.alpha != 255) {
+            target = ei_layer_begin(surface, clipper);
+        }
+        ei_draw_button(target, rectangle, color, 0, scrollframe -> border_width,
+            scrollframe -> relief, NULL, ei_default_font, &color, NULL, &rectangle, where,
+            clipper);
+        if (target != surface) {
+            ei_layer_end(surface, target, clipper);
+        }
+    }
+    if (pick_surface != NULL) {
+        ei_draw_button(pick_surface, rectangle, *(widget -> pick_color), 0, 0,
+            ei_relief_none, NULL, ei_default_font, widget -> pick_color, NULL, &rectangle,
+            where, clipper);
+    }
+}
+
+/**
+ * \brief	A function that sets the default values for a scrollframe.
+ *
+ * @param	widget		A pointer to the widget instance to intialize.
+ */
+void	ei_scrollframe_setdefaultsfunc_t	(struct ei_widget_t*	widget){
+    ei_scrollframe_t* scrollframe = (ei_scrollframe_t*) widget;
+    scrollframe -> set = 0;
+    scrollframe -> color = ei_default_background_color;
+    scrollframe -> border_width = 0;
+    scrollframe -> relief = ei_relief_none;
+    scrollframe -> dragging = EI_FALSE;
+    widget -> content_rect = &(scrollframe -> viewport);
+    scrollframe_update_viewport(scrollframe);
+}
+
+/**
+ * \brief 	A function that is called to notify the scrollframe that its geometry has been
+ *		modified by its geometry manager: updates its viewport.
+ *
+ * @param	widget		The widget instance to notify of a geometry change.
+ * @param	rect		The new rectangular screen location of the widget
+ *				(i.e. = widget->screen_location).
+ */
+void	ei_scrollframe_geomnotifyfunc_t	(struct ei_widget_t*	widget,
+        ei_rect_t		rect){
+    ei_scrollframe_t* scrollframe = (ei_scrollframe_t*) widget;
+    scrollframe_update_viewport(scrollframe);
+    // Un viewport agrandi peut depasser la fin du contenu
+    scrollframe -> offset = scrollframe_clamp(scrollframe, scrollframe -> offset);
+    if (scrollframe -> viewfunc != NULL) {
+        (scrollframe -> viewfunc)(widget);
+    }
+}
+
+/**
+ * @brief	A function that is called in response to an event: dragging the background of
+ *		a scrollframe, or a frame of its content, scrolls it.
+ *
+ * @param	widget		The widget for which the event was generated.
+ * @param	event		The event containing all its parameters (type, etc.)
+ *
+ * @return			EI_TRUE, the event is consumed.
+ */
+ei_bool_t ei_scrollframe_handlefunc_t (struct ei_widget_t*	widget,
+        struct ei_event_t*	event){
+    ei_scrollframe_t* scrollframe = (ei_scrollframe_t*) widget;
+    ei_point_t where = event -> param.mouse.where;
+    if (event -> type == ei_ev_mouse_buttondown) {
+        ei_event_set_active_widget(widget);
+        scrollframe -> dragging = EI_TRUE;
+        scrollframe -> drag_from = where;
+    }
+    else if (event -> type == ei_ev_mouse_buttonup) {
+        scrollframe -> dragging = EI_FALSE;
+        ei_event_set_active_widget(NULL);
+    }
+    else if (event -> type == ei_ev_mouse_move && scrollframe -> dragging == EI_FALSE
+        && ei_event_get_active_widget() == widget) {
+        // Une frame du contenu a rendu le scrollframe actif : le glisser commence ici
+        scrollframe -> dragging = EI_TRUE;
+        scrollframe -> drag_from = where;
+    }
+    else if (event -> type == ei_ev_mouse_move && scrollframe -> dragging == EI_TRUE) {
+        // Le contenu suit la souris
+        ei_point_t offset = scrollframe -> offset;
+        offset.x -= where.x - scrollframe -> drag_from.x;
+        offset.y -= where.y - scrollframe -> drag_from.y;
+        scrollframe -> drag_from = where;
+        ei_scrollframe_scroll_to(widget, offset);
+    }
+    return EI_TRUE;
+}
@@ -10,6 +10,44 @@
 #include "ei_widget_frame.h"
 #include "ei_widget_button.h"
 #include "ei_widget_toplevel.h"
+#include "ei_slab.h"
+
+/**
+ * \brief	Computes the content rect of a toplevel: its screen location without the
+ * banner and the border.
+ */
+static void toplevel_update_content(ei_toplevel_t* toplevel){
+    ei_rect_t rect = ((ei_widget_t*) toplevel) -> screen_location;
+    int border_width = toplevel -> border_width;
+    toplevel -> content.top_left.x = rect.top_left.x + border_width;
+    toplevel -> content.top_left.y = rect.top_left.y + 30;
+    toplevel -> content.size.width = rect.size.width - 2 * border_width;
+    toplevel -> content.size.height = rect.size.height - 30 - border_width;
+}
+
+/**
+ * \brief	Creates the close button in the banner of a toplevel. It is created with the
+ * toplevel rather than when drawing it, so that drawing never changes the tree.
+ */
+static void toplevel_create_button_closable(ei_toplevel_t* toplevel){
+    ei_point_t point;
+    ei_size_t size;
+    point.x = 10;
+    point.y = 10;
+    ei_anchor_t anchor = ei_anc_none;
+    size.width = 16;
+    size.height = 16;
+    ei_widget_t* closable = ei_widget_create("button", (ei_widget_t*) toplevel);
+    ei_color_t red = {255, 0, 0, 255};
+    int width = 3;
+    int radius = 10;
+    ei_callback_t callback = button_closable;
+    ei_button_configure(closable, &size, &red, &width, &radius, NULL, NULL,
+        NULL, &red, NULL,NULL,NULL,NULL, &callback, NULL);
+    ei_place(closable, &anchor, &(point.x), &(point.y), NULL, NULL, NULL,
+    NULL, NULL, NULL);
+    toplevel -> button_closable = closable;
+}
 
 /**
  * @brief	Configures the attributes of widgets of the class "toplevel".
@@ -40,34 +78,70 @@ void			ei_toplevel_configure		(ei_widget_t*		widget,
         ei_bool_t*		closable,
         ei_axis_set_t*		resizable,
         ei_size_t**		min_size){
+    ei_toplevel_t* toplevel = (ei_toplevel_t*) widget;
+    // Attributs dont la valeur change vraiment
+    ei_attr_mask_t changed = 0;
     if (requested_size != NULL){
-        requested_size -> height += 30;
-        widget -> requested_size = *requested_size;
+        // La taille demandee ne comprend pas la banniere
+        ei_size_t size = *requested_size;
+        size.height += 30;
+        if (size.width != (widget -> requested_size).width
+            || size.height != (widget -> requested_size).height) {
+            widget -> requested_size = size;
+            changed |= ei_attr_requested_size;
+        }
     }
-    ei_toplevel_t* toplevel = (ei_toplevel_t*) widget;
     if (color != NULL){
-        *(toplevel -> color) = *color;
+        if (ei_color_equal(toplevel -> color, *color) == EI_FALSE) {
+            toplevel -> color = *color;
+            changed |= ei_attr_color;
+        }
+        toplevel -> set |= ei_attr_color;
     }
     if (border_width != NULL){
-        *(toplevel -> border_width) = *border_width;
+        if (toplevel -> border_width != *border_width) {
+            toplevel -> border_width = *border_width;
+            toplevel_update_content(toplevel);
+            changed |= ei_attr_border_width;
+        }
+        toplevel -> set |= ei_attr_border_width;
     }
-    if (title != NULL){
-        toplevel -> title = calloc(1, sizeof(char*));
-        *(toplevel -> title) = calloc(strlen(*title), sizeof(char));
-        strncpy(*(toplevel -> title), *title, strlen(*title));
+    if (title != NULL && *title != NULL){
+        if (ei_string_equal(toplevel -> title, *title) == EI_FALSE) {
+            free(toplevel -> title);
+            toplevel -> title = malloc(strlen(*title) + 1);
+            strcpy(toplevel -> title, *title);
+            changed |= ei_attr_title;
+        }
+        toplevel -> set |= ei_attr_title;
     }
     if (closable != NULL){
-        *(toplevel -> closable) = *closable;
+        if (toplevel -> closable != *closable) {
+            toplevel -> closable = *closable;
+            changed |= ei_attr_closable;
+        }
+        toplevel -> set |= ei_attr_closable;
     }
     if (resizable != NULL){
-        *(toplevel -> resizable) = *resizable;
+        if (toplevel -> resizable != *resizable) {
+            toplevel -> resizable = *resizable;
+            changed |= ei_attr_resizable;
+        }
+        toplevel -> set |= ei_attr_resizable;
     }
     if (min_size != NULL){
         if (*min_size != NULL){
-            **(toplevel -> min_size) = **min_size;
+            toplevel -> min_size = **min_size;
+            toplevel -> set |= ei_attr_min_size;
         }
     }
-    toplevel -> button_closable = NULL;
+    if (toplevel -> closable == EI_FALSE && toplevel -> button_closable != NULL) {
+        ei_widget_destroy(toplevel -> button_closable);
+        toplevel -> button_closable = NULL;
+    } else if (toplevel -> closable == EI_TRUE && toplevel -> button_closable == NULL) {
+        toplevel_create_button_closable(toplevel);
+    }
+    ei_widget_configured(widget, changed);
 }
 
 
@@ -86,6 +160,7 @@ void			ei_toplevel_register_class 	(){
     toplevel -> setdefaultsfunc = &ei_toplevel_setdefaultsfunc_t;
     strncpy(toplevel -> name, "toplevel", 20);
     ei_widgetclass_register(toplevel);
+    ei_widgetclass_set_slab(toplevel, sizeof(ei_toplevel_t));
 }
 
 /**
@@ -110,19 +185,7 @@ void*	ei_toplevel_allocfunc_t		(){
 
 void	ei_toplevel_releasefunc_t	(struct ei_widget_t*	widget){
     ei_toplevel_t* toplevel = (ei_toplevel_t*) widget;
-    free(toplevel -> color);
-    free(toplevel -> border_width);
-    free(toplevel -> closable);
-    free(toplevel -> resizable);
-    if (*(toplevel -> min_size) != NULL){
-        free(*(toplevel -> min_size));
-    }
-    free(toplevel -> min_size);
-    if (toplevel -> title != NULL){
-        free(*(toplevel -> title));
-        free(toplevel -> title);
-    }
-    free(toplevel);
+    free(toplevel -> title);
 }
 
 /**
@@ -140,65 +203,49 @@ void	ei_toplevel_drawfunc_t		(struct ei_widget_t*	widget,
         ei_rect_t*		clipper) {
     ei_toplevel_t* toplevel = (ei_toplevel_t*) widget;
     ei_rect_t rectangle = widget -> screen_location;
-    ei_color_t* color = toplevel -> color;
+    ei_color_t* color = &(toplevel -> color);
     ei_color_t* pick_color = widget -> pick_color;
-    int* border_width = toplevel -> border_width;
-    char** title = toplevel -> title;
-    ei_axis_set_t* resizable = toplevel -> resizable;
+    int border_width = toplevel -> border_width;
+    // Le titre par defaut n'est pas copie dans le widget
+    char* title = (toplevel -> title != NULL) ? toplevel -> title : "Toplevel";
+    ei_axis_set_t resizable = toplevel -> resizable;
     ei_color_t window_color = {110, 110, 110, 255};
-    ei_size_t surface_size = hw_surface_get_size(surface);
-    if ((color -> alpha) != 255){
-        ei_surface_t alpha_surface = hw_surface_create(surface,
-             &surface_size, EI_TRUE);
-        ei_draw_toplevel(alpha_surface, rectangle, color, &window_color,
-            *border_width, title, clipper);
-        ei_copy_surface(surface,clipper, alpha_surface,clipper, EI_TRUE);
-    } else {
-        ei_draw_toplevel(surface, rectangle, color, &window_color,
-            *border_width, title, clipper);
+    if (surface != NULL) {
+        if ((color -> alpha) != 255){
+            ei_surface_t layer = ei_layer_begin(surface, clipper);
+            ei_draw_toplevel(layer, rectangle, color, &window_color,
+                border_width, &title, clipper);
+            ei_layer_end(surface, layer, clipper);
+        } else {
+            ei_draw_toplevel(surface, rectangle, color, &window_color,
+                border_width, &title, clipper);
+        }
+        ei_color_t text_color = {0, 0, 0, 255};
+        ei_point_t where;
+        where.x = rectangle.top_left.x + 25; // on garde de la place pour le bouton closable
+        where.y = rectangle.top_left.y;
+        ei_draw_text(surface, &where, title, ei_default_font, &text_color, clipper);
     }
-    ei_color_t text_color = {0, 0, 0, 255};
-    ei_point_t* where = calloc(1, sizeof(ei_point_t));
-    where -> x = rectangle.top_left.x + 25; // on garde de la place pour le bouton closable
-    where -> y = rectangle.top_left.y;
-    ei_draw_text(surface, where, *title, ei_default_font, &text_color, clipper);
-    free(where);
-    ei_draw_toplevel(pick_surface, rectangle, pick_color, pick_color, 0, NULL, clipper);
-    if (*(toplevel -> closable) == EI_TRUE && toplevel -> button_closable == NULL) {
-        ei_point_t point;
-        ei_size_t size;
-        point.x = 10;
-        point.y = 10;
-        ei_anchor_t anchor = ei_anc_none;
-        size.width = 16;
-        size.height = 16;
-        ei_widget_t* closable = ei_widget_create("button", widget);
-        ei_color_t* red = calloc(1, sizeof(ei_color_t));
-        red -> red = 255;
-        red -> alpha = 255;
-        int width = 3;
-        int radius = 10;
-        ei_callback_t callback = button_closable;
-        ei_button_configure(closable, &size, red, &width, &radius, NULL, NULL,
-            NULL, red, NULL,NULL,NULL,NULL, &callback, NULL);
-        ei_place(closable, &anchor, &(point.x), &(point.y), NULL, NULL, NULL,
-        NULL, NULL, NULL);
-        toplevel -> button_closable = closable;
+    if (pick_surface != NULL) {
+        ei_draw_toplevel(pick_surface, rectangle, pick_color, pick_color, 0, NULL, clipper);
     }
-    if (*resizable != ei_axis_none) {
-        ei_rect_t* rect_resiz = malloc(sizeof(ei_rect_t));
-        rect_resiz ->top_left.x = rectangle.top_left.x + rectangle.size.width -
-         10 - *border_width;
-        rect_resiz ->top_left.y = rectangle.top_left.y + rectangle.size.height -
-         10 - *border_width;
-        rect_resiz ->size.width = 10 + *border_width;
-        rect_resiz ->size.height = 10 + *border_width;
-        ei_point_t* where = calloc(1, sizeof(ei_point_t));
-        *where = (ei_point_t) {0, 0};
-        ei_draw_button(surface, *rect_resiz, window_color, 0, 0, ei_relief_none,
-            NULL, ei_default_font, &window_color, NULL, rect_resiz, *where, clipper);
-        ei_draw_button(pick_surface, *rect_resiz, *pick_color, 0, 0, ei_relief_none,
-             NULL, ei_default_font, color, NULL, rect_resiz, *where, clipper);
+    if (resizable != ei_axis_none) {
+        ei_rect_t rect_resiz;
+        rect_resiz.top_left.x = rectangle.top_left.x + rectangle.size.width -
+         10 - border_width;
+        rect_resiz.top_left.y = rectangle.top_left.y + rectangle.size.height -
+         10 - border_width;
+        rect_resiz.size.width = 10 + border_width;
+        rect_resiz.size.height = 10 + border_width;
+        ei_point_t where = {0, 0};
+        if (surface != NULL) {
+            ei_draw_button(surface, rect_resiz, window_color, 0, 0, ei_relief_none,
+                NULL, ei_default_font, &window_color, NULL, &rect_resiz, where, clipper);
+        }
+        if (pick_surface != NULL) {
+            ei_draw_button(pick_surface, rect_resiz, *pick_color, 0, 0, ei_relief_none,
+                 NULL, ei_default_font, color, NULL, &rect_resiz, where, clipper);
+        }
     }
 }
 
@@ -211,24 +258,17 @@ void	ei_toplevel_setdefaultsfunc_t	(struct ei_widget_t*	widget) {
     (widget -> requested_size).width = 320;
     (widget -> requested_size).height = 240;
     ei_toplevel_t* toplevel = (ei_toplevel_t *) widget;
-    ei_color_t* color = malloc(sizeof(ei_color_t));
-    *color = ei_default_background_color;
-    toplevel -> color = color;
-    int* border_width = calloc(1, sizeof(int));
-    toplevel -> border_width = border_width;
-    char* title = "Toplevel";
-    toplevel -> title = &title;
-    ei_bool_t* closable = malloc(sizeof(ei_bool_t));
-    *closable = EI_TRUE;
-    toplevel -> closable = closable;
-    ei_axis_set_t* resizable = malloc(sizeof(ei_axis_set_t));
-    *resizable = ei_axis_both;
-    toplevel -> resizable = resizable;
-
-    toplevel -> min_size = malloc(sizeof(ei_size_t*));
-    *(toplevel -> min_size) = malloc(sizeof(ei_size_t));
-    (*(toplevel -> min_size)) -> width = 160;
-    (*(toplevel -> min_size)) -> height = 160;
+    toplevel -> set = 0;
+    toplevel -> color = ei_default_background_color;
+    toplevel -> border_width = 0;
+    toplevel -> title = NULL;
+    toplevel -> closable = EI_TRUE;
+    toplevel -> resizable = ei_axis_both;
+    toplevel -> min_size.width = 160;
+    toplevel -> min_size.height = 160;
+    widget -> content_rect = &(toplevel -> content);
+    toplevel -> button_closable = NULL;
+    toplevel_create_button_closable(toplevel);
 }
 /**
  * \brief 	A function that is called to notify the widget that its geometry has been modified
@@ -241,6 +281,22 @@ void	ei_toplevel_setdefaultsfunc_t	(struct ei_widget_t*	widget) {
 
 void	ei_toplevel_geomnotifyfunc_t	(struct ei_widget_t*	widget,
         ei_rect_t		rect){
+    toplevel_update_content((ei_toplevel_t*) widget);
+}
+
+/**
+ * \brief	Gives a toplevel placer parameters that describe its current location without
+ * anchor nor relative values, so that a drag only adds the moves of the mouse to them.
+ */
+static void toplevel_pin(ei_widget_t* widget){
+    ei_rect_t area = ei_placer_area(widget -> parent);
+    ei_anchor_t anchor = ei_anc_none;
+    float zero = 0.0;
+    int x = widget -> screen_location.top_left.x - area.top_left.x;
+    int y = widget -> screen_location.top_left.y - area.top_left.y;
+    int width = widget -> screen_location.size.width;
+    int height = widget -> screen_location.size.height;
+    ei_place(widget, &anchor, &x, &y, &width, &height, &zero, &zero, &zero, &zero);
 }
 
 /**
@@ -266,9 +322,10 @@ ei_bool_t ei_toplevel_handlefunc_t (struct ei_widget_t*	widget,
         ei_event_set_active_widget(widget);
         if  (is_on_the_banner(widget, event) == EI_TRUE) {
             *WIN_MOVE = where;
-        } else if (*(toplevel -> resizable) != ei_axis_none) {
+            toplevel_pin(widget);
+        } else if (toplevel -> resizable != ei_axis_none) {
             if (is_on_the_square(widget, event) == EI_TRUE) {
-                switch (*(toplevel -> resizable)) {
+                switch (toplevel -> resizable) {
                     case ei_axis_both:
                         *WIN_RESIZ = where;
                         break;
@@ -281,6 +338,9 @@ ei_bool_t ei_toplevel_handlefunc_t (struct ei_widget_t*	widget,
                     default:
                         break;
                 }
+                if (WIN_RESIZ -> x + WIN_RESIZ -> y != 0) {
+                    toplevel_pin(widget);
+                }
             }
         }
     }
@@ -292,34 +352,16 @@ ei_bool_t ei_toplevel_handlefunc_t (struct ei_widget_t*	widget,
         ei_event_set_active_widget(widget);
     }
     else if (event -> type == ei_ev_mouse_move) {
+        // Les deplacements s'ajoutent aux parametres du placeur : la passe de disposition
+        // place le toplevel et endommage ses zones une seule fois par frame
+        ei_placer_params_t* params = widget -> placer_params;
         if (WIN_MOVE -> x + WIN_MOVE -> y != 0) {
-
-            if (DRAW_RECT == NULL){
-                DRAW_RECT = malloc(sizeof(ei_linked_rect_t));
-            }
-            DRAW_RECT -> rect = (widget -> screen_location);
-            int dx = where.x - WIN_MOVE -> x;
-            int dy = where.y - WIN_MOVE -> y;
-            int* x = calloc(1, sizeof(int));
-            *x = widget -> screen_location.top_left.x + dx;
-            int* y = calloc(1, sizeof(int));
-            *y = widget -> screen_location.top_left.y + dy;
-            int width = widget -> screen_location.size.width;
-            int height = widget -> screen_location.size.height;
-            ei_point_t point = {*x, *y};
-            ei_size_t size = {width, height};
-            ei_rect_t rectangle = {point, size};
-            DRAW_RECT -> rect = *(ei_union(&(DRAW_RECT -> rect), &rectangle));
-
-            ei_place(widget, NULL, x, y, &width, &height, NULL, NULL,NULL,NULL);
+            int x = params -> x_data + where.x - WIN_MOVE -> x;
+            int y = params -> y_data + where.y - WIN_MOVE -> y;
+            ei_place(widget, NULL, &x, &y, NULL, NULL, NULL, NULL, NULL, NULL);
             *WIN_MOVE = where;
-
         }
         if (WIN_RESIZ -> x + WIN_RESIZ -> y != 0) {
-            if (DRAW_RECT == NULL){
-                DRAW_RECT = malloc(sizeof(ei_linked_rect_t));
-            }
-            DRAW_RECT -> rect = (widget -> screen_location);
             int dx, dy;
             if (WIN_RESIZ -> x != 0) {
                 dx = where.x - WIN_RESIZ -> x;
@@ -333,24 +375,15 @@ ei_bool_t ei_toplevel_handlefunc_t (struct ei_widget_t*	widget,
             } else {
                 dy = 0;
             }
-            int* x = calloc(1, sizeof(int));
-            *x = widget -> screen_location.top_left.x;
-            int* y = calloc(1, sizeof(int));
-            *y = widget -> screen_location.top_left.y;
-            int width = widget -> screen_location.size.width + dx;
-            int height = widget -> screen_location.size.height + dy;
-            ei_point_t point = {*x, *y};
-            ei_size_t size = {width, height};
-            ei_rect_t rectangle = {point, size};
-            DRAW_RECT -> rect = *(ei_union(&(DRAW_RECT -> rect), &rectangle));
-            if (width < ((*(toplevel -> min_size)) -> width)) {
-                width = (*(toplevel -> min_size)) -> width;
+            int width = params -> w_data + dx;
+            int height = params -> h_data + dy;
+            if (width < toplevel -> min_size.width) {
+                width = toplevel -> min_size.width;
             }
-            if (height < ((*(toplevel -> min_size)) -> height)) {
-                height = (*(toplevel -> min_size)) -> height;
+            if (height < toplevel -> min_size.height) {
+                height = toplevel -> min_size.height;
             }
-            ei_place(widget, NULL, x, y, &width, &height, NULL, NULL,NULL,NULL);
-            ei_placer_run(widget);
+            ei_place(widget, NULL, NULL, NULL, &width, &height, NULL, NULL, NULL, NULL);
         }
     }
     return EI_TRUE;
@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ei_application.h"
+#include "ei_event.h"
+#include "hw_interface.h"
+#include "ei_widget.h"
+#include "ei_animation.h"
+
+#define COLUMNS		24
+#define ROWS		16
+
+static ei_color_t	off_color		= {0x30, 0x30, 0x30, 0xff};
+static ei_color_t	on_color		= {0x40, 0xe0, 0x60, 0xff};
+
+/*
+ * pulse --
+ *
+ *	Callback called at the end of each animation: starts the opposite one.
+ *	The indicator state is stored in the user parameter.
+ */
+void pulse(ei_widget_t* widget, void* user_param)
+{
+	int*		state		= (int*) user_param;
+
+	*state = !(*state);
+	ei_animate_background(widget, *state ? on_color : off_color, 400 + 15 * (*state),
+			      ei_ease_in_out, pulse, state);
+}
+
+/*
+ * process_key --
+ *
+ *	Callback called when any key is pressed by the user.
+ *	Simply looks for the "Escape" key to request the application to quit.
+ */
+ei_bool_t process_key(ei_event_t* event)
+{
+	if (event->type == ei_ev_keydown)
+		if (event->param.key.key_sym == SDLK_ESCAPE) {
+			ei_app_quit_request();
+			return EI_TRUE;
+		}
+
+	return EI_FALSE;
+}
+
+/*
+ * ei_main --
+ *
+ *	Main function of the application: a grid of indicators that all pulse at
+ *	the same time, driven by a single timer.
+ */
+int ei_main(int argc, char** argv)
+{
+	ei_size_t	screen_size		= {COLUMNS * 25, ROWS * 25};
+	ei_color_t	root_bgcol		= {0x10, 0x10, 0x10, 0xff};
+	ei_size_t	indicator_size		= {20, 20};
+	int		indicator_border	= 0;
+	static int	states[COLUMNS * ROWS];
+
+	ei_app_create(&screen_size, EI_FALSE);
+	ei_frame_configure(ei_app_root_widget(), NULL, &root_bgcol, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+	ei_event_set_default_handle_func(process_key);
+
+	for (int i = 0; i < COLUMNS * ROWS; i++) {
+		int		x		= (i % COLUMNS) * 25 + 2;
+		int		y		= (i / COLUMNS) * 25 + 2;
+		ei_widget_t*	indicator	= ei_widget_create("frame", ei_app_root_widget());
+
+		ei_frame_configure(indicator, &indicator_size, &off_color, &indicator_border, NULL,
+				   NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+		ei_place(indicator, NULL, &x, &y, NULL, NULL, NULL, NULL, NULL, NULL);
+
+		/* Stagger the indicators: each one starts with a different duration. */
+		states[i] = 1;
+		ei_animate_background(indicator, on_color, 100 + 7 * i, ei_ease_linear, pulse, &states[i]);
+	}
+
+	ei_app_run();
+
+	printf("%d animations running\n", ei_animation_count());
+	ei_app_free();
+
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ei_application.h"
+#include "ei_event.h"
+#include "hw_interface.h"
+#include "ei_widget.h"
+#include "ei_image.h"
+
+#define PIECES		4
+#define PIECE		128
+#define GAP		4
+
+/*
+ * process_key --
+ *
+ *	Callback called when any key is pressed by the user.
+ *	Simply looks for the "Escape" key to request the application to quit.
+ */
+ei_bool_t process_key(ei_event_t* event)
+{
+	if (event->type == ei_ev_keydown)
+		if (event->param.key.key_sym == SDLK_ESCAPE) {
+			ei_app_quit_request();
+			return EI_TRUE;
+		}
+
+	return EI_FALSE;
+}
+
+/*
+ * ei_main --
+ *
+ *	Main function of the application: the picture is cut in pieces, each shown by
+ *	a frame. The window appears at once, the frames are empty until the loader
+ *	thread has decoded the file, then only they are redrawn. The file is decoded
+ *	once, all the pieces share the same image.
+ */
+int ei_main(int argc, char** argv)
+{
+	ei_size_t	screen_size		= {PIECES * (PIECE + GAP) + GAP, PIECES * (PIECE + GAP) + GAP};
+	ei_color_t	root_bgcol		= {0x30, 0x30, 0x30, 0xff};
+	ei_color_t	piece_color		= {0x60, 0x60, 0x60, 0xff};
+	ei_size_t	piece_size		= {PIECE, PIECE};
+	char*		image_filename		= "misc/klimt.jpg";
+	ei_image_stats_t	stats;
+
+	ei_app_create(&screen_size, EI_FALSE);
+	ei_frame_configure(ei_app_root_widget(), NULL, &root_bgcol, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+	ei_event_set_default_handle_func(process_key);
+
+	for (int i = 0; i < PIECES * PIECES; i++) {
+		int		x		= (i % PIECES) * (PIECE + GAP) + GAP;
+		int		y		= (i / PIECES) * (PIECE + GAP) + GAP;
+		ei_rect_t	img_rect	= {{(i % PIECES) * PIECE, (i / PIECES) * PIECE}, piece_size};
+		ei_rect_t*	img_rect_ptr	= &img_rect;
+		ei_widget_t*	piece		= ei_widget_create("frame", ei_app_root_widget());
+
+		/* A placeholder until the file is decoded, the frame is given the image then. */
+		ei_surface_t	image		= ei_image_acquire_async(image_filename);
+
+		ei_frame_configure(piece, &piece_size, &piece_color, NULL, NULL, NULL, NULL, NULL,
+				   NULL, &image, &img_rect_ptr, NULL);
+		/* The frame keeps its own reference on the image. */
+		ei_image_release(image);
+		ei_place(piece, NULL, &x, &y, NULL, NULL, NULL, NULL, NULL, NULL);
+	}
+
+	ei_app_run();
+
+	ei_image_get_stats(&stats);
+	printf("%d image, %lu file loaded, %lu found in the registry\n",
+	       stats.images, stats.loads, stats.hits);
+	ei_app_free();
+
+	return (EXIT_SUCCESS);
+}
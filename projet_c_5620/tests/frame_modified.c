@@ -6,6 +6,7 @@
 #include "hw_interface.h"
 #include "ei_widget.h"
 #include "ei_utils.h"
+#include "ei_image.h"
 
 ei_bool_t global_handler(ei_event_t* event)
 {
@@ -46,7 +47,7 @@ int ei_main(int argc, char** argv)
 	int ele1 = 50;
 	ei_toplevel_configure(toplevel, &toplevel_size, &root_bgcol, &border_width, text, NULL, NULL, NULL);
 	ei_place(toplevel, NULL, &(ele1), &(ele1), NULL, NULL, NULL, NULL, NULL, NULL);
-	ei_surface_t image		= hw_image_load(image_filename, ei_app_root_surface());
+	ei_surface_t image		= ei_image_acquire(image_filename);
 	ei_size_t image_size	= hw_surface_get_size(image);
 	image_size.width = 100;
 	image_size.height = 300;
@@ -58,6 +59,8 @@ int ei_main(int argc, char** argv)
 	ei_frame_configure	(frame, &frame_size, &frame_color,
 				 &frame_border_width, &frame_relief, NULL, NULL, NULL, NULL,
 				 &image, &img_rect, NULL);
+	/* The frame keeps its own reference on the image. */
+	ei_image_release(image);
 	ei_place(frame, NULL, &ele1, &ele1, NULL, NULL, NULL, NULL, NULL, NULL );
 	ei_event_set_default_handle_func(global_handler);
 	/* Run the application's main loop. */
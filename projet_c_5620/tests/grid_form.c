@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ei_application.h"
+#include "ei_event.h"
+#include "hw_interface.h"
+#include "ei_widget.h"
+#include "ei_grid.h"
+
+static ei_widget_t*	mail_label;
+static ei_color_t	form_color		= {0xd8, 0xd8, 0xd8, 0xff};
+static ei_color_t	field_color		= {0xb0, 0xc0, 0xd0, 0xff};
+
+/*
+ * create_label --
+ *
+ *	Creates a frame that shows a text, placed in a cell of the form. Its requested
+ *	size is the size of its text.
+ */
+ei_widget_t* create_label(ei_widget_t* form, char* text, int row, ei_anchor_t anchor)
+{
+	ei_widget_t*	label		= ei_widget_create("frame", form);
+	int		column		= 0;
+
+	ei_frame_configure(label, NULL, &form_color, NULL, NULL, &text, NULL, NULL, NULL,
+			   NULL, NULL, NULL);
+	ei_grid(label, &row, &column, NULL, NULL, &anchor, NULL);
+	return label;
+}
+
+/*
+ * create_field --
+ *
+ *	Creates a sunken frame that fills a cell of the form.
+ */
+ei_widget_t* create_field(ei_widget_t* form, int row, int column, int column_span)
+{
+	ei_widget_t*	field		= ei_widget_create("frame", form);
+	ei_size_t	size		= {100, 24};
+	int		border_width	= 2;
+	ei_relief_t	relief		= ei_relief_sunken;
+	ei_bool_t	fill		= EI_TRUE;
+
+	ei_frame_configure(field, &size, &field_color, &border_width, &relief, NULL, NULL,
+			   NULL, NULL, NULL, NULL, NULL);
+	ei_grid(field, &row, &column, NULL, &column_span, NULL, &fill);
+	return field;
+}
+
+/*
+ * rename_label --
+ *
+ *	Callback of the "Rename" button: changes the text of a label. Only the first
+ *	column is measured again, the fields are moved to make room.
+ */
+void rename_label(ei_widget_t* widget, ei_event_t* event, void* user_param)
+{
+	static int	longer		= 0;
+	char*		text;
+
+	longer = !longer;
+	text = longer ? "E-mail address:" : "E-mail:";
+	ei_frame_configure(mail_label, NULL, NULL, NULL, NULL, &text, NULL, NULL, NULL,
+			   NULL, NULL, NULL);
+}
+
+/*
+ * process_key --
+ *
+ *	Callback called when any key is pressed by the user.
+ *	Simply looks for the "Escape" key to request the application to quit.
+ */
+ei_bool_t process_key(ei_event_t* event)
+{
+	if (event->type == ei_ev_keydown)
+		if (event->param.key.key_sym == SDLK_ESCAPE) {
+			ei_app_quit_request();
+			return EI_TRUE;
+		}
+
+	return EI_FALSE;
+}
+
+/*
+ * ei_main --
+ *
+ *	Main function of the application: a form laid out by the grid in a resizable
+ *	toplevel. The labels keep their size, the space left goes to the fields with
+ *	weights 2 and 1, and to the comment row.
+ */
+int ei_main(int argc, char** argv)
+{
+	ei_size_t	screen_size		= {600, 500};
+	ei_color_t	root_bgcol		= {0x52, 0x7f, 0xb4, 0xff};
+	ei_size_t	form_size		= {400, 260};
+	ei_size_t	form_min_size		= {300, 200};
+	ei_size_t*	form_min_size_ptr	= &form_min_size;
+	char*		form_title		= "Contact";
+	ei_bool_t	form_closable		= EI_FALSE;
+	ei_axis_set_t	form_resizable		= ei_axis_both;
+	int		form_x			= 60;
+	int		form_y			= 60;
+	ei_widget_t*	form;
+	ei_widget_t*	button;
+	char*		button_text		= "Rename";
+	ei_callback_t	button_callback		= rename_label;
+	int		button_row		= 3;
+	int		button_column		= 2;
+	ei_anchor_t	button_anchor		= ei_anc_east;
+	int		no_weight		= 0;
+	int		weight			= 1;
+	int		double_weight		= 2;
+	int		label_width		= 60;
+	ei_grid_stats_t	stats;
+
+	ei_app_create(&screen_size, EI_FALSE);
+	ei_frame_configure(ei_app_root_widget(), NULL, &root_bgcol, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+	ei_event_set_default_handle_func(process_key);
+
+	form = ei_widget_create("toplevel", ei_app_root_widget());
+	ei_toplevel_configure(form, &form_size, &form_color, NULL, &form_title, &form_closable,
+			      &form_resizable, &form_min_size_ptr);
+	ei_place(form, NULL, &form_x, &form_y, NULL, NULL, NULL, NULL, NULL, NULL);
+
+	/* The labels keep their width, the two columns of fields share the rest 2:1. */
+	ei_grid_column_configure(form, 0, &no_weight, &label_width);
+	ei_grid_column_configure(form, 1, &double_weight, NULL);
+	ei_grid_column_configure(form, 2, &weight, NULL);
+	ei_grid_row_configure(form, 2, &weight, NULL);
+
+	create_label(form, "Name:", 0, ei_anc_west);
+	create_field(form, 0, 1, 1);
+	create_field(form, 0, 2, 1);
+	mail_label = create_label(form, "E-mail:", 1, ei_anc_west);
+	create_field(form, 1, 1, 2);
+	create_label(form, "Comment:", 2, ei_anc_northwest);
+	create_field(form, 2, 1, 2);
+
+	button = ei_widget_create("button", form);
+	ei_button_configure(button, NULL, NULL, NULL, NULL, NULL, &button_text, NULL, NULL, NULL,
+			    NULL, NULL, NULL, &button_callback, NULL);
+	ei_grid(button, &button_row, &button_column, NULL, NULL, &button_anchor, NULL);
+
+	ei_app_run();
+
+	ei_grid_get_stats(&stats);
+	printf("%d widgets in %d grid: %lu rows and columns measured, %lu widgets moved\n",
+	       stats.slaves, stats.masters, stats.lines_solved, stats.moves);
+	ei_app_free();
+
+	return (EXIT_SUCCESS);
+}
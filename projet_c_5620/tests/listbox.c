@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ei_application.h"
+#include "ei_event.h"
+#include "hw_interface.h"
+#include "ei_widget.h"
+#include "ei_widget_listbox.h"
+#include "ei_widget_scrollframe.h"
+
+#define ITEMS		100000
+#define ROW_HEIGHT	24
+#define PAGE		15
+
+static ei_widget_t*	listbox;
+static char		selected[ITEMS];
+
+static ei_color_t	even_color		= {0xe8, 0xe8, 0xe8, 0xff};
+static ei_color_t	odd_color		= {0xd0, 0xd8, 0xe0, 0xff};
+static ei_color_t	selected_color		= {0x40, 0x90, 0xe0, 0xff};
+
+/*
+ * select_row --
+ *
+ *	Callback of the row buttons: selects or unselects the item shown by the row,
+ *	and redraws only that row.
+ */
+void select_row(ei_widget_t* row, ei_event_t* event, void* user_param)
+{
+	int		index		= ei_listbox_row_item(listbox, row);
+
+	if (index < 0)
+		return;
+	selected[index] = !selected[index];
+	ei_listbox_refresh(listbox, index, 1);
+}
+
+/*
+ * show_item --
+ *
+ *	Row function of the listbox: gives a row the text and the color of an item.
+ *	Only the rows in the viewport exist, they are given new items as the list scrolls.
+ */
+void show_item(ei_widget_t* row, int index, void* user_param)
+{
+	char		text[32];
+	char*		label		= text;
+	ei_color_t*	color		= (index % 2 == 0) ? &even_color : &odd_color;
+	ei_callback_t	callback	= select_row;
+
+	if (selected[index])
+		color = &selected_color;
+	snprintf(text, sizeof(text), "Item %d", index);
+	ei_button_configure(row, NULL, color, NULL, NULL, NULL, &label, NULL, NULL, NULL,
+			    NULL, NULL, NULL, &callback, NULL);
+}
+
+/*
+ * process_key --
+ *
+ *	Callback called when any key is pressed by the user.
+ *	The arrow keys move by one item, the page keys by a page, "Escape" quits.
+ */
+ei_bool_t process_key(ei_event_t* event)
+{
+	int		first_item;
+
+	if (event->type != ei_ev_keydown)
+		return EI_FALSE;
+
+	/* The list may have been dragged since the last key. */
+	first_item = ei_scrollframe_get_offset(listbox).y / ROW_HEIGHT;
+
+	switch (event->param.key.key_sym) {
+		case SDLK_ESCAPE:
+			ei_app_quit_request();
+			return EI_TRUE;
+		case SDLK_UP:
+			first_item -= 1;
+			break;
+		case SDLK_DOWN:
+			first_item += 1;
+			break;
+		case SDLK_PAGEUP:
+			first_item -= PAGE;
+			break;
+		case SDLK_PAGEDOWN:
+			first_item += PAGE;
+			break;
+		default:
+			return EI_FALSE;
+	}
+	first_item = (first_item < 0) ? 0 : (first_item >= ITEMS ? ITEMS - 1 : first_item);
+	ei_listbox_scroll_to_item(listbox, first_item);
+	return EI_TRUE;
+}
+
+/*
+ * ei_main --
+ *
+ *	Main function of the application: a list of 100000 items, of which only the
+ *	visible ones exist as widgets. Drag the list or use the keys to scroll it,
+ *	click on a row to select it.
+ */
+int ei_main(int argc, char** argv)
+{
+	ei_size_t	screen_size		= {400, 480};
+	ei_color_t	root_bgcol		= {0x52, 0x7f, 0xb4, 0xff};
+	ei_size_t	list_size		= {300, PAGE * ROW_HEIGHT + 6};
+	int		border_width		= 3;
+	ei_relief_t	relief			= ei_relief_sunken;
+	int		item_count		= ITEMS;
+	int		row_height		= ROW_HEIGHT;
+	char*		row_class		= "button";
+	ei_listbox_rowfunc_t	rowfunc		= show_item;
+	int		x			= 50;
+	int		y			= 50;
+	ei_listbox_stats_t	stats;
+
+	ei_app_create(&screen_size, EI_FALSE);
+	ei_frame_configure(ei_app_root_widget(), NULL, &root_bgcol, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+	ei_event_set_default_handle_func(process_key);
+
+	listbox = ei_widget_create("listbox", ei_app_root_widget());
+	ei_listbox_configure(listbox, &list_size, NULL, &border_width, &relief, &item_count,
+			     &row_height, &row_class, &rowfunc, NULL);
+	ei_place(listbox, NULL, &x, &y, NULL, NULL, NULL, NULL, NULL, NULL);
+
+	ei_app_run();
+
+	ei_listbox_get_stats(&stats);
+	printf("%d items shown by %lu rows, %lu row updates\n", ITEMS, stats.rows, stats.binds);
+	ei_app_free();
+
+	return (EXIT_SUCCESS);
+}
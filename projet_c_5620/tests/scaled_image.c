@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ei_application.h"
+#include "ei_event.h"
+#include "hw_interface.h"
+#include "ei_widget.h"
+#include "ei_image.h"
+#include "ei_scale.h"
+#include "ei_grid.h"
+
+#define THUMBNAILS	4
+
+/*
+ * process_key --
+ *
+ *	Callback called when any key is pressed by the user.
+ *	Simply looks for the "Escape" key to request the application to quit.
+ */
+ei_bool_t process_key(ei_event_t* event)
+{
+	if (event->type == ei_ev_keydown)
+		if (event->param.key.key_sym == SDLK_ESCAPE) {
+			ei_app_quit_request();
+			return EI_TRUE;
+		}
+
+	return EI_FALSE;
+}
+
+/*
+ * ei_main --
+ *
+ *	Main function of the application: the same picture fitted in the left half of
+ *	a resizable toplevel and stretched in the right half, and thumbnails of several
+ *	sizes below. The scaled copies are kept in a cache, they are computed again
+ *	only when the toplevel is resized.
+ */
+int ei_main(int argc, char** argv)
+{
+	ei_size_t	screen_size		= {640, 600};
+	ei_color_t	root_bgcol		= {0x52, 0x7f, 0xb4, 0xff};
+	ei_color_t	frame_color		= {0x30, 0x30, 0x30, 0xff};
+	ei_size_t	window_size		= {400, 240};
+	ei_size_t	window_min_size		= {100, 60};
+	ei_size_t*	window_min_size_ptr	= &window_min_size;
+	char*		window_title		= "Scaling";
+	ei_bool_t	window_closable		= EI_FALSE;
+	ei_axis_set_t	window_resizable	= ei_axis_both;
+	int		window_x		= 20;
+	int		window_y		= 20;
+	ei_size_t	half_size		= {50, 50};
+	int		weight			= 1;
+	int		row			= 0;
+	int		left			= 0;
+	int		right			= 1;
+	int		grip_height		= 14;
+	ei_bool_t	fill			= EI_TRUE;
+	int		border_width		= 2;
+	ei_relief_t	relief			= ei_relief_sunken;
+	char*		image_filename		= "misc/klimt.jpg";
+	ei_surface_t	image;
+	ei_widget_t*	window;
+	ei_widget_t*	fitted;
+	ei_widget_t*	stretched;
+	int		thumbnail_x		= 20;
+	int		thumbnail_y		= 320;
+	ei_scale_stats_t	stats;
+
+	ei_app_create(&screen_size, EI_FALSE);
+	ei_frame_configure(ei_app_root_widget(), NULL, &root_bgcol, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+	ei_event_set_default_handle_func(process_key);
+	image = ei_image_acquire(image_filename);
+
+	window = ei_widget_create("toplevel", ei_app_root_widget());
+	ei_toplevel_configure(window, &window_size, &frame_color, NULL, &window_title,
+			      &window_closable, &window_resizable, &window_min_size_ptr);
+	ei_place(window, NULL, &window_x, &window_y, NULL, NULL, NULL, NULL, NULL, NULL);
+
+	/* The two halves share the toplevel, whatever the size of the image. */
+	ei_grid_column_configure(window, left, &weight, NULL);
+	ei_grid_column_configure(window, right, &weight, NULL);
+	ei_grid_row_configure(window, row, &weight, NULL);
+	/* An empty row keeps the resize grip of the toplevel uncovered. */
+	ei_grid_row_configure(window, row + 1, NULL, &grip_height);
+
+	fitted = ei_widget_create("frame", window);
+	ei_frame_configure(fitted, &half_size, &frame_color, &border_width, &relief, NULL, NULL, NULL,
+			   NULL, &image, NULL, NULL);
+	ei_widget_set_img_scaling(fitted, ei_scale_fit);
+	ei_grid(fitted, &row, &left, NULL, NULL, NULL, &fill);
+
+	stretched = ei_widget_create("frame", window);
+	ei_frame_configure(stretched, &half_size, &frame_color, &border_width, &relief, NULL, NULL, NULL,
+			   NULL, &image, NULL, NULL);
+	ei_widget_set_img_scaling(stretched, ei_scale_stretch);
+	ei_grid(stretched, &row, &right, NULL, NULL, NULL, &fill);
+
+	for (int i = 0; i < THUMBNAILS; i++) {
+		int		side		= 32 << i;
+		ei_size_t	thumbnail_size	= {side, side};
+		ei_widget_t*	thumbnail	= ei_widget_create("button", ei_app_root_widget());
+
+		ei_button_configure(thumbnail, &thumbnail_size, &frame_color, &border_width, NULL,
+				    NULL, NULL, NULL, NULL, NULL, &image, NULL, NULL, NULL, NULL);
+		ei_widget_set_img_scaling(thumbnail, ei_scale_fit);
+		ei_place(thumbnail, NULL, &thumbnail_x, &thumbnail_y, NULL, NULL, NULL, NULL, NULL, NULL);
+		thumbnail_x += side + 10;
+	}
+	/* The widgets keep their own references on the image. */
+	ei_image_release(image);
+
+	ei_app_run();
+
+	ei_scale_get_stats(&stats);
+	printf("%d scaled copies, %d mipmaps: %lu computed, %lu found in the cache\n",
+	       stats.copies, stats.mip_levels, stats.resamples, stats.hits);
+	ei_app_free();
+
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ei_application.h"
+#include "ei_event.h"
+#include "hw_interface.h"
+#include "ei_widget.h"
+#include "ei_widget_scrollframe.h"
+
+#define COLUMNS		24
+#define ROWS		40
+#define CELL		60
+#define STEP		40
+
+static ei_widget_t*	scrollframe;
+static char		labels[COLUMNS * ROWS][8];
+
+/*
+ * process_key --
+ *
+ *	Callback called when any key is pressed by the user.
+ *	The arrow keys scroll the content, "Escape" requests the application to quit.
+ */
+ei_bool_t process_key(ei_event_t* event)
+{
+	ei_point_t	offset;
+
+	if (event->type != ei_ev_keydown)
+		return EI_FALSE;
+
+	offset = ei_scrollframe_get_offset(scrollframe);
+	switch (event->param.key.key_sym) {
+		case SDLK_ESCAPE:
+			ei_app_quit_request();
+			return EI_TRUE;
+		case SDLK_UP:
+			offset.y -= STEP;
+			break;
+		case SDLK_DOWN:
+			offset.y += STEP;
+			break;
+		case SDLK_LEFT:
+			offset.x -= STEP;
+			break;
+		case SDLK_RIGHT:
+			offset.x += STEP;
+			break;
+		default:
+			return EI_FALSE;
+	}
+	/* The pixels still visible are moved, only the uncovered band is redrawn. */
+	ei_scrollframe_scroll_to(scrollframe, offset);
+	return EI_TRUE;
+}
+
+/*
+ * ei_main --
+ *
+ *	Main function of the application: a scrollframe whose content is much larger
+ *	than its viewport. Drag the content or use the arrow keys to scroll it.
+ */
+int ei_main(int argc, char** argv)
+{
+	ei_size_t	screen_size		= {640, 480};
+	ei_color_t	root_bgcol		= {0x52, 0x7f, 0xb4, 0xff};
+	ei_size_t	viewport_size		= {500, 380};
+	ei_size_t	content_size		= {COLUMNS * CELL, ROWS * CELL};
+	int		border_width		= 3;
+	ei_relief_t	relief			= ei_relief_sunken;
+	ei_size_t	cell_size		= {CELL - 6, CELL - 6};
+	int		x			= 70;
+	int		y			= 50;
+	ei_scrollframe_stats_t	stats;
+
+	ei_app_create(&screen_size, EI_FALSE);
+	ei_frame_configure(ei_app_root_widget(), NULL, &root_bgcol, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+	ei_event_set_default_handle_func(process_key);
+
+	scrollframe = ei_widget_create("scrollframe", ei_app_root_widget());
+	ei_scrollframe_configure(scrollframe, &viewport_size, NULL, &border_width, &relief, &content_size);
+	ei_place(scrollframe, NULL, &x, &y, NULL, NULL, NULL, NULL, NULL, NULL);
+
+	/* The cells are placed in the content, the scrollframe shifts them by its offset. */
+	for (int i = 0; i < COLUMNS * ROWS; i++) {
+		int		cell_x		= (i % COLUMNS) * CELL + 3;
+		int		cell_y		= (i / COLUMNS) * CELL + 3;
+		ei_color_t	cell_color	= {(unsigned char) (i * 7), (unsigned char) (255 - i % 256), 0xa0, 0xff};
+		char*		label		= labels[i];
+		ei_widget_t*	cell		= ei_widget_create("frame", scrollframe);
+
+		snprintf(label, sizeof(labels[i]), "%d", i);
+		ei_frame_configure(cell, &cell_size, &cell_color, NULL, NULL, &label,
+				   NULL, NULL, NULL, NULL, NULL, NULL);
+		ei_place(cell, NULL, &cell_x, &cell_y, NULL, NULL, NULL, NULL, NULL, NULL);
+	}
+
+	ei_app_run();
+
+	ei_scrollframe_get_stats(&stats);
+	printf("%lu scrolls: %lu blits, %lu repaints, %lu pixels moved, %lu pixels redrawn\n",
+	       stats.scrolls, stats.blits, stats.repaints, stats.moved_pixels, stats.exposed_pixels);
+	printf("%d frames in the content, %lu placed again by the scrolls\n",
+	       COLUMNS * ROWS, stats.placed_children);
+	ei_app_free();
+
+	return (EXIT_SUCCESS);
+}
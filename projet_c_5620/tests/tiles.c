@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ei_application.h"
+#include "ei_event.h"
+#include "hw_interface.h"
+#include "ei_widget.h"
+#include "ei_animation.h"
+#include "ei_pool.h"
+#include "ei_renderer.h"
+
+#define COLUMNS		16
+#define ROWS		12
+#define CELL		40
+
+static char		lit[COLUMNS * ROWS];
+
+static ei_color_t	dark_color		= {0x20, 0x30, 0x50, 0xff};
+static ei_color_t	light_color		= {0xe0, 0xa0, 0x40, 0xff};
+
+/*
+ * pulse --
+ *
+ *	Called at the end of the animation of a cell: starts the animation back to the
+ *	other color, so that all the cells keep changing, each at its own pace.
+ */
+void pulse(ei_widget_t* cell, void* user_param)
+{
+	char*		state		= (char*) user_param;
+	int		index		= (int) (state - lit);
+
+	*state = !*state;
+	ei_animate_background(cell, *state ? light_color : dark_color, 300 + (index % 7) * 100,
+			      ei_ease_in_out, pulse, user_param);
+}
+
+/*
+ * process_key --
+ *
+ *	Callback called when any key is pressed by the user.
+ *	Simply looks for the "Escape" key to request the application to quit.
+ */
+ei_bool_t process_key(ei_event_t* event)
+{
+	if (event->type == ei_ev_keydown)
+		if (event->param.key.key_sym == SDLK_ESCAPE) {
+			ei_app_quit_request();
+			return EI_TRUE;
+		}
+
+	return EI_FALSE;
+}
+
+/*
+ * ei_main --
+ *
+ *	Main function of the application: a screen full of animated cells, redrawn at
+ *	every frame by the tiled renderer. The first argument is the number of threads
+ *	(1 draws in the calling thread only), the second one the size of the tiles.
+ *	The opaque toplevel in front hides the cells below it, they are not drawn.
+ */
+int ei_main(int argc, char** argv)
+{
+	ei_size_t	screen_size		= {COLUMNS * CELL, ROWS * CELL};
+	ei_size_t	cell_size		= {CELL - 4, CELL - 4};
+	ei_size_t	window_size		= {240, 160};
+	char*		window_title		= "Tiles";
+	ei_bool_t	window_closable		= EI_FALSE;
+	int		window_x		= 200;
+	int		window_y		= 150;
+	ei_widget_t*	window;
+	ei_renderer_stats_t	renderer_stats;
+	ei_pool_stats_t	pool_stats;
+
+	ei_app_create(&screen_size, EI_FALSE);
+	if (argc > 1)
+		ei_pool_set_threads(atoi(argv[1]));
+	if (argc > 2)
+		ei_renderer_set_tile_size(atoi(argv[2]));
+	ei_event_set_default_handle_func(process_key);
+
+	for (int i = 0; i < COLUMNS * ROWS; i++) {
+		int		cell_x		= (i % COLUMNS) * CELL + 2;
+		int		cell_y		= (i / COLUMNS) * CELL + 2;
+		ei_widget_t*	cell		= ei_widget_create("frame", ei_app_root_widget());
+
+		ei_frame_configure(cell, &cell_size, &dark_color, NULL, NULL, NULL,
+				   NULL, NULL, NULL, NULL, NULL, NULL);
+		ei_place(cell, NULL, &cell_x, &cell_y, NULL, NULL, NULL, NULL, NULL, NULL);
+		pulse(cell, &lit[i]);
+	}
+
+	window = ei_widget_create("toplevel", ei_app_root_widget());
+	ei_toplevel_configure(window, &window_size, NULL, NULL, &window_title, &window_closable,
+			      NULL, NULL);
+	ei_place(window, NULL, &window_x, &window_y, NULL, NULL, NULL, NULL, NULL, NULL);
+
+	ei_app_run();
+
+	ei_renderer_get_stats(&renderer_stats);
+	ei_pool_get_stats(&pool_stats);
+	printf("%lu frames, %lu drawn by %d threads: %d tiles, %d widgets, %d hidden\n",
+	       renderer_stats.frames, renderer_stats.parallel_frames, pool_stats.threads,
+	       renderer_stats.tiles, renderer_stats.items, renderer_stats.culled);
+	ei_app_free();
+
+	return (EXIT_SUCCESS);
+}